@@ -3,6 +3,7 @@
 #include "GroupHeader.h"
 #include "GroupStack.h"
 #include "RecordHeader.h"
+#include <cstdint>
 #include <memory>
 #include <utility>
 #include <vector>
@@ -14,9 +15,19 @@ namespace espm {
 class Browser
 {
 public:
-  Browser(const void* fileContent, size_t length);
+  // With numThreads > 1, top-level GRUPs are indexed in parallel
+  Browser(const void* fileContent, size_t length, size_t numThreads = 1);
+
+  // Restores lookup tables from SerializeIndex output instead of walking the
+  // file. Throws if the index is malformed or was built for another length.
+  // The index buffer isn't referenced after construction
+  Browser(const void* fileContent, size_t length, const void* index,
+          size_t indexLength);
   ~Browser();
 
+  // Lookup tables with file offsets instead of pointers, see the constructor
+  std::vector<uint8_t> SerializeIndex() const;
+
   const RecordHeader* LookupById(uint32_t formId) const noexcept;
   std::pair<const RecordHeader**, size_t> FindNavMeshes(
     uint32_t worldSpaceId, CellOrGridPos cellOrGridPos) const noexcept;
@@ -33,7 +44,6 @@ public:
     const GroupHeader* group) const;
 
 private:
-  bool ReadAny(const GroupStack* parentGrStack);
   Browser(const Browser&) = delete;
   void operator=(const Browser&) = delete;
 
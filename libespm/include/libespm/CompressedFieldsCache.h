@@ -1,29 +1,75 @@
 #pragma once
+#include <cstddef>
 #include <cstdint>
+#include <list>
 #include <memory>
+#include <mutex>
 #include <unordered_map>
 #include <vector>
 
-#pragma pack(push, 1)
-
 namespace espm {
 
 class RecordHeader;
 
+// Decompressed fields of compressed records. Thread-safe.
+//
+// With a byte budget set, least recently used entries are evicted by Trim.
+// Record data returned by GetData methods may point into decompressed fields,
+// so eviction never happens implicitly: call Trim at a point where no such
+// data is in use (e.g. between server ticks)
 class CompressedFieldsCache
 {
   friend class RecordHeaderAccess;
-  friend class Browser;
+
+public:
+  using Fields = std::shared_ptr<const std::vector<uint8_t>>;
+
+  struct Stats
+  {
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    uint64_t evictions = 0;
+    size_t numEntries = 0;
+    size_t numBytes = 0;
+  };
+
+  // 0 means unbounded
+  explicit CompressedFieldsCache(size_t maxBytes_ = 0);
+
+  void SetMaxBytes(size_t maxBytes_);
+  size_t GetMaxBytes() const;
+
+  // Returns true if the cache is within its byte budget
+  bool IsWithinBudget() const;
+
+  // Evicts least recently used entries until the cache fits its byte budget
+  void Trim();
+
+  void Clear();
+
+  Stats GetStats() const;
 
 private:
+  CompressedFieldsCache(const CompressedFieldsCache&) = delete;
+  CompressedFieldsCache& operator=(const CompressedFieldsCache&) = delete;
+
+  // Counts a hit or a miss and marks the entry as recently used
+  Fields Find(const RecordHeader* rec);
+
+  // Returns the stored entry if another thread has inserted it first
+  Fields Insert(const RecordHeader* rec, Fields fields);
+
   struct Entry
   {
-    std::shared_ptr<std::vector<uint8_t>> decompressedFieldsHolder;
+    Fields decompressedFieldsHolder;
+    std::list<const RecordHeader*>::iterator lruIt;
   };
 
+  mutable std::mutex m;
   std::unordered_map<const RecordHeader*, Entry> data;
+  std::list<const RecordHeader*> lru; // Most recently used first
+  size_t maxBytes = 0;
+  Stats stats;
 };
 
 }
-
-#pragma pack(pop)
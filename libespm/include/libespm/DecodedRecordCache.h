@@ -0,0 +1,67 @@
+#pragma once
+#include "CompressedFieldsCache.h"
+#include "Type.h"
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <unordered_map>
+
+namespace espm {
+
+// Decoded records (RecordT::Data) keyed by combined form id, shared by all
+// users of a Loader. Entries are immutable and are never evicted, so
+// references returned by Get stay valid for the lifetime of the cache.
+//
+// Decoded data may point into decompressed fields, so decoding uses the
+// cache's own CompressedFieldsCache rather than the caller's one.
+//
+// Thread-safe. Lookups of decoded records only take a shared lock
+class DecodedRecordCache
+{
+public:
+  template <class RecordT>
+  const typename RecordT::Data& Get(uint32_t formId, const RecordT* record)
+  {
+    using Data = typename RecordT::Data;
+
+    const uint64_t key = MakeKey(formId, RecordT::kType);
+    {
+      std::shared_lock l(m);
+      auto it = entries.find(key);
+      if (it != entries.end()) {
+        return *static_cast<const Data*>(it->second.get());
+      }
+    }
+
+    std::lock_guard l(m);
+    auto it = entries.find(key);
+    if (it == entries.end()) {
+      // GetData may throw, don't leave an empty entry in this case
+      std::shared_ptr<const void> data =
+        std::make_shared<const Data>(record->GetData(compressedFieldsCache));
+      it = entries.emplace(key, std::move(data)).first;
+    }
+    return *static_cast<const Data*>(it->second.get());
+  }
+
+  size_t GetSize() const
+  {
+    std::shared_lock l(m);
+    return entries.size();
+  }
+
+private:
+  static uint64_t MakeKey(uint32_t formId, const char* type) noexcept
+  {
+    return (static_cast<uint64_t>(Type(type).ToUint32()) << 32) | formId;
+  }
+
+  mutable std::shared_mutex m;
+  std::unordered_map<uint64_t, std::shared_ptr<const void>> entries;
+
+  // Guarded by the exclusive lock. Never trimmed, unlike the Loader's one
+  CompressedFieldsCache compressedFieldsCache;
+};
+
+}
@@ -13,6 +13,7 @@ namespace fs = std::filesystem;
 
 #include "Browser.h"
 #include "Combiner.h"
+#include "DecodedRecordCache.h"
 #include "IBuffer.h"
 #include "espm.h"
 
@@ -30,18 +31,29 @@ public:
   using OnProgress = std::function<void(std::string fileName, float readDur,
                                         float parseDur, uintmax_t fileSize)>;
 
+  // If indexCacheDir is not empty, Browser indexes are saved there and
+  // reused on the next start while the file hash (see GetFilesInfo) matches
   Loader(const fs::path& dataDir, const std::vector<fs::path>& fileNames,
          OnProgress onProgress = nullptr,
-         BufferType bufferType_ = BufferType::MappedBuffer);
+         BufferType bufferType_ = BufferType::MappedBuffer,
+         const fs::path& indexCacheDir_ = {});
 
   Loader(const std::vector<fs::path>& filePaths_,
          OnProgress onProgress = nullptr,
-         BufferType bufferType_ = BufferType::MappedBuffer);
+         BufferType bufferType_ = BufferType::MappedBuffer,
+         const fs::path& indexCacheDir_ = {});
 
   const CombineBrowser& GetBrowser() const noexcept;
 
+  // Records decoded by espm::GetData. Thread-safe
+  DecodedRecordCache& GetDecodedRecordCache() const noexcept;
+
   std::vector<std::string> GetFileNames() const noexcept;
 
+  // Decompresses records of the given types into GetBrowser().GetCache()
+  // using all cores. Stops once the cache reaches its byte budget
+  void PrewarmCompressedFields(const std::vector<std::string>& types) const;
+
   struct FileInfo
   {
     uint32_t crc32 = 0;
@@ -56,6 +68,10 @@ private:
 
   std::unique_ptr<Viet::IBuffer> MakeBuffer(const fs::path& filePath) const;
 
+  std::unique_ptr<Browser> MakeBrowser(const Viet::IBuffer& buffer,
+                                       const std::string& fileName,
+                                       size_t numThreads) const;
+
   struct Entry
   {
     std::unique_ptr<Viet::IBuffer> buffer;
@@ -70,8 +86,10 @@ private:
   std::vector<Entry> entries;
   std::unique_ptr<Combiner> combiner;
   std::unique_ptr<CombineBrowser> combineBrowser;
+  std::unique_ptr<DecodedRecordCache> decodedRecordCache;
   std::vector<fs::path> filePaths;
   BufferType bufferType;
+  fs::path indexCacheDir;
 };
 
 template <class EspmProvider>
@@ -93,8 +111,10 @@ Type GetRecordType(uint32_t formId, EspmProvider* espmProvider)
   return lookupResult.rec->GetType();
 }
 
+// The returned reference is valid as long as the Loader is alive
 template <class RecordT, class EspmProvider>
-typename RecordT::Data GetData(uint32_t formId, EspmProvider* espmProvider)
+const typename RecordT::Data& GetData(uint32_t formId,
+                                      EspmProvider* espmProvider)
 {
   if (!espmProvider) {
     throw std::runtime_error("Unable to find record without EspmProvider");
@@ -102,9 +122,6 @@ typename RecordT::Data GetData(uint32_t formId, EspmProvider* espmProvider)
 
   auto& espmLoader = espmProvider->GetEspm();
 
-  // That's why espmProvider is non-const: cache is mutable
-  CompressedFieldsCache& espmCache = espmProvider->GetEspmCache();
-
   const LookupResult lookupResult = espmLoader.GetBrowser().LookupById(formId);
 
   if (!lookupResult.rec) {
@@ -119,7 +136,21 @@ typename RecordT::Data GetData(uint32_t formId, EspmProvider* espmProvider)
                   RecordT::kType, lookupResult.rec->GetType().ToString()));
   }
 
-  return convertedRecord->GetData(espmCache);
+  return espmLoader.GetDecodedRecordCache().Get(formId, convertedRecord);
+}
+
+// Decodes all records of the type in advance, so that the first
+// espm::GetData call doesn't pay for it
+template <class RecordT>
+void PrewarmDecodedRecords(const Loader& loader)
+{
+  auto& cache = loader.GetDecodedRecordCache();
+  for (auto& lookupResult :
+       loader.GetBrowser().GetDistinctRecordsByType(RecordT::kType)) {
+    if (auto record = Convert<RecordT>(lookupResult.rec)) {
+      cache.Get(lookupResult.ToGlobalId(record->GetId()), record);
+    }
+  }
 }
 
 } // namespace espm
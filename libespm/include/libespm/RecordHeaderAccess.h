@@ -18,9 +18,11 @@ public:
     const int8_t* endPtr = ptr + rec->GetFieldsSizeSum();
     uint32_t fiDataSizeOverride = 0;
 
+    // Keeps the fields alive while iterating even if the cache is trimmed
+    CompressedFieldsCache::Fields decompressedFieldsHolder;
+
     if (rec->flags & RecordFlags::Compressed) {
-      auto& decompressedFieldsHolder =
-        compressedFieldsCache.data[rec].decompressedFieldsHolder;
+      decompressedFieldsHolder = compressedFieldsCache.Find(rec);
       if (!decompressedFieldsHolder) {
         const uint32_t* decompSize = reinterpret_cast<const uint32_t*>(ptr);
         ptr += sizeof(uint32_t);
@@ -31,12 +33,14 @@ public:
         const auto inSize = rec->GetFieldsSizeSum() - sizeof(uint32_t);
         ZlibDecompress(ptr, inSize, out->data(), out->size());
 
-        decompressedFieldsHolder = out;
+        decompressedFieldsHolder =
+          compressedFieldsCache.Insert(rec, std::move(out));
       }
 
-      ptr = reinterpret_cast<int8_t*>(decompressedFieldsHolder->data());
-      endPtr = reinterpret_cast<int8_t*>(decompressedFieldsHolder->data() +
-                                         decompressedFieldsHolder->size());
+      ptr = reinterpret_cast<const int8_t*>(decompressedFieldsHolder->data());
+      endPtr =
+        reinterpret_cast<const int8_t*>(decompressedFieldsHolder->data() +
+                                        decompressedFieldsHolder->size());
     }
 
     while (ptr < endPtr) {
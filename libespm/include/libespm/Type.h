@@ -1,5 +1,6 @@
 #pragma once
 #include <cstdint>
+#include <cstring>
 #include <string>
 
 #pragma pack(push, 1)
@@ -12,7 +13,15 @@ public:
   // Type object doesn't own this pointer
   explicit Type(const char* type_) noexcept;
 
-  bool operator==(const char* rhs) const noexcept;
+  // Inline: record and field types are compared in every GetData loop
+  bool operator==(const char* rhs) const noexcept
+  {
+    uint32_t lhsValue, rhsValue;
+    std::memcpy(&lhsValue, type, sizeof(lhsValue));
+    std::memcpy(&rhsValue, rhs, sizeof(rhsValue));
+    return lhsValue == rhsValue;
+  }
+
   std::string ToString() const noexcept;
   uint32_t ToUint32() const noexcept;
 
@@ -9,30 +9,35 @@
 #include "libespm/GroupUtils.h"
 #include "libespm/KYWD.h"
 #include "libespm/NAVM.h"
+#include "libespm/NPC_.h"
 #include "libespm/NavMeshKey.h"
 #include "libespm/QUST.h"
+#include "libespm/RACE.h"
 #include "libespm/REFR.h"
 #include "libespm/RecordHeader.h"
 #include "libespm/RefrKey.h"
+#include "libespm/Utils.h"
 #include "libespm/WRLD.h"
+#include "ParallelFor.h"
 #include <cstring>
+#include <functional>
+#include <iterator>
+#include <limits>
 #include <optional>
 #include <stdexcept>
+#include <type_traits>
 #include <unordered_map>
 #include <vector>
 
 namespace espm {
 
-struct Browser::Impl
-{
-
-  Impl() { objectReferences.reserve(100'000); }
-
-  const char* buf = nullptr;
-  size_t length = 0;
+namespace {
 
-  size_t pos = 0;
-  uint32_t fiDataSizeOverride = 0;
+// Lookup tables built while walking the file. Large files are split into
+// top-level GRUP ranges that are indexed into separate Index instances in
+// parallel and then appended in file order
+struct Index
+{
   std::unordered_map<uint32_t, const RecordHeader*> recById;
   std::unordered_map<uint64_t, std::vector<const RecordHeader*>> navmeshes;
   std::unordered_map<uint64_t, std::vector<const RecordHeader*>>
@@ -48,12 +53,326 @@ struct Browser::Impl
   std::vector<const RecordHeader*> quests;
   std::vector<const RecordHeader*> worlds;
   std::vector<const RecordHeader*> cells;
+  std::vector<const RecordHeader*> npcs;
+  std::vector<const RecordHeader*> races;
 
-  GroupStack grStack;
   std::vector<std::unique_ptr<GroupStack>> grStackCopies;
   std::vector<std::unique_ptr<GroupDataInternal>> grDataHolder;
+};
+
+// Lets GroupUtils work with a record that isn't in groupStackByRecordPtr yet
+struct ParentGroupsOf
+{
+  const GroupStack* parentGrStack = nullptr;
+
+  const GroupStack& GetParentGroupsEnsured(const RecordHeader*) const
+  {
+    if (!parentGrStack) {
+      throw std::runtime_error("espm::Browser: no parent groups for record");
+    }
+    return *parentGrStack;
+  }
+};
+
+// Walks [pos, end) of the file buffer
+class Reader
+{
+public:
+  Reader(const char* buf_, size_t pos_, size_t end_, Index& index_)
+    : buf(buf_)
+    , pos(pos_)
+    , end(end_)
+    , index(index_)
+  {
+  }
+
+  bool ReadAny(const GroupStack* parentGrStack);
+
+private:
+  const char* const buf;
+  size_t pos = 0;
+  const size_t end;
+  Index& index;
 
+  GroupStack grStack;
   CompressedFieldsCache dummyCache;
+};
+
+struct TopLevelRange
+{
+  size_t begin = 0;
+  size_t end = 0;
+};
+
+std::vector<TopLevelRange> FindTopLevelRanges(const char* buf, size_t length)
+{
+  std::vector<TopLevelRange> res;
+  size_t pos = 0;
+  while (pos < length) {
+    const bool isGrup = !std::memcmp(buf + pos, "GRUP", 4);
+    const uint32_t dataSize =
+      *reinterpret_cast<const uint32_t*>(buf + pos + 4);
+
+    // Group size includes the 24-byte header, record size doesn't
+    const size_t size =
+      isGrup ? dataSize : 8 + sizeof(RecordHeader) + dataSize;
+    if (size < 8 + sizeof(GroupHeader)) {
+      return {}; // Malformed, leave it to the single-threaded path
+    }
+    res.push_back({ pos, std::min(pos + size, length) });
+    pos += size;
+  }
+  return res;
+}
+
+template <class T>
+void AppendVectors(std::vector<T>& dst, std::vector<Index>& parts,
+                   std::vector<T> Index::*member)
+{
+  size_t n = dst.size();
+  for (auto& part : parts) {
+    n += (part.*member).size();
+  }
+  dst.reserve(n);
+  for (auto& part : parts) {
+    auto& src = part.*member;
+    dst.insert(dst.end(), std::make_move_iterator(src.begin()),
+               std::make_move_iterator(src.end()));
+  }
+}
+
+template <class Map>
+void AppendMaps(Map& dst, std::vector<Index>& parts, Map Index::*member)
+{
+  size_t n = dst.size();
+  for (auto& part : parts) {
+    n += (part.*member).size();
+  }
+  dst.reserve(n);
+
+  // Later parts win, like when a single thread overwrites recById entries
+  for (auto& part : parts) {
+    for (auto& [key, value] : part.*member) {
+      if constexpr (std::is_same_v<typename Map::mapped_type,
+                                   std::vector<const RecordHeader*>>) {
+        auto& v = dst[key];
+        v.insert(v.end(), value.begin(), value.end());
+      } else {
+        dst[key] = value;
+      }
+    }
+  }
+}
+
+// Containers are independent, so each one is merged on its own thread
+void AppendIndexes(Index& dst, std::vector<Index>& parts, size_t numThreads)
+{
+  const std::vector<std::function<void()>> steps = {
+    [&] { AppendMaps(dst.recById, parts, &Index::recById); },
+    [&] { AppendMaps(dst.navmeshes, parts, &Index::navmeshes); },
+    [&] {
+      AppendMaps(dst.cellOrWorldChildren, parts, &Index::cellOrWorldChildren);
+    },
+    [&] {
+      AppendMaps(dst.groupDataByGroupPtr, parts, &Index::groupDataByGroupPtr);
+    },
+    [&] {
+      AppendMaps(dst.groupStackByRecordPtr, parts,
+                 &Index::groupStackByRecordPtr);
+    },
+    [&] {
+      AppendVectors(dst.objectReferences, parts, &Index::objectReferences);
+      AppendVectors(dst.constructibleObjects, parts,
+                    &Index::constructibleObjects);
+      AppendVectors(dst.keywords, parts, &Index::keywords);
+      AppendVectors(dst.factions, parts, &Index::factions);
+      AppendVectors(dst.quests, parts, &Index::quests);
+      AppendVectors(dst.worlds, parts, &Index::worlds);
+      AppendVectors(dst.cells, parts, &Index::cells);
+      AppendVectors(dst.npcs, parts, &Index::npcs);
+      AppendVectors(dst.races, parts, &Index::races);
+      AppendVectors(dst.grStackCopies, parts, &Index::grStackCopies);
+      AppendVectors(dst.grDataHolder, parts, &Index::grDataHolder);
+    }
+  };
+  Viet::ParallelFor(steps.size(), numThreads,
+                    [&](size_t i) { steps[i](); });
+}
+// Sidecar index format. All values are little-endian, pointers into the file
+// buffer are stored as 32-bit offsets from its beginning. The header is
+// followed by CRC32 of the rest of the index
+constexpr char kIndexMagic[8] = { 'E', 'S', 'P', 'M', 'I', 'D', 'X', 0 };
+constexpr uint32_t kIndexVersion = 2;
+constexpr uint32_t kNullStack = 0xffffffff;
+
+class IndexWriter
+{
+public:
+  explicit IndexWriter(const char* buf_)
+    : buf(buf_)
+  {
+  }
+
+  void Bytes(const void* data, size_t size)
+  {
+    auto p = static_cast<const uint8_t*>(data);
+    out.insert(out.end(), p, p + size);
+  }
+
+  void U32(uint32_t v) { Bytes(&v, sizeof(v)); }
+
+  void U64(uint64_t v) { Bytes(&v, sizeof(v)); }
+
+  void Offset(const void* p)
+  {
+    U32(static_cast<uint32_t>(static_cast<const char*>(p) - buf));
+  }
+
+  void Offsets(const std::vector<const RecordHeader*>& v)
+  {
+    U32(static_cast<uint32_t>(v.size()));
+    for (auto p : v) {
+      Offset(p);
+    }
+  }
+
+  std::vector<uint8_t> out;
+
+private:
+  const char* const buf;
+};
+
+// Throws on any out-of-bounds read, whether in the index or in the file
+class IndexReader
+{
+public:
+  IndexReader(const char* buf_, size_t length_, const char* index_,
+              size_t indexLength_)
+    : buf(buf_)
+    , length(length_)
+    , index(index_)
+    , indexLength(indexLength_)
+  {
+  }
+
+  void Bytes(void* data, size_t size)
+  {
+    if (size > indexLength - pos) {
+      Fail();
+    }
+    std::memcpy(data, index + pos, size);
+    pos += size;
+  }
+
+  uint32_t U32()
+  {
+    uint32_t v;
+    Bytes(&v, sizeof(v));
+    return v;
+  }
+
+  uint64_t U64()
+  {
+    uint64_t v;
+    Bytes(&v, sizeof(v));
+    return v;
+  }
+
+  uint32_t ChecksumOfRest() const
+  {
+    return utils::CalculateHashcode(index + pos, indexLength - pos);
+  }
+
+  // Count of elements that take at least elementSize bytes each
+  uint32_t Count(size_t elementSize)
+  {
+    auto n = U32();
+    if (static_cast<uint64_t>(n) * elementSize > indexLength - pos) {
+      Fail();
+    }
+    return n;
+  }
+
+  // minOffset is the size of the type and size fields before the header
+  template <class T>
+  const T* Ptr(size_t minOffset)
+  {
+    auto offset = U32();
+    if (offset < minOffset || offset > length ||
+        sizeof(T) > length - offset) {
+      Fail();
+    }
+    return reinterpret_cast<const T*>(buf + offset);
+  }
+
+  const RecordHeader* Record() { return Ptr<RecordHeader>(8); }
+
+  const GroupHeader* Group() { return Ptr<GroupHeader>(8); }
+
+  // Points to the type field of a record or group
+  const void* Sub() { return Ptr<char[8]>(0); }
+
+  void Records(std::vector<const RecordHeader*>& v)
+  {
+    auto n = Count(4);
+    v.reserve(v.size() + n);
+    for (uint32_t i = 0; i < n; ++i) {
+      v.push_back(Record());
+    }
+  }
+
+  bool AtEnd() const noexcept { return pos == indexLength; }
+
+  [[noreturn]] static void Fail()
+  {
+    throw std::runtime_error("espm::Browser: malformed index");
+  }
+
+private:
+  const char* const buf;
+  const size_t length;
+  const char* const index;
+  const size_t indexLength;
+  size_t pos = 0;
+};
+
+template <class Map>
+void WriteRecordsByKey(IndexWriter& w, const Map& map)
+{
+  w.U32(static_cast<uint32_t>(map.size()));
+  for (auto& [key, records] : map) {
+    w.U64(key);
+    w.Offsets(records);
+  }
+}
+
+template <class Map>
+void ReadRecordsByKey(IndexReader& r, Map& map)
+{
+  auto n = r.Count(12);
+  map.reserve(n);
+  for (uint32_t i = 0; i < n; ++i) {
+    auto key = r.U64();
+    r.Records(map[key]);
+  }
+}
+
+std::vector<std::vector<const RecordHeader*> Index::*> GetTypeVectors()
+{
+  return { &Index::objectReferences, &Index::constructibleObjects,
+           &Index::keywords,         &Index::factions,
+           &Index::quests,           &Index::worlds,
+           &Index::cells,            &Index::npcs,
+           &Index::races };
+}
+}
+
+struct Browser::Impl : public Index
+{
+  Impl() { objectReferences.reserve(100'000); }
+
+  const char* buf = nullptr;
+  size_t length = 0;
 
   // may return null
   const GroupStack* GetParentGroupsOptional(
@@ -78,18 +397,177 @@ struct Browser::Impl
   }
 };
 
-Browser::Browser(const void* fileContent, size_t length)
+Browser::Browser(const void* fileContent, size_t length, size_t numThreads)
   : pImpl(std::make_unique<Impl>())
 {
-  pImpl->buf = static_cast<const char*>(fileContent);
+  auto buf = static_cast<const char*>(fileContent);
+  pImpl->buf = buf;
   pImpl->length = length;
-  while (ReadAny(nullptr))
-    ;
-  pImpl->dummyCache.data.clear();
+
+  std::vector<TopLevelRange> ranges;
+  if (numThreads > 1) {
+    ranges = FindTopLevelRanges(buf, length);
+  }
+
+  if (ranges.size() <= 1) {
+    Reader reader(buf, 0, length, *pImpl);
+    while (reader.ReadAny(nullptr))
+      ;
+    return;
+  }
+
+  std::vector<Index> parts(ranges.size());
+  Viet::ParallelFor(ranges.size(), numThreads, [&](size_t i) {
+    Reader reader(buf, ranges[i].begin, ranges[i].end, parts[i]);
+    while (reader.ReadAny(nullptr))
+      ;
+  });
+  AppendIndexes(*pImpl, parts, numThreads);
+}
+
+Browser::Browser(const void* fileContent, size_t length, const void* index,
+                 size_t indexLength)
+  : pImpl(std::make_unique<Impl>())
+{
+  auto buf = static_cast<const char*>(fileContent);
+  pImpl->buf = buf;
+  pImpl->length = length;
+
+  IndexReader r(buf, length, static_cast<const char*>(index), indexLength);
+
+  char magic[sizeof(kIndexMagic)];
+  r.Bytes(magic, sizeof(magic));
+  if (std::memcmp(magic, kIndexMagic, sizeof(magic)) != 0 ||
+      r.U32() != kIndexVersion) {
+    throw std::runtime_error("espm::Browser: unknown index format");
+  }
+  if (r.U32() != r.ChecksumOfRest()) {
+    throw std::runtime_error("espm::Browser: index checksum mismatch");
+  }
+  if (r.U64() != length) {
+    throw std::runtime_error("espm::Browser: index doesn't match the file");
+  }
+
+  auto numStacks = r.Count(4);
+  pImpl->grStackCopies.reserve(numStacks);
+  for (uint32_t i = 0; i < numStacks; ++i) {
+    auto n = r.Count(4);
+    auto& stack = pImpl->grStackCopies.emplace_back(new GroupStack);
+    stack->reserve(n);
+    for (uint32_t j = 0; j < n; ++j) {
+      stack->push_back(r.Group());
+    }
+  }
+
+  auto numGroups = r.Count(8);
+  pImpl->grDataHolder.reserve(numGroups);
+  pImpl->groupDataByGroupPtr.reserve(numGroups);
+  for (uint32_t i = 0; i < numGroups; ++i) {
+    auto group = r.Group();
+    auto n = r.Count(4);
+    auto& grData = pImpl->grDataHolder.emplace_back(new GroupDataInternal);
+    grData->subs.reserve(n);
+    for (uint32_t j = 0; j < n; ++j) {
+      grData->subs.push_back(r.Sub());
+    }
+    pImpl->groupDataByGroupPtr.emplace(group, grData.get());
+  }
+
+  auto numRecords = r.Count(8);
+  pImpl->groupStackByRecordPtr.reserve(numRecords);
+  for (uint32_t i = 0; i < numRecords; ++i) {
+    auto rec = r.Record();
+    auto stackIdx = r.U32();
+    if (stackIdx != kNullStack && stackIdx >= numStacks) {
+      IndexReader::Fail();
+    }
+    pImpl->groupStackByRecordPtr.emplace(
+      rec,
+      stackIdx == kNullStack ? nullptr
+                             : pImpl->grStackCopies[stackIdx].get());
+  }
+
+  auto numIds = r.Count(8);
+  pImpl->recById.reserve(numIds);
+  for (uint32_t i = 0; i < numIds; ++i) {
+    auto id = r.U32();
+    pImpl->recById.emplace(id, r.Record());
+  }
+
+  ReadRecordsByKey(r, pImpl->navmeshes);
+  ReadRecordsByKey(r, pImpl->cellOrWorldChildren);
+
+  for (auto member : GetTypeVectors()) {
+    r.Records((*pImpl).*member);
+  }
+
+  if (!r.AtEnd()) {
+    IndexReader::Fail();
+  }
 }
 
 Browser::~Browser() = default;
 
+std::vector<uint8_t> Browser::SerializeIndex() const
+{
+  if (pImpl->length > std::numeric_limits<uint32_t>::max()) {
+    throw std::runtime_error("espm::Browser: file is too large to index");
+  }
+
+  IndexWriter w(pImpl->buf);
+  w.Bytes(kIndexMagic, sizeof(kIndexMagic));
+  w.U32(kIndexVersion);
+  const size_t checksumPos = w.out.size();
+  w.U32(0); // checksum, filled in below
+  w.U64(pImpl->length);
+
+  std::unordered_map<const GroupStack*, uint32_t> stackIndices;
+  w.U32(static_cast<uint32_t>(pImpl->grStackCopies.size()));
+  for (auto& stack : pImpl->grStackCopies) {
+    stackIndices.emplace(stack.get(),
+                         static_cast<uint32_t>(stackIndices.size()));
+    w.U32(static_cast<uint32_t>(stack->size()));
+    for (auto group : *stack) {
+      w.Offset(group);
+    }
+  }
+
+  w.U32(static_cast<uint32_t>(pImpl->groupDataByGroupPtr.size()));
+  for (auto& [group, grData] : pImpl->groupDataByGroupPtr) {
+    w.Offset(group);
+    w.U32(static_cast<uint32_t>(grData->subs.size()));
+    for (auto sub : grData->subs) {
+      w.Offset(sub);
+    }
+  }
+
+  w.U32(static_cast<uint32_t>(pImpl->groupStackByRecordPtr.size()));
+  for (auto& [rec, stack] : pImpl->groupStackByRecordPtr) {
+    w.Offset(rec);
+    w.U32(stack ? stackIndices.at(stack) : kNullStack);
+  }
+
+  w.U32(static_cast<uint32_t>(pImpl->recById.size()));
+  for (auto& [id, rec] : pImpl->recById) {
+    w.U32(id);
+    w.Offset(rec);
+  }
+
+  WriteRecordsByKey(w, pImpl->navmeshes);
+  WriteRecordsByKey(w, pImpl->cellOrWorldChildren);
+
+  for (auto member : GetTypeVectors()) {
+    w.Offsets((*pImpl).*member);
+  }
+
+  const size_t payloadPos = checksumPos + sizeof(uint32_t);
+  uint32_t checksum = utils::CalculateHashcode(w.out.data() + payloadPos,
+                                               w.out.size() - payloadPos);
+  std::memcpy(w.out.data() + checksumPos, &checksum, sizeof(checksum));
+
+  return std::move(w.out);
+}
+
 const RecordHeader* Browser::LookupById(uint32_t formId) const noexcept
 {
   auto it = pImpl->recById.find(formId);
@@ -134,8 +612,15 @@ const std::vector<const RecordHeader*>& Browser::GetRecordsByType(
   if (!std::strcmp(type, espm::CELL::kType)) {
     return pImpl->cells;
   }
+  if (!std::strcmp(type, espm::NPC_::kType)) {
+    return pImpl->npcs;
+  }
+  if (!std::strcmp(type, espm::RACE::kType)) {
+    return pImpl->races;
+  }
   throw std::runtime_error("GetRecordsByType currently supports only REFR, "
-                           "COBJ, KYWD, FACT, QUST, WRLD and CELL records");
+                           "COBJ, KYWD, FACT, QUST, WRLD, CELL, NPC_ and RACE "
+                           "records");
 }
 
 const std::vector<const RecordHeader*>& Browser::GetRecordsAtPos(
@@ -182,52 +667,49 @@ const std::vector<const void*>& Browser::GetSubsEnsured(
   return *opt;
 }
 
-bool Browser::ReadAny(const GroupStack* parentGrStack)
+bool Reader::ReadAny(const GroupStack* parentGrStack)
 {
-  if (pImpl->pos >= pImpl->length) {
+  if (pos >= end) {
     return false;
   }
 
-  const char* pType = static_cast<const char*>(pImpl->buf + pImpl->pos);
-  pImpl->pos += 4;
-  const uint32_t* pDataSize =
-    reinterpret_cast<const uint32_t*>(pImpl->buf + pImpl->pos);
-  pImpl->pos += 4;
+  const char* pType = static_cast<const char*>(buf + pos);
+  pos += 4;
+  const uint32_t* pDataSize = reinterpret_cast<const uint32_t*>(buf + pos);
+  pos += 4;
 
   const bool isGrup = !std::memcmp(pType, "GRUP", 4);
   if (isGrup) {
     // Read group header
-    const auto grHeader =
-      reinterpret_cast<const GroupHeader*>(pImpl->buf + pImpl->pos);
+    const auto grHeader = reinterpret_cast<const GroupHeader*>(buf + pos);
 
     const auto grData = new GroupDataInternal;
-    pImpl->grDataHolder.emplace_back(grData);
-    pImpl->groupDataByGroupPtr.emplace(grHeader, grData);
+    index.grDataHolder.emplace_back(grData);
+    index.groupDataByGroupPtr.emplace(grHeader, grData);
 
-    pImpl->pos += sizeof(GroupHeader);
-    const size_t end = pImpl->pos + *pDataSize - 24;
+    pos += sizeof(GroupHeader);
+    const size_t grEnd = pos + *pDataSize - 24;
 
-    pImpl->grStack.push_back(grHeader);
-    auto p = new GroupStack(pImpl->grStack);
-    pImpl->grStackCopies.emplace_back(p);
-    while (pImpl->pos < end) {
-      const char* nextSub = &pImpl->buf[pImpl->pos];
+    grStack.push_back(grHeader);
+    auto p = new GroupStack(grStack);
+    index.grStackCopies.emplace_back(p);
+    while (pos < grEnd) {
+      const char* nextSub = &buf[pos];
       if (ReadAny(p)) {
         grData->subs.push_back(nextSub);
       }
     }
-    pImpl->grStack.pop_back();
+    grStack.pop_back();
   } else {
     // Read record header
-    const auto recHeader =
-      reinterpret_cast<const RecordHeader*>(pImpl->buf + pImpl->pos);
-    pImpl->groupStackByRecordPtr.emplace(recHeader, parentGrStack);
+    const auto recHeader = reinterpret_cast<const RecordHeader*>(buf + pos);
+    index.groupStackByRecordPtr.emplace(recHeader, parentGrStack);
 
-    pImpl->recById[recHeader->id] = recHeader;
+    index.recById[recHeader->GetId()] = recHeader;
 
     Type t = recHeader->GetType();
     if (utils::Is<espm::REFR>(t) || utils::Is<espm::ACHR>(t)) {
-      pImpl->objectReferences.push_back(recHeader);
+      index.objectReferences.push_back(recHeader);
       const auto refr = reinterpret_cast<const REFR*>(recHeader);
 
       CompressedFieldsCache dummyCache;
@@ -236,46 +718,55 @@ bool Browser::ReadAny(const GroupStack* parentGrStack)
       if (data.loc) {
         const int16_t x = static_cast<int16_t>(data.loc->pos[0] / 4096);
         const int16_t y = static_cast<int16_t>(data.loc->pos[1] / 4096);
-        const auto cellOrWorld = GetWorldOrCell(*this, refr);
+        const auto cellOrWorld =
+          GetWorldOrCell(ParentGroupsOf{ parentGrStack }, refr);
         const RefrKey refrKey(cellOrWorld, x, y);
-        pImpl->cellOrWorldChildren[refrKey].push_back(refr);
+        index.cellOrWorldChildren[refrKey].push_back(refr);
       }
     }
 
     if (utils::Is<espm::COBJ>(t)) {
-      pImpl->constructibleObjects.push_back(recHeader);
+      index.constructibleObjects.push_back(recHeader);
     }
 
     if (utils::Is<espm::KYWD>(t)) {
-      pImpl->keywords.push_back(recHeader);
+      index.keywords.push_back(recHeader);
     }
 
     if (utils::Is<espm::FACT>(t)) {
-      pImpl->factions.push_back(recHeader);
+      index.factions.push_back(recHeader);
     }
 
     if (utils::Is<espm::NAVM>(t)) {
       auto nvnm = reinterpret_cast<const NAVM*>(recHeader);
 
-      auto& v = pImpl->navmeshes[NavMeshKey(
-        nvnm->GetData(pImpl->dummyCache).worldSpaceId,
-        nvnm->GetData(pImpl->dummyCache).cellOrGridPos)];
+      auto& v = index.navmeshes[NavMeshKey(
+        nvnm->GetData(dummyCache).worldSpaceId,
+        nvnm->GetData(dummyCache).cellOrGridPos)];
       v.push_back(nvnm);
     }
 
     if (utils::Is<espm::QUST>(t)) {
-      pImpl->quests.push_back(recHeader);
+      index.quests.push_back(recHeader);
     }
 
     if (utils::Is<espm::WRLD>(t)) {
-      pImpl->worlds.push_back(recHeader);
+      index.worlds.push_back(recHeader);
     }
 
     if (utils::Is<espm::CELL>(t)) {
-      pImpl->cells.push_back(recHeader);
+      index.cells.push_back(recHeader);
+    }
+
+    if (utils::Is<espm::NPC_>(t)) {
+      index.npcs.push_back(recHeader);
+    }
+
+    if (utils::Is<espm::RACE>(t)) {
+      index.races.push_back(recHeader);
     }
 
-    pImpl->pos += sizeof(RecordHeader) + *pDataSize;
+    pos += sizeof(RecordHeader) + *pDataSize;
   }
   return true;
 }
@@ -5,4 +5,91 @@
 
 namespace espm {
 
+CompressedFieldsCache::CompressedFieldsCache(size_t maxBytes_)
+  : maxBytes(maxBytes_)
+{
+}
+
+void CompressedFieldsCache::SetMaxBytes(size_t maxBytes_)
+{
+  std::lock_guard l(m);
+  maxBytes = maxBytes_;
+}
+
+size_t CompressedFieldsCache::GetMaxBytes() const
+{
+  std::lock_guard l(m);
+  return maxBytes;
+}
+
+bool CompressedFieldsCache::IsWithinBudget() const
+{
+  std::lock_guard l(m);
+  return maxBytes == 0 || stats.numBytes <= maxBytes;
+}
+
+void CompressedFieldsCache::Trim()
+{
+  std::lock_guard l(m);
+  if (maxBytes == 0) {
+    return;
+  }
+
+  while (stats.numBytes > maxBytes && !lru.empty()) {
+    auto it = data.find(lru.back());
+    stats.numBytes -= it->second.decompressedFieldsHolder->size();
+    data.erase(it);
+    lru.pop_back();
+    ++stats.evictions;
+  }
+  stats.numEntries = data.size();
+}
+
+void CompressedFieldsCache::Clear()
+{
+  std::lock_guard l(m);
+  data.clear();
+  lru.clear();
+  stats.numEntries = 0;
+  stats.numBytes = 0;
+}
+
+CompressedFieldsCache::Stats CompressedFieldsCache::GetStats() const
+{
+  std::lock_guard l(m);
+  return stats;
+}
+
+CompressedFieldsCache::Fields CompressedFieldsCache::Find(
+  const RecordHeader* rec)
+{
+  std::lock_guard l(m);
+  auto it = data.find(rec);
+  if (it == data.end()) {
+    ++stats.misses;
+    return nullptr;
+  }
+
+  ++stats.hits;
+  lru.splice(lru.begin(), lru, it->second.lruIt);
+  return it->second.decompressedFieldsHolder;
+}
+
+CompressedFieldsCache::Fields CompressedFieldsCache::Insert(
+  const RecordHeader* rec, Fields fields)
+{
+  std::lock_guard l(m);
+  auto [it, inserted] = data.try_emplace(rec);
+  if (!inserted) {
+    return it->second.decompressedFieldsHolder;
+  }
+
+  lru.push_front(rec);
+  it->second.lruIt = lru.begin();
+  it->second.decompressedFieldsHolder = std::move(fields);
+  stats.numBytes += it->second.decompressedFieldsHolder->size();
+  stats.numEntries = data.size();
+  return it->second.decompressedFieldsHolder;
+}
+
 }
@@ -2,24 +2,56 @@
 
 #include "AllocatedBuffer.h"
 #include "MappedBuffer.h"
+#include "ParallelFor.h"
+#include "libespm/RecordFlags.h"
+#include "libespm/RecordHeaderAccess.h"
 #include "libespm/Utils.h"
+#include <algorithm>
+#include <random>
+#include <system_error>
+
+#ifdef _WIN32
+#  include <process.h>
+#  define getpid _getpid
+#else
+#  include <unistd.h>
+#endif
 
 namespace espm {
 
 Loader::Loader(const fs::path& dataDir, const std::vector<fs::path>& fileNames,
-               OnProgress onProgress, BufferType bufferType_)
-  : Loader(MakeFilePaths(dataDir, fileNames), onProgress, bufferType_)
+               OnProgress onProgress, BufferType bufferType_,
+               const fs::path& indexCacheDir_)
+  : Loader(MakeFilePaths(dataDir, fileNames), onProgress, bufferType_,
+           indexCacheDir_)
 {
 }
 
 Loader::Loader(const std::vector<fs::path>& filePaths_, OnProgress onProgress,
-               BufferType bufferType_)
+               BufferType bufferType_, const fs::path& indexCacheDir_)
   : filePaths(filePaths_)
   , bufferType(bufferType_)
+  , indexCacheDir(indexCacheDir_)
 {
-  for (const auto& p : filePaths) {
-    entries.emplace_back();
-    auto& entry = entries.back();
+  // Files are parsed in parallel. Threads are split between files by size,
+  // so that Skyrim.esm gets most of them for its top-level groups
+  const size_t numThreads = Viet::GetDefaultNumThreads();
+  std::vector<size_t> browserThreads(filePaths.size(), 1);
+  uintmax_t totalSize = 0;
+  for (size_t i = 0; i < filePaths.size(); ++i) {
+    std::error_code ec;
+    auto size = fs::file_size(filePaths[i], ec);
+    browserThreads[i] = ec ? 0 : size;
+    totalSize += browserThreads[i];
+  }
+  for (auto& n : browserThreads) {
+    n = totalSize ? std::max<size_t>(1, numThreads * n / totalSize) : 1;
+  }
+
+  entries.resize(filePaths.size());
+  Viet::ParallelFor(entries.size(), numThreads, [&](size_t i) {
+    auto& p = filePaths[i];
+    auto& entry = entries[i];
 
     const auto was = std::chrono::steady_clock::now();
     entry.buffer = MakeBuffer(p);
@@ -30,22 +62,27 @@ Loader::Loader(const std::vector<fs::path>& filePaths_, OnProgress onProgress,
     entry.size = entry.buffer->GetLength();
 
     const auto was1 = std::chrono::steady_clock::now();
-    entry.browser.reset(
-      new Browser(entry.buffer->GetData(), entry.buffer->GetLength()));
+    entry.browser = MakeBrowser(*entry.buffer, entry.fileName.string(),
+                                browserThreads[i]);
     const auto end1 = std::chrono::steady_clock::now();
     const std::chrono::duration<float> elapsedTime1 = end1 - was1;
     entry.parseDuration = elapsedTime1.count();
-    if (onProgress) {
+  });
+
+  if (onProgress) {
+    for (auto& entry : entries) {
       onProgress(entry.fileName.string(), entry.readDuration,
                  entry.parseDuration, entry.size);
     }
   }
+
   combiner = std::make_unique<Combiner>();
   for (auto& entry : entries) {
     const auto fileName = entry.fileName.string();
     combiner->AddSource(entry.browser.get(), fileName.c_str());
   }
   combineBrowser = combiner->Combine();
+  decodedRecordCache = std::make_unique<DecodedRecordCache>();
 }
 
 const CombineBrowser& Loader::GetBrowser() const noexcept
@@ -53,6 +90,11 @@ const CombineBrowser& Loader::GetBrowser() const noexcept
   return *combineBrowser;
 }
 
+DecodedRecordCache& Loader::GetDecodedRecordCache() const noexcept
+{
+  return *decodedRecordCache;
+}
+
 std::vector<std::string> Loader::GetFileNames() const noexcept
 {
   std::vector<std::string> res;
@@ -63,6 +105,29 @@ std::vector<std::string> Loader::GetFileNames() const noexcept
   return res;
 }
 
+void Loader::PrewarmCompressedFields(
+  const std::vector<std::string>& types) const
+{
+  std::vector<const RecordHeader*> records;
+  for (auto& type : types) {
+    for (auto& lookupResult :
+         combineBrowser->GetDistinctRecordsByType(type.c_str())) {
+      if (lookupResult.rec->GetFlags() & RecordFlags::Compressed) {
+        records.push_back(lookupResult.rec);
+      }
+    }
+  }
+
+  auto& cache = combineBrowser->GetCache();
+  Viet::ParallelFor(
+    records.size(), Viet::GetDefaultNumThreads(), [&](size_t i) {
+      if (cache.IsWithinBudget()) {
+        RecordHeaderAccess::IterateFields(
+          records[i], [](const char*, uint32_t, const char*) {}, cache);
+      }
+    });
+}
+
 std::map<std::string, Loader::FileInfo> Loader::GetFilesInfo() const
 {
   std::map<std::string, FileInfo> res;
@@ -100,4 +165,56 @@ std::unique_ptr<Viet::IBuffer> Loader::MakeBuffer(
   }
 }
 
+std::unique_ptr<Browser> Loader::MakeBrowser(const Viet::IBuffer& buffer,
+                                             const std::string& fileName,
+                                             size_t numThreads) const
+{
+  if (indexCacheDir.empty()) {
+    return std::make_unique<Browser>(buffer.GetData(), buffer.GetLength(),
+                                     numThreads);
+  }
+
+  auto hash = utils::CalculateHashcode(buffer.GetData(), buffer.GetLength());
+  auto indexPath =
+    indexCacheDir / fmt::format("{}.{:08x}.espmidx", fileName, hash);
+
+  std::error_code ec;
+  if (fs::exists(indexPath, ec)) {
+    try {
+      Viet::MappedBuffer index(indexPath);
+      return std::make_unique<Browser>(buffer.GetData(), buffer.GetLength(),
+                                       index.GetData(), index.GetLength());
+    } catch (std::exception&) {
+      // Corrupted (checksum mismatch) or written by an incompatible version,
+      // rebuilding
+    }
+  }
+
+  auto browser = std::make_unique<Browser>(buffer.GetData(),
+                                           buffer.GetLength(), numThreads);
+
+  // Other servers sharing the cache dir may be writing the same index
+  auto tmpPath = indexPath;
+  tmpPath += fmt::format(".{}.{:08x}.tmp", static_cast<int>(getpid()),
+                         std::random_device()());
+
+  // Failing to save the index only makes the next start slower
+  try {
+    auto index = browser->SerializeIndex();
+    fs::create_directories(indexCacheDir);
+    {
+      std::ofstream f(tmpPath, std::ios::binary | std::ios::trunc);
+      f.write(reinterpret_cast<const char*>(index.data()), index.size());
+      if (!f) {
+        throw std::runtime_error("write failed");
+      }
+    }
+    fs::rename(tmpPath, indexPath);
+  } catch (std::exception&) {
+    fs::remove(tmpPath, ec);
+  }
+
+  return browser;
+}
+
 } // namespace espm
@@ -8,11 +8,6 @@ Type::Type(const char* type_) noexcept
 {
 }
 
-bool Type::operator==(const char* rhs) const noexcept
-{
-  return !std::memcmp(type, rhs, 4);
-}
-
 std::string Type::ToString() const noexcept
 {
   return std::string{ type, 4 };
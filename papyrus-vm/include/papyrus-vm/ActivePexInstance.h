@@ -4,9 +4,11 @@
 #include <memory>
 #include <optional>
 #include <string>
+#include <unordered_map>
 #include <utility>
 #include <vector>
 
+#include "CompiledFunctionCode.h"
 #include "FunctionCode.h"
 #include "FunctionInfo.h"
 #include "IVariablesHolder.h"
@@ -46,9 +48,13 @@ public:
   static uint8_t GetTypeByName(std::string typeRef);
   std::string GetActiveStateName() const;
 
+  // Points into the ::State variable, valid until the state changes
+  const char* GetActiveStateNameRaw() const;
+
   bool IsValid() const { return _IsValid; };
 
   const std::string& GetSourcePexName() const;
+  std::shared_ptr<PexScript> GetSourcePex() const { return sourcePex.fn(); }
 
   const std::shared_ptr<ActivePexInstance> GetParentInstance() const
   {
@@ -64,9 +70,9 @@ public:
 private:
   struct ExecutionContext;
 
-  std::vector<std::pair<uint8_t, std::vector<VarValue*>>>
-  TransformInstructions(std::vector<FunctionCode::Instruction>& sourceOpCode,
-                        std::shared_ptr<std::vector<Local>> locals);
+  std::vector<VarValue*> ResolveOperands(ExecutionContext& ctx);
+
+  VarValue& GetInternedIdentifierValue(uint32_t stringTableIndex);
 
   std::shared_ptr<std::vector<ActivePexInstance::Local>> MakeLocals(
     const FunctionInfo& function, const std::vector<VarValue>& arguments);
@@ -113,7 +119,12 @@ private:
   std::shared_ptr<ActivePexInstance> parentInstance;
 
   std::shared_ptr<IVariablesHolder> variables;
-  std::vector<std::shared_ptr<VarValue>> identifiersValueNameCache;
+  std::unordered_map<std::string, VarValue> identifiersValueNameCache;
+
+  // Resolved values of interned identifiers by string table index. Points to
+  // activeInstanceOwner, variables or identifiersValueNameCache, which never
+  // move
+  std::vector<VarValue*> internedIdentifierValues;
 
   uint64_t promiseIdx = 0;
   std::map<uint64_t, std::shared_ptr<Viet::Promise<VarValue>>> promises;
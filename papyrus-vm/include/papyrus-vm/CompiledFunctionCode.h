@@ -0,0 +1,64 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "VarValue.h"
+
+struct FunctionInfo;
+class StringTable;
+
+// FunctionCode with operands resolved ahead of time. Built once per function
+// when a script is loaded, so that a call doesn't have to copy instructions
+// or look up its locals by name.
+struct CompiledFunctionCode
+{
+  struct Operand
+  {
+    enum Kind : uint8_t
+    {
+      // Read-only value stored in `constants`
+      kKind_Constant,
+
+      // Value at `index` in the locals frame of a call
+      kKind_Local,
+
+      // Name stored in `constants`, resolved against the script instance
+      // (variables, 'self', string table) once per ExecuteAll
+      kKind_Identifier,
+
+      // Same as kKind_Identifier, but the name is interned: `index` is its
+      // index in the string table of the script. Script instances cache the
+      // resolved value per index
+      kKind_InternedIdentifier,
+
+      // Value stored in `writableConstants`: a constant in a position that an
+      // opcode writes to. Copied into the execution context of every call
+      kKind_WritableConstant,
+    };
+
+    Kind kind = kKind_Constant;
+    uint32_t index = 0;
+  };
+
+  struct Instruction
+  {
+    uint8_t op = 0;
+    uint32_t firstOperand = 0;
+    uint32_t numOperands = 0;
+  };
+
+  std::vector<Instruction> instructions;
+  std::vector<Operand> operands;
+  std::vector<VarValue> constants;
+  std::vector<VarValue> writableConstants;
+
+  uint32_t maxOperands = 0;
+
+  // Locals frame layout must match ActivePexInstance::MakeLocals: function
+  // locals first, then params. Identifiers found in stringTable (if any) are
+  // interned
+  static std::shared_ptr<const CompiledFunctionCode> Compile(
+    const FunctionInfo& function, const StringTable* stringTable = nullptr);
+};
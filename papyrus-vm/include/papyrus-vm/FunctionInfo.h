@@ -1,10 +1,15 @@
 #pragma once
 
 #include <cstdint>
+#include <memory>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "FunctionCode.h"
+#include "VarValue.h"
+
+struct CompiledFunctionCode;
 
 struct FunctionInfo
 {
@@ -18,8 +23,20 @@ struct FunctionInfo
 
   struct ParamInfo
   {
+    ParamInfo() = default;
+
+    ParamInfo(std::string name_, std::string type_)
+      : name(std::move(name_))
+      , type(std::move(type_))
+      , objectTypeId(VarValue::InternObjectType(type))
+    {
+    }
+
     std::string name;
     std::string type;
+
+    // Interned type, copied into locals on every call
+    uint16_t objectTypeId = 0;
   };
 
   std::string returnType;
@@ -32,6 +49,9 @@ struct FunctionInfo
 
   FunctionCode code;
 
+  // Built by Reader. Functions constructed elsewhere are compiled on call
+  std::shared_ptr<const CompiledFunctionCode> compiledCode;
+
   bool IsGlobal() const { return flags & (1 << 0); }
 
   bool IsNative() const { return flags & (1 << 1); }
@@ -8,7 +8,9 @@ class IVariablesHolder
 public:
   virtual ~IVariablesHolder() = default;
 
-  // Must guarantee that no exception would be thrown for '::State' variable
+  // Must guarantee that no exception would be thrown for '::State' variable.
+  // Returned pointers must stay valid for the lifetime of the holder:
+  // ActivePexInstance caches them
   virtual VarValue* GetVariableByName(const char* name,
                                       const PexScript& pex) = 0;
 };
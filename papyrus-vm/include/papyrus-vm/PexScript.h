@@ -2,6 +2,7 @@
 #include <functional>
 #include <memory>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 #include "DebugInfo.h"
@@ -29,6 +30,10 @@ struct PexScript
   std::vector<UserFlag> userFlagTable;
   std::vector<Object> objectTable;
 
+  // Filled by Reader. First match in objectTable wins
+  std::unordered_map<std::string, Object::PropInfo*> readablePropertyByName;
+  std::unordered_map<std::string, Object::PropInfo*> writablePropertyByName;
+
   std::string source;
   std::string user;
   std::string machine;
@@ -18,7 +18,11 @@ class Reader
 
   int currentReadPositionInFile = 0;
 
+  // Owned only when reading from a file, otherwise the caller's buffer is
+  // parsed in place
   std::vector<uint8_t> arrayBytes;
+  const uint8_t* bytes = nullptr;
+  size_t numBytes = 0;
 
   void FillSource(std::string& str);
   void FillUser(std::string& str);
@@ -29,6 +33,7 @@ class Reader
   void FillDebugInfo(DebugInfo& debugInfo);
   void FillUserFlagTable(std::vector<UserFlag>& userFlagTable);
   void FillObjectTable(std::vector<Object>& objectTable);
+  void FillPropertyIndex(PexScript& pex);
 
   DebugInfo::DebugFunction FillDebugFunction();
   UserFlag FillUserFlag();
@@ -49,10 +54,12 @@ class Reader
   std::string ReadString(int size);
 
   void Read();
-  void CreateScriptStructure(const std::vector<uint8_t>& arrayBytes);
+  void RequireBytes(size_t n);
+  void CreateScriptStructure(const uint8_t* data, size_t size);
 
 public:
   std::vector<std::shared_ptr<PexScript>> GetSourceStructures();
   Reader(const std::vector<std::string>& vectorPath);
   Reader(const std::vector<std::vector<uint8_t>>& pex);
+  Reader(const uint8_t* pex, size_t size);
 };
@@ -1,22 +1,64 @@
 #pragma once
+#include <cstdint>
 #include <memory>
+#include <optional>
 #include <string>
+#include <string_view>
+#include <unordered_map>
 #include <vector>
 
 class StringTable
 {
 public:
+  StringTable() = default;
+
+  // indexByString points into storage, so a copy has to build its own index
+  StringTable(const StringTable& other)
+    : instanceStringTable(other.instanceStringTable)
+  {
+    SetStorage(other.storage);
+  }
+
+  StringTable& operator=(const StringTable& other)
+  {
+    if (this != &other) {
+      instanceStringTable = other.instanceStringTable;
+      SetStorage(other.storage);
+    }
+    return *this;
+  }
+
+  // Moving the vector doesn't move its strings, the index stays valid
+  StringTable(StringTable&&) noexcept = default;
+  StringTable& operator=(StringTable&&) noexcept = default;
+
   // Do NOT mutate storage after pex loading. reallocation would make string
   // VarValues invalid
   void SetStorage(std::vector<std::string> newStorage)
   {
     storage = std::move(newStorage);
+
+    indexByString.clear();
+    for (size_t i = 0; i < storage.size(); ++i) {
+      indexByString.emplace(storage[i], static_cast<uint32_t>(i));
+    }
   }
 
   std::vector<std::shared_ptr<std::string>> instanceStringTable;
 
   const std::vector<std::string>& GetStorage() const { return storage; }
 
+  // Index of the first occurrence of the string in storage
+  std::optional<uint32_t> FindIndex(std::string_view str) const
+  {
+    auto it = indexByString.find(str);
+    if (it == indexByString.end()) {
+      return std::nullopt;
+    }
+    return it->second;
+  }
+
 private:
   std::vector<std::string> storage;
+  std::unordered_map<std::string_view, uint32_t> indexByString;
 };
@@ -1,33 +1,105 @@
 #pragma once
 #include "Promise.h"
+#include <cstddef>
 #include <cstdint>
 #include <functional>
 #include <iosfwd>
 #include <memory>
 #include <string>
+#include <string_view>
 #include <vector>
 
 class StackIdHolder;
 class IGameObject;
 
+// Kept small (24 bytes) since the VM copies values on every opcode. Things
+// that plain numbers, bools and object pointers don't need (owning object,
+// array, promise, owned string) live in a reference counted Extra block,
+// shared between copies and allocated only when used
 struct VarValue
 {
+private:
+  struct Extra;
+
+public:
+  // pArray, promise and objectType used to be shared_ptr and std::string
+  // members. These stand-ins keep natives written against them compiling
+  class ArrayMember
+  {
+  public:
+    // Shares the array of rhs like copying the shared_ptr did
+    ArrayMember& operator=(const ArrayMember& rhs);
+    ArrayMember& operator=(std::shared_ptr<std::vector<VarValue>> array);
+    void reset(std::vector<VarValue>* array = nullptr);
+
+    std::vector<VarValue>* get() const noexcept;
+    std::vector<VarValue>* operator->() const noexcept { return get(); }
+    std::vector<VarValue>& operator*() const noexcept { return *get(); }
+    explicit operator bool() const noexcept { return get() != nullptr; }
+    bool operator==(std::nullptr_t) const noexcept { return !get(); }
+    operator const std::shared_ptr<std::vector<VarValue>>&() const noexcept;
+
+  private:
+    friend struct VarValue;
+    Extra* extra;
+  };
+
+  class PromiseMember
+  {
+  public:
+    PromiseMember& operator=(const PromiseMember& rhs);
+    PromiseMember& operator=(
+      std::shared_ptr<Viet::Promise<VarValue>> promise);
+
+    Viet::Promise<VarValue>* get() const noexcept;
+    Viet::Promise<VarValue>* operator->() const noexcept { return get(); }
+    Viet::Promise<VarValue>& operator*() const noexcept { return *get(); }
+    explicit operator bool() const noexcept { return get() != nullptr; }
+    bool operator==(std::nullptr_t) const noexcept { return !get(); }
+    operator const std::shared_ptr<Viet::Promise<VarValue>>&() const noexcept;
+
+  private:
+    friend struct VarValue;
+    Extra* extra;
+  };
+
+  class ObjectTypeMember
+  {
+  public:
+    ObjectTypeMember& operator=(const std::string& objectType);
+
+    operator const std::string&() const;
+    const std::string& str() const { return *this; }
+    const char* c_str() const { return str().c_str(); }
+    bool empty() const noexcept { return id == 0; }
+    bool operator==(std::string_view rhs) const { return str() == rhs; }
+
+  private:
+    friend struct VarValue;
+    uint16_t id = 0; // Interned name, 0 is an empty string
+  };
+
+  // Both are the pointer to Extra, see extra(). A union member of standard
+  // layout type may be read through another one starting the same way
+  union
+  {
+    ArrayMember pArray = {};
+    PromiseMember promise;
+  };
+
 private:
   union
   {
     IGameObject* id;
-    const char* string;
+    const char* string; // Not owned, see kFlag_OwnedString
     int32_t i;
     double f;
     bool b;
   } data;
 
-  std::shared_ptr<IGameObject> owningObject;
   int32_t stackId = -1;
 
 public:
-  std::string objectType;
-
   enum Type : uint8_t
   {
     kType_Object = 0, // 0 null?
@@ -54,6 +126,10 @@ public:
     type = Type::kType_Object;
   }
 
+  VarValue(const VarValue& arg2);
+  VarValue(VarValue&& arg2) noexcept;
+  ~VarValue();
+
   explicit VarValue(uint8_t type);
   explicit VarValue(IGameObject* object);
   explicit VarValue(int32_t value);
@@ -76,13 +152,25 @@ public:
 
   explicit operator double() const { return CastToFloat().data.f; }
 
-  explicit operator const char*() const { return data.string; }
+  // Owned strings stay at the same address while any copy of the value
+  // exists, moves included
+  explicit operator const char*() const;
+
+  // Arrays are shared between copies like in Papyrus, so the returned
+  // vector may be modified. Setting another array affects only this value
+  const std::shared_ptr<std::vector<VarValue>>& GetArray() const;
+  void SetArray(std::shared_ptr<std::vector<VarValue>> array);
 
-  std::shared_ptr<std::vector<VarValue>> pArray;
+  const std::shared_ptr<Viet::Promise<VarValue>>& GetPromise() const;
 
-  std::shared_ptr<Viet::Promise<VarValue>> promise;
+  // Declared type of a variable holding the value, see operator=
+  const std::string& GetObjectType() const;
+  void SetObjectType(const std::string& objectType);
 
-  std::shared_ptr<std::string> stringHolder;
+  // SetObjectType hashes the name under a global lock. Hot paths intern the
+  // name once and then assign the id
+  static uint16_t InternObjectType(const std::string& objectType);
+  void SetObjectTypeId(uint16_t id) noexcept { objectType.id = id; }
 
   int32_t GetMetaStackId() const;
   void SetMetaStackIdHolder(const StackIdHolder& stackIdHolder);
@@ -120,5 +208,21 @@ public:
                                            uint8_t type);
 
 private:
+  enum Flags : uint8_t
+  {
+    kFlag_OwnedString = 1, // String is stored in Extra, not in data.string
+  };
+
+  Extra*& extra() noexcept { return pArray.extra; }
+  Extra* extra() const noexcept { return pArray.extra; }
+
+  // Copies Extra if it's shared
+  static Extra& MutableExtra(Extra*& extra);
+
   Type type;
+  uint8_t flags = 0;
+
+public:
+  // Declared type of a variable holding the value, see operator=
+  ObjectTypeMember objectType;
 };
@@ -5,6 +5,7 @@
 #include <functional>
 #include <map>
 #include <set>
+#include <unordered_map>
 
 using NativeFunction =
   std::function<VarValue(VarValue self, std::vector<VarValue> arguments)>;
@@ -56,6 +57,7 @@ struct VmExceptionInfo
 class VirtualMachine
 {
   friend class StackIdHolder;
+  friend class ActivePexInstance;
 
 public:
   using OnEnter = std::function<void(const StackData&)>;
@@ -118,7 +120,20 @@ public:
                                            bool isStatic) const;
   bool DynamicCast(const VarValue& object, const CIString& className) const;
 
+  // Opcodes executed by all scripts so far. Lets benchmarks report costs per
+  // opcode
+  uint64_t GetNumExecutedOpcodes() const noexcept
+  {
+    return numExecutedOpcodes;
+  }
+
 private:
+  uint32_t GetEventId(const char* eventName);
+  // The caller must hold 'pex' while using the returned FunctionInfo
+  const FunctionInfo* FindEventHandler(ActivePexInstance& instance,
+                                       const std::shared_ptr<PexScript>& pex,
+                                       uint32_t eventId);
+
   CIMap<PexScript::Lazy> allLoadedScripts;
 
   CIMap<CIMap<NativeFunction>> nativeFunctions, nativeStaticFunctions;
@@ -131,4 +146,28 @@ private:
   MissingScriptHandler missingScriptHandler;
 
   std::shared_ptr<MakeID> stackIdMaker;
+
+  uint64_t numExecutedOpcodes = 0;
+
+  // Event names are interned so that each script in each state resolves its
+  // handler for an event once. Most scripts have no handler for frequent
+  // events like OnTrigger
+  CIMap<uint32_t> eventIds;
+  std::vector<std::string> eventNames;
+
+  // Entries don't own the script. A script replaced by hot reload expires
+  // its entry, which is then reset on address reuse or pruned
+  struct ScriptEventHandlers
+  {
+    std::weak_ptr<PexScript> pex;
+
+    // States of the script, looked up without allocating or hashing
+    std::vector<const std::string*> stateNames;
+
+    // Indexed by state, then by event id. The extra last state is for state
+    // names the script doesn't declare. nullptr if there is no handler
+    std::vector<std::vector<const FunctionInfo*>> handlersByState;
+  };
+  std::unordered_map<const PexScript*, ScriptEventHandlers> eventHandlers;
+  size_t eventHandlersPruneThreshold = 64;
 };
@@ -1,3 +1,4 @@
+#include "papyrus-vm/CompiledFunctionCode.h"
 #include "papyrus-vm/FunctionInfo.h"
 #include "papyrus-vm/OpcodesImplementation.h"
 #include "papyrus-vm/Utils.h"
@@ -77,6 +78,11 @@ FunctionInfo ActivePexInstance::GetFunctionByName(const char* name,
 }
 
 std::string ActivePexInstance::GetActiveStateName() const
+{
+  return GetActiveStateNameRaw();
+}
+
+const char* ActivePexInstance::GetActiveStateNameRaw() const
 {
   VarValue* var = nullptr;
 
@@ -101,7 +107,8 @@ std::string ActivePexInstance::GetActiveStateName() const
     return "";
   }
 
-  return static_cast<const char*>(*var);
+  const char* stateName = static_cast<const char*>(*var);
+  return stateName ? stateName : "";
 }
 
 Object::PropInfo* ActivePexInstance::GetProperty(
@@ -111,26 +118,20 @@ Object::PropInfo* ActivePexInstance::GetProperty(
   if (!scriptInstance.IsValid())
     return nullptr;
 
+  auto pex = scriptInstance.sourcePex.fn();
+
   if (flag == Object::PropInfo::kFlags_Read) {
 
-    for (auto& object : scriptInstance.sourcePex.fn()->objectTable) {
-      for (auto& prop : object.properties) {
-        if (prop.name == propertyName &&
-            (prop.flags & 5) == prop.kFlags_Read) {
-          return &prop;
-        }
-      }
+    auto it = pex->readablePropertyByName.find(propertyName);
+    if (it != pex->readablePropertyByName.end()) {
+      return it->second;
     }
 
     if (flag == Object::PropInfo::kFlags_Write) {
 
-      for (auto& object : scriptInstance.sourcePex.fn()->objectTable) {
-        for (auto& prop : object.properties) {
-          if (prop.name == propertyName &&
-              (prop.flags & 6) == prop.kFlags_Write) {
-            return &prop;
-          }
-        }
+      auto it = pex->writablePropertyByName.find(propertyName);
+      if (it != pex->writablePropertyByName.end()) {
+        return it->second;
       }
     }
   }
@@ -151,8 +152,9 @@ const std::string& ActivePexInstance::GetSourcePexName() const
 struct ActivePexInstance::ExecutionContext
 {
   std::shared_ptr<StackData> stackData;
-  std::vector<FunctionCode::Instruction> instructions;
+  std::shared_ptr<const CompiledFunctionCode> code;
   std::shared_ptr<std::vector<Local>> locals;
+  std::vector<VarValue> writableConstants;
   bool needReturn = false;
   bool needJump = false;
   int jumpStep = 0;
@@ -180,20 +182,20 @@ std::vector<VarValue> GetArgsForCall(uint8_t op,
 bool ActivePexInstance::EnsureCallResultIsSynchronous(
   const VarValue& callResult, ExecutionContext* ctx)
 {
-  if (!callResult.promise) {
+  if (!callResult.GetPromise()) {
     return true;
   }
 
   Viet::Promise<VarValue> currentFnPr;
 
   auto ctxCopy = *ctx;
-  callResult.promise->Then([this, ctxCopy, currentFnPr](VarValue v) {
+  callResult.GetPromise()->Then([this, ctxCopy, currentFnPr](VarValue v) {
     auto ctxCopy_ = ctxCopy;
     ctxCopy_.line++;
     auto res = ExecuteAll(ctxCopy_, v);
 
-    if (res.promise)
-      res.promise->Then(currentFnPr);
+    if (res.GetPromise())
+      res.GetPromise()->Then(currentFnPr);
     else
       currentFnPr.Resolve(res);
   });
@@ -592,11 +594,11 @@ void ActivePexInstance::ExecuteOpCode(
       }
       break;
     case OpcodesImplementation::Opcodes::op_Array_Create:
-      (*args[0]).pArray = std::make_shared<std::vector<VarValue>>();
+      (*args[0]).SetArray(std::make_shared<std::vector<VarValue>>());
       if ((int32_t)(*args[1]) > 0) {
-        (*args[0]).pArray->resize((int32_t)(*args[1]));
+        (*args[0]).GetArray()->resize((int32_t)(*args[1]));
         uint8_t type = GetArrayElementType((*args[0]).GetType());
-        for (auto& element : *(*args[0]).pArray) {
+        for (auto& element : *(*args[0]).GetArray()) {
           element = VarValue(type);
         }
       } else {
@@ -605,24 +607,24 @@ void ActivePexInstance::ExecuteOpCode(
       }
       break;
     case OpcodesImplementation::Opcodes::op_Array_Length:
-      if ((*args[1]).pArray != nullptr) {
+      if ((*args[1]).GetArray() != nullptr) {
         if ((*args[0]).GetType() == VarValue::kType_Integer) {
-          *args[0] = VarValue((int32_t)(*args[1]).pArray->size());
+          *args[0] = VarValue((int32_t)(*args[1]).GetArray()->size());
         } else if ((*args[0]).GetType() == VarValue::kType_Float) {
-          *args[0] = VarValue((double)(*args[1]).pArray->size());
+          *args[0] = VarValue((double)(*args[1]).GetArray()->size());
         }
       } else {
         *args[0] = VarValue((int32_t)0);
       }
       break;
     case OpcodesImplementation::Opcodes::op_Array_GetElement:
-      if ((*args[1]).pArray != nullptr) {
+      if ((*args[1]).GetArray() != nullptr) {
         const int index = static_cast<int>(*args[2]);
         const auto indexType = (*args[2]).GetType();
         if ((indexType == VarValue::kType_Integer ||
              indexType == VarValue::kType_Float) &&
-            index >= 0 && index < (*args[1]).pArray->size()) {
-          *args[0] = (*args[1]).pArray->operator[](index);
+            index >= 0 && index < (*args[1]).GetArray()->size()) {
+          *args[0] = (*args[1]).GetArray()->operator[](index);
         } else {
           *args[0] = VarValue::None();
           spdlog::error("OpcodesImplementation::Opcodes::op_Array_GetElement "
@@ -633,13 +635,13 @@ void ActivePexInstance::ExecuteOpCode(
       }
       break;
     case OpcodesImplementation::Opcodes::op_Array_SetElement:
-      if ((*args[0]).pArray != nullptr) {
+      if ((*args[0]).GetArray() != nullptr) {
         const int index = static_cast<int>(*args[1]);
         const auto indexType = (*args[1]).GetType();
         if ((indexType == VarValue::kType_Integer ||
              indexType == VarValue::kType_Float) &&
-            index >= 0 && index < (*args[0]).pArray->size()) {
-          (*args[0]).pArray->operator[](index) = *args[2];
+            index >= 0 && index < (*args[0]).GetArray()->size()) {
+          (*args[0]).GetArray()->operator[](index) = *args[2];
         } else {
           spdlog::error("OpcodesImplementation::Opcodes::op_Array_SetElement "
                         "- Invalid array index");
@@ -671,14 +673,14 @@ ActivePexInstance::MakeLocals(const FunctionInfo& function,
   // Fill with function locals
   for (auto& var : function.locals) {
     VarValue temp = VarValue(GetTypeByName(var.type));
-    temp.objectType = var.type;
+    temp.SetObjectTypeId(var.objectTypeId);
     locals->push_back({ var.name, temp });
   }
 
   // Fill with function args
   for (size_t i = 0; i < arguments.size(); ++i) {
     VarValue temp = arguments[i];
-    temp.objectType = function.params[i].type;
+    temp.SetObjectTypeId(function.params[i].objectTypeId);
 
     locals->push_back({ function.params[i].name, temp });
     assert(locals->back().second.GetType() == arguments[i].GetType());
@@ -689,7 +691,7 @@ ActivePexInstance::MakeLocals(const FunctionInfo& function,
     const auto& var_ = function.params[i];
 
     VarValue temp = VarValue(GetTypeByName(var_.type));
-    temp.objectType = var_.type;
+    temp.SetObjectTypeId(var_.objectTypeId);
 
     locals->push_back({ var_.name, temp });
   }
@@ -702,81 +704,83 @@ ActivePexInstance::MakeLocals(const FunctionInfo& function,
   return locals;
 }
 
-// Basically, makes vector<VarValue *> from vector<VarValue>
-std::vector<std::pair<uint8_t, std::vector<VarValue*>>>
-ActivePexInstance::TransformInstructions(
-  std::vector<FunctionCode::Instruction>& instructions,
-  std::shared_ptr<std::vector<Local>> locals)
+std::vector<VarValue*> ActivePexInstance::ResolveOperands(
+  ExecutionContext& ctx)
 {
-  std::vector<std::pair<uint8_t, std::vector<VarValue*>>> opCode;
-  for (size_t i = 0; i < instructions.size(); ++i) {
-
-    std::pair<uint8_t, std::vector<VarValue*>> temp;
-    temp.first = instructions[i].op;
-
-    for (size_t j = 0; j < instructions[i].args.size(); ++j) {
-      temp.second.push_back(&instructions[i].args[j]);
-    }
-    opCode.push_back(temp);
-  }
-
-  // Dereference identifiers
-  for (auto& [opcodeId, opcodeArgs] : opCode) {
-    size_t dereferenceStart;
-    switch (opcodeId) {
-      case OpcodesImplementation::Opcodes::op_CallMethod:
-        // Do not dereference functionName
-        dereferenceStart = 1;
+  const auto& code = *ctx.code;
+  auto& locals = *ctx.locals;
+
+  std::vector<VarValue*> res(code.operands.size());
+  for (size_t i = 0; i < code.operands.size(); ++i) {
+    const auto& operand = code.operands[i];
+    switch (operand.kind) {
+      case CompiledFunctionCode::Operand::kKind_Local:
+        res[i] = &locals[operand.index].second;
         break;
-      case OpcodesImplementation::Opcodes::op_CallStatic:
-        // Do not dereference className and functionName
-        dereferenceStart = 2;
+      case CompiledFunctionCode::Operand::kKind_Identifier:
+        res[i] = &GetVariableValueByName(
+          nullptr, static_cast<const char*>(code.constants[operand.index]));
         break;
-      case OpcodesImplementation::Opcodes::op_CallParent:
-        // Do not dereference functionName
-        dereferenceStart = 1;
+      case CompiledFunctionCode::Operand::kKind_InternedIdentifier:
+        res[i] = &GetInternedIdentifierValue(operand.index);
         break;
-      case OpcodesImplementation::Opcodes::op_PropGet:
-      case OpcodesImplementation::Opcodes::op_PropSet:
-        // Do not dereference property name
-        dereferenceStart = 1;
+      case CompiledFunctionCode::Operand::kKind_WritableConstant:
+        res[i] = &ctx.writableConstants[operand.index];
         break;
       default:
-        dereferenceStart = 0;
+        // Opcodes never write to these, see CompiledFunctionCode::Compile
+        res[i] = const_cast<VarValue*>(&code.constants[operand.index]);
         break;
     }
-    for (size_t i = dereferenceStart; i < opcodeArgs.size(); ++i) {
-      auto& arg = opcodeArgs[i];
-      arg = &(GetIndentifierValue(*locals, *arg));
-    }
+  }
+  return res;
+}
+
+VarValue& ActivePexInstance::GetInternedIdentifierValue(
+  uint32_t stringTableIndex)
+{
+  if (stringTableIndex >= internedIdentifierValues.size()) {
+    internedIdentifierValues.resize(stringTableIndex + 1, nullptr);
   }
 
-  return opCode;
+  auto& cached = internedIdentifierValues[stringTableIndex];
+  if (cached) {
+    return *cached;
+  }
+
+  const auto& name =
+    sourcePex.fn()->stringTable.GetStorage()[stringTableIndex];
+  auto& res = GetVariableValueByName(nullptr, name);
+
+  // noneVar is reset on every failed lookup, so failures are not cached
+  if (&res != &noneVar) {
+    cached = &res;
+  }
+  return res;
 }
 
 VarValue ActivePexInstance::ExecuteAll(
   ExecutionContext& ctx, std::optional<VarValue> previousCallResult) noexcept
 {
-  auto pipex = sourcePex.fn();
-
-  auto opCode = TransformInstructions(ctx.instructions, ctx.locals);
+  const auto& code = *ctx.code;
+  auto operands = ResolveOperands(ctx);
 
   if (previousCallResult) {
-    int i = ctx.line - 1;
+    const auto& instruction = code.instructions[ctx.line - 1];
     size_t resultIdx =
-      opCode[i].first == OpcodesImplementation::Opcodes::op_CallParent ? 1 : 2;
+      instruction.op == OpcodesImplementation::Opcodes::op_CallParent ? 1 : 2;
 
-    *opCode[i].second[resultIdx] = *previousCallResult;
+    *operands[instruction.firstOperand + resultIdx] = *previousCallResult;
   }
 
-  // TODO: log and handle this
-  assert(opCode.size() == ctx.instructions.size());
-
   constexpr static size_t kOpCodeExecutionsQuota = 100'000;
 
   size_t opCodeExecutions = 0;
 
-  for (; ctx.line < opCode.size(); ++ctx.line) {
+  std::vector<VarValue*> args;
+  args.reserve(code.maxOperands);
+
+  for (; ctx.line < code.instructions.size(); ++ctx.line) {
 
     if (opCodeExecutions >= kOpCodeExecutionsQuota) {
       spdlog::error("ActivePexInstance::ExecuteAll - Quota exceeded in script "
@@ -785,10 +789,13 @@ VarValue ActivePexInstance::ExecuteAll(
       return VarValue::None();
     }
 
-    auto& [op, args] = opCode[ctx.line];
-    ExecuteOpCode(&ctx, op, args);
+    const auto& instruction = code.instructions[ctx.line];
+    auto first = operands.begin() + instruction.firstOperand;
+    args.assign(first, first + instruction.numOperands);
+    ExecuteOpCode(&ctx, instruction.op, args);
 
     ++opCodeExecutions;
+    ++parentVM->numExecutedOpcodes;
 
     if (ctx.needReturn) {
       ctx.needReturn = false;
@@ -832,8 +839,12 @@ VarValue ActivePexInstance::StartFunction(const FunctionInfo& function,
     return VarValue::None();
   }
 
+  auto code = function.compiledCode
+    ? function.compiledCode
+    : CompiledFunctionCode::Compile(function, &sourcePex.fn()->stringTable);
+
   auto locals = MakeLocals(function, arguments);
-  ExecutionContext ctx{ stackData, function.code.instructions, locals };
+  ExecutionContext ctx{ stackData, code, locals, code->writableConstants };
   return ExecuteAll(ctx);
 }
 
@@ -987,7 +998,7 @@ void ActivePexInstance::CastObjectToObject(const VirtualMachine& vm,
                          scriptToCastOwner->ToString(), result->ToString());
   }
 
-  const std::string& resultTypeName = result->objectType;
+  const std::string& resultTypeName = result->GetObjectType();
 
   VarValue tmp;
   std::vector<std::string> outClassesStack;
@@ -1160,36 +1171,16 @@ VarValue& ActivePexInstance::GetVariableValueByName(std::vector<Local>* locals,
     return ResetNoneVarAndReturn();
   }
 
-  for (auto& _name : identifiersValueNameCache) {
-    if ((const char*)(*_name) == name) {
-      return *_name;
-    }
-  }
-
-  if (parentVM->IsNativeFunctionByNameExisted(GetSourcePexName())) {
-    auto functionName = std::make_shared<VarValue>(name);
-
-    identifiersValueNameCache.push_back(functionName);
-    return *identifiersValueNameCache.back();
+  auto it = identifiersValueNameCache.find(name);
+  if (it != identifiersValueNameCache.end()) {
+    return it->second;
   }
 
-  for (auto& _string : sourcePex.fn()->stringTable.GetStorage()) {
-    if (_string == name) {
-      auto stringTableValue = std::make_shared<VarValue>(name);
-
-      identifiersValueNameCache.push_back(stringTableValue);
-      return *identifiersValueNameCache.back();
-    }
-  }
-
-  for (auto& _string :
-       parentInstance->sourcePex.fn()->stringTable.GetStorage()) {
-    if (_string == name) {
-      auto stringTableParentValue = std::make_shared<VarValue>(name);
-
-      identifiersValueNameCache.push_back(stringTableParentValue);
-      return *identifiersValueNameCache.back();
-    }
+  if (parentVM->IsNativeFunctionByNameExisted(GetSourcePexName()) ||
+      sourcePex.fn()->stringTable.FindIndex(name) ||
+      parentInstance->sourcePex.fn()->stringTable.FindIndex(name)) {
+    return identifiersValueNameCache.emplace(name, VarValue(name))
+      .first->second;
   }
 
   spdlog::error("ActivePexInstance::GetVariableValueByName - Failed all "
@@ -0,0 +1,127 @@
+#include "papyrus-vm/CompiledFunctionCode.h"
+#include "papyrus-vm/FunctionInfo.h"
+#include "papyrus-vm/OpcodesImplementation.h"
+#include "papyrus-vm/StringTable.h"
+
+#include <algorithm>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+namespace {
+// Operands before this index are names of functions/classes/properties and
+// are never dereferenced
+size_t GetDereferenceStart(uint8_t op)
+{
+  switch (op) {
+    case OpcodesImplementation::Opcodes::op_CallMethod:
+    case OpcodesImplementation::Opcodes::op_CallParent:
+    case OpcodesImplementation::Opcodes::op_PropGet:
+    case OpcodesImplementation::Opcodes::op_PropSet:
+      return 1;
+    case OpcodesImplementation::Opcodes::op_CallStatic:
+      return 2;
+    default:
+      return 0;
+  }
+}
+
+// Index of the operand ActivePexInstance::ExecuteOpCode writes to, or -1
+int GetWrittenOperand(uint8_t op)
+{
+  switch (op) {
+    case OpcodesImplementation::Opcodes::op_Nop:
+    case OpcodesImplementation::Opcodes::op_Jmp:
+    case OpcodesImplementation::Opcodes::op_Jmpt:
+    case OpcodesImplementation::Opcodes::op_Jmpf:
+    case OpcodesImplementation::Opcodes::op_Return:
+    case OpcodesImplementation::Opcodes::op_PropSet:
+      return -1;
+    case OpcodesImplementation::Opcodes::op_CallMethod:
+    case OpcodesImplementation::Opcodes::op_CallStatic:
+    case OpcodesImplementation::Opcodes::op_PropGet:
+      return 2;
+    case OpcodesImplementation::Opcodes::op_CallParent:
+    case OpcodesImplementation::Opcodes::op_Array_FindElement:
+    case OpcodesImplementation::Opcodes::op_Array_RfindElement:
+      return 1;
+    default:
+      return 0;
+  }
+}
+}
+
+std::shared_ptr<const CompiledFunctionCode> CompiledFunctionCode::Compile(
+  const FunctionInfo& function, const StringTable* stringTable)
+{
+  auto res = std::make_shared<CompiledFunctionCode>();
+
+  // First match wins, same as the linear search in GetVariableValueByName
+  std::unordered_map<std::string, uint32_t> localIndexByName;
+  uint32_t frameSize = 0;
+  for (auto& var : function.locals) {
+    localIndexByName.emplace(var.name, frameSize++);
+  }
+  for (auto& var : function.params) {
+    localIndexByName.emplace(var.name, frameSize++);
+  }
+
+  res->instructions.reserve(function.code.instructions.size());
+
+  for (auto& sourceInstruction : function.code.instructions) {
+    Instruction instruction;
+    instruction.op = sourceInstruction.op;
+    instruction.firstOperand = static_cast<uint32_t>(res->operands.size());
+    instruction.numOperands =
+      static_cast<uint32_t>(sourceInstruction.args.size());
+
+    const size_t dereferenceStart = GetDereferenceStart(instruction.op);
+    const int writtenOperand = GetWrittenOperand(instruction.op);
+
+    for (size_t i = 0; i < sourceInstruction.args.size(); ++i) {
+      const VarValue& arg = sourceInstruction.args[i];
+
+      Operand operand;
+      if (i >= dereferenceStart &&
+          arg.GetType() == VarValue::kType_Identifier &&
+          static_cast<const char*>(arg)) {
+        const char* name = static_cast<const char*>(arg);
+
+        // 'self' is checked before locals in GetVariableValueByName
+        auto it = localIndexByName.find(name);
+        if (it != localIndexByName.end() && std::string_view(name) != "self") {
+          operand.kind = Operand::kKind_Local;
+          operand.index = it->second;
+          res->operands.push_back(operand);
+          continue;
+        }
+
+        if (auto slot = stringTable ? stringTable->FindIndex(name)
+                                    : std::nullopt) {
+          operand.kind = Operand::kKind_InternedIdentifier;
+          operand.index = *slot;
+          res->operands.push_back(operand);
+          continue;
+        }
+        operand.kind = Operand::kKind_Identifier;
+      } else if (static_cast<int>(i) == writtenOperand) {
+        operand.kind = Operand::kKind_WritableConstant;
+        operand.index = static_cast<uint32_t>(res->writableConstants.size());
+        res->writableConstants.push_back(arg);
+        res->operands.push_back(operand);
+        continue;
+      } else {
+        operand.kind = Operand::kKind_Constant;
+      }
+
+      operand.index = static_cast<uint32_t>(res->constants.size());
+      res->constants.push_back(arg);
+      res->operands.push_back(operand);
+    }
+
+    res->maxOperands = std::max(res->maxOperands, instruction.numOperands);
+    res->instructions.push_back(instruction);
+  }
+
+  return res;
+}
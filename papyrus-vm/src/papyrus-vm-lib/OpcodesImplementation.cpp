@@ -20,18 +20,18 @@ void OpcodesImplementation::ArrayFindElement(VarValue& array, VarValue& result,
                                              VarValue& needValue,
                                              VarValue& startIndex)
 {
-
-  if (array.pArray == nullptr || (int)startIndex < 0 ||
-      (int)startIndex >= array.pArray->size()) {
+  const auto& pArray = array.GetArray();
+  if (pArray == nullptr || (int)startIndex < 0 ||
+      (int)startIndex >= pArray->size()) {
     result = VarValue(-1);
     return;
   }
 
-  auto res = std::find(array.pArray->begin() + (int)startIndex,
-                       array.pArray->end(), needValue);
+  auto res = std::find(pArray->begin() + (int)startIndex, pArray->end(),
+                       needValue);
 
-  if (res != array.pArray->end()) {
-    result = VarValue(static_cast<int32_t>(res - array.pArray->begin()));
+  if (res != pArray->end()) {
+    result = VarValue(static_cast<int32_t>(res - pArray->begin()));
   } else {
     result = VarValue(-1);
   }
@@ -42,25 +42,25 @@ void OpcodesImplementation::ArrayRFindElement(VarValue& array,
                                               VarValue& needValue,
                                               VarValue& startIndex)
 {
-  if (array.pArray != nullptr) {
+  const auto& pArray = array.GetArray();
+  if (pArray != nullptr) {
 
-    int32_t indexForStart = array.pArray->size() - 1;
+    int32_t indexForStart = pArray->size() - 1;
 
     if ((int)startIndex < -1)
-      indexForStart = array.pArray->size() + (int)startIndex;
+      indexForStart = pArray->size() + (int)startIndex;
 
-    if (indexForStart >= array.pArray->size() || indexForStart < 0) {
+    if (indexForStart >= pArray->size() || indexForStart < 0) {
       result = VarValue(-1);
       return;
     }
 
-    auto res =
-      std::find(array.pArray->rbegin() + array.pArray->size() - indexForStart,
-                array.pArray->rend(), needValue);
-    if (res == array.pArray->rend()) {
+    auto res = std::find(pArray->rbegin() + pArray->size() - indexForStart,
+                         pArray->rend(), needValue);
+    if (res == pArray->rend()) {
       result = VarValue(-1);
     } else {
-      result = VarValue(static_cast<int32_t>(array.pArray->rend() - res - 1));
+      result = VarValue(static_cast<int32_t>(pArray->rend() - res - 1));
     }
   } else {
     result = VarValue(-1);
@@ -1,4 +1,5 @@
 #include "papyrus-vm/Reader.h"
+#include "papyrus-vm/CompiledFunctionCode.h"
 #include <fstream>
 
 void Reader::Read()
@@ -12,12 +13,10 @@ void Reader::Read()
     file.seekg(0, std::ios_base::end);
     const std::streampos fileSize = file.tellg();
     file.seekg(0, std::ios_base::beg);
-    arrayBytes.reserve(fileSize);
+    arrayBytes.resize(static_cast<size_t>(fileSize));
 
-    char temp;
-    while (file.get(temp)) {
-      arrayBytes.push_back(temp);
-    }
+    file.read(reinterpret_cast<char*>(arrayBytes.data()), arrayBytes.size());
+    arrayBytes.resize(static_cast<size_t>(file.gcount()));
 
   } else {
     throw std::runtime_error("Error open file: " + path);
@@ -37,19 +36,25 @@ Reader::Reader(const std::vector<std::string>& vectorPath)
     this->currentReadPositionInFile = 0;
     this->path = path;
     Read();
-    CreateScriptStructure(arrayBytes);
+    CreateScriptStructure(arrayBytes.data(), arrayBytes.size());
   }
 }
 
 Reader::Reader(const std::vector<std::vector<uint8_t>>& pexVector)
 {
   for (auto& pex : pexVector)
-    CreateScriptStructure(pex);
+    CreateScriptStructure(pex.data(), pex.size());
 }
 
-void Reader::CreateScriptStructure(const std::vector<uint8_t>& arrayBytes)
+Reader::Reader(const uint8_t* pex, size_t size)
 {
-  this->arrayBytes = arrayBytes;
+  CreateScriptStructure(pex, size);
+}
+
+void Reader::CreateScriptStructure(const uint8_t* data, size_t size)
+{
+  bytes = data;
+  numBytes = size;
   currentReadPositionInFile = 0;
 
   this->structure = std::make_shared<PexScript>();
@@ -64,9 +69,24 @@ void Reader::CreateScriptStructure(const std::vector<uint8_t>& arrayBytes)
   FillDebugInfo(structure->debugInfo);
   FillUserFlagTable(structure->userFlagTable);
   FillObjectTable(structure->objectTable);
+  FillPropertyIndex(*structure);
   sourceStructures.push_back(structure);
 }
 
+void Reader::FillPropertyIndex(PexScript& pex)
+{
+  for (auto& object : pex.objectTable) {
+    for (auto& prop : object.properties) {
+      if ((prop.flags & 5) == Object::PropInfo::kFlags_Read) {
+        pex.readablePropertyByName.emplace(prop.name, &prop);
+      }
+      if ((prop.flags & 6) == Object::PropInfo::kFlags_Write) {
+        pex.writablePropertyByName.emplace(prop.name, &prop);
+      }
+    }
+  }
+}
+
 void Reader::FillHeader(ScriptHeader& scriptHeader)
 {
   scriptHeader.Signature = Read32_bit(); // 00	FA57C0DE
@@ -289,25 +309,25 @@ FunctionInfo Reader::FillFuncInfo()
   info.params.reserve(countParams);
 
   for (int i = 0; i < countParams; i++) {
-    FunctionInfo::ParamInfo temp;
-    temp.name = this->structure->stringTable.GetStorage()[Read16_bit()];
-    temp.type = this->structure->stringTable.GetStorage()[Read16_bit()];
-    info.params.push_back(temp);
+    auto& name = this->structure->stringTable.GetStorage()[Read16_bit()];
+    auto& type = this->structure->stringTable.GetStorage()[Read16_bit()];
+    info.params.emplace_back(name, type);
   }
 
   int countLocals = Read16_bit();
   info.params.reserve(countLocals);
 
   for (int i = 0; i < countLocals; i++) {
-    FunctionInfo::ParamInfo temp;
-    temp.name = this->structure->stringTable.GetStorage()[Read16_bit()];
-    temp.type = this->structure->stringTable.GetStorage()[Read16_bit()];
-    info.params.push_back(temp);
+    auto& name = this->structure->stringTable.GetStorage()[Read16_bit()];
+    auto& type = this->structure->stringTable.GetStorage()[Read16_bit()];
+    info.params.emplace_back(name, type);
   }
 
   int countInstructions = Read16_bit();
 
   info.code = FillFunctionCode(countInstructions);
+  info.compiledCode =
+    CompiledFunctionCode::Compile(info, &this->structure->stringTable);
 
   return info;
 }
@@ -411,7 +431,8 @@ uint8_t Reader::Read8_bit()
 {
   uint8_t temp;
 
-  temp = arrayBytes[currentReadPositionInFile];
+  RequireBytes(1);
+  temp = bytes[currentReadPositionInFile];
   currentReadPositionInFile++;
 
   return temp;
@@ -420,9 +441,10 @@ uint8_t Reader::Read8_bit()
 uint16_t Reader::Read16_bit()
 {
   uint16_t temp = 0;
+  RequireBytes(2);
 
   for (int i = 0; i < 2; i++) {
-    temp = temp * 256 + arrayBytes[currentReadPositionInFile];
+    temp = temp * 256 + bytes[currentReadPositionInFile];
     currentReadPositionInFile++;
   }
 
@@ -432,9 +454,10 @@ uint16_t Reader::Read16_bit()
 uint32_t Reader::Read32_bit()
 {
   uint32_t temp = 0;
+  RequireBytes(4);
 
   for (int i = 0; i < 4; i++) {
-    temp = temp * 256 + arrayBytes[currentReadPositionInFile];
+    temp = temp * 256 + bytes[currentReadPositionInFile];
     currentReadPositionInFile++;
   }
   return temp;
@@ -443,9 +466,10 @@ uint32_t Reader::Read32_bit()
 uint64_t Reader::Read64_bit()
 {
   uint64_t temp = 0;
+  RequireBytes(8);
 
   for (int i = 0; i < 8; i++) {
-    temp = temp * 256 + arrayBytes[currentReadPositionInFile];
+    temp = temp * 256 + bytes[currentReadPositionInFile];
     currentReadPositionInFile++;
   }
   return temp;
@@ -453,13 +477,17 @@ uint64_t Reader::Read64_bit()
 
 std::string Reader::ReadString(int size)
 {
-  std::string temp;
-  temp.reserve(size);
+  RequireBytes(size);
+  std::string temp(reinterpret_cast<const char*>(bytes) +
+                     currentReadPositionInFile,
+                   size);
+  currentReadPositionInFile += size;
+  return temp;
+}
 
-  for (int i = 0; i < size; i++) {
-    temp += (char)arrayBytes[currentReadPositionInFile];
-    currentReadPositionInFile++;
+void Reader::RequireBytes(size_t n)
+{
+  if (currentReadPositionInFile + n > numBytes) {
+    throw std::runtime_error("Unexpected end of pex");
   }
-
-  return temp;
 }
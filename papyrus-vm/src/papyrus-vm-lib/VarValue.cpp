@@ -1,15 +1,107 @@
 #include "papyrus-vm/Structures.h"
 #include "papyrus-vm/VirtualMachine.h"
 
+#include <atomic>
 #include <cmath>
+#include <cstring>
+#include <deque>
+#include <limits>
+#include <mutex>
 #include <spdlog/spdlog.h>
 #include <sstream>
+#include <unordered_map>
+
+static_assert(sizeof(VarValue) <= 24,
+              "VarValue is copied on every opcode, keep it small");
+
+struct VarValue::Extra
+{
+  Extra() = default;
+
+  Extra(const Extra& rhs)
+    : owningObject(rhs.owningObject)
+    , array(rhs.array)
+    , promise(rhs.promise)
+    , string(rhs.string)
+  {
+  }
+
+  static void AddRef(Extra* extra)
+  {
+    if (extra) {
+      extra->refCount.fetch_add(1, std::memory_order_relaxed);
+    }
+  }
+
+  static void Release(Extra* extra)
+  {
+    if (extra &&
+        extra->refCount.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+      delete extra;
+    }
+  }
+
+  std::atomic<uint32_t> refCount = 1;
+
+  std::shared_ptr<IGameObject> owningObject;
+  std::shared_ptr<std::vector<VarValue>> array;
+  std::shared_ptr<Viet::Promise<VarValue>> promise;
+  std::string string; // See kFlag_OwnedString
+};
+
+namespace {
+// There are not that many type names in scripts, so VarValue stores an
+// index instead of a copy of the name
+class ObjectTypeNames
+{
+public:
+  static ObjectTypeNames& GetInstance()
+  {
+    static ObjectTypeNames instance;
+    return instance;
+  }
+
+  uint16_t GetId(const std::string& name)
+  {
+    if (name.empty()) {
+      return 0;
+    }
+
+    std::lock_guard l(m);
+    auto it = ids.find(name);
+    if (it != ids.end()) {
+      return it->second;
+    }
+
+    if (names.size() > std::numeric_limits<uint16_t>::max()) {
+      throw std::runtime_error("Too many distinct object type names");
+    }
+    auto id = static_cast<uint16_t>(names.size());
+    names.push_back(name);
+    ids.emplace(name, id);
+    return id;
+  }
+
+  const std::string& GetName(uint16_t id)
+  {
+    std::lock_guard l(m);
+    return names[id];
+  }
+
+private:
+  ObjectTypeNames() { names.emplace_back(); }
+
+  std::mutex m;
+  std::deque<std::string> names; // References stay valid on push_back
+  std::unordered_map<std::string, uint16_t> ids;
+};
+}
 
 VarValue VarValue::CastToInt() const
 {
   switch (this->type) {
     case kType_String:
-      return VarValue((int32_t)atoi(this->data.string));
+      return VarValue((int32_t)atoi(static_cast<const char*>(*this)));
     case kType_Integer:
       return VarValue((int32_t)this->data.i);
     case kType_Float:
@@ -57,8 +149,7 @@ VarValue VarValue::CastToBool() const
       spdlog::error("VarValue::CastToBool - Wrong type in CastToBool");
       return VarValue(false);
     case kType_String: {
-      std::string str;
-      if (this->data.string == str) {
+      if (static_cast<const char*>(*this)[0] == '\0') {
         return VarValue(false);
       } else {
         return VarValue(true);
@@ -75,7 +166,7 @@ VarValue VarValue::CastToBool() const
     case kType_IntArray:
     case kType_FloatArray:
     case kType_BoolArray:
-      return VarValue(this->pArray && this->pArray->size() > 0);
+      return VarValue(GetArray() && GetArray()->size() > 0);
     default:
       spdlog::error("VarValue::CastToBool - Wrong type in CastToBool");
       return VarValue(false);
@@ -84,10 +175,10 @@ VarValue VarValue::CastToBool() const
 
 void VarValue::Then(std::function<void(VarValue)> cb)
 {
-  if (!promise) {
+  if (!GetPromise()) {
     throw std::runtime_error("Not a promise");
   }
-  promise->Then(cb);
+  GetPromise()->Then(cb);
 }
 
 VarValue::VarValue(uint8_t type)
@@ -124,7 +215,7 @@ VarValue::VarValue(uint8_t type)
     case kType_FloatArray:
     case kType_BoolArray:
       this->type = static_cast<Type>(type);
-      this->pArray = nullptr;
+      this->data.id = nullptr;
       break;
 
     default:
@@ -163,8 +254,10 @@ VarValue::VarValue(const char* value)
 VarValue::VarValue(const std::string& value)
 {
   this->type = this->kType_String;
-  this->stringHolder.reset(new std::string(value));
-  this->data.string = this->stringHolder->data();
+  this->data.string = nullptr;
+  flags |= kFlag_OwnedString;
+  extra() = new Extra;
+  extra()->string = value;
 }
 
 VarValue::VarValue(double value)
@@ -183,13 +276,169 @@ VarValue::VarValue(Viet::Promise<VarValue> promise)
 {
   this->type = this->kType_Object;
   this->data.id = nullptr;
-  this->promise.reset(new Viet::Promise<VarValue>(promise));
+  extra() = new Extra;
+  extra()->promise.reset(new Viet::Promise<VarValue>(promise));
 }
 
 VarValue::VarValue(std::shared_ptr<IGameObject> object)
   : VarValue(object.get())
 {
-  owningObject = object;
+  if (object) {
+    extra() = new Extra;
+    extra()->owningObject = std::move(object);
+  }
+}
+
+VarValue::VarValue(const VarValue& arg2)
+  : pArray(arg2.pArray)
+  , data(arg2.data)
+  , stackId(arg2.stackId)
+  , type(arg2.type)
+  , flags(arg2.flags)
+  , objectType(arg2.objectType)
+{
+  Extra::AddRef(extra());
+}
+
+VarValue::VarValue(VarValue&& arg2) noexcept
+  : pArray(arg2.pArray)
+  , data(arg2.data)
+  , stackId(arg2.stackId)
+  , type(arg2.type)
+  , flags(arg2.flags)
+  , objectType(arg2.objectType)
+{
+  // Leave arg2 None. An owned string stays in Extra, so pointers to it
+  // remain valid
+  arg2.extra() = nullptr;
+  arg2.data.id = nullptr;
+  arg2.type = kType_Object;
+  arg2.flags = 0;
+}
+
+VarValue::~VarValue()
+{
+  Extra::Release(extra());
+}
+
+VarValue::operator const char*() const
+{
+  return (flags & kFlag_OwnedString) ? extra()->string.c_str() : data.string;
+}
+
+const std::shared_ptr<std::vector<VarValue>>& VarValue::GetArray() const
+{
+  return pArray;
+}
+
+void VarValue::SetArray(std::shared_ptr<std::vector<VarValue>> array)
+{
+  pArray = std::move(array);
+}
+
+const std::shared_ptr<Viet::Promise<VarValue>>& VarValue::GetPromise() const
+{
+  return promise;
+}
+
+const std::string& VarValue::GetObjectType() const
+{
+  return objectType;
+}
+
+void VarValue::SetObjectType(const std::string& objectType_)
+{
+  objectType = objectType_;
+}
+
+uint16_t VarValue::InternObjectType(const std::string& objectType)
+{
+  return ObjectTypeNames::GetInstance().GetId(objectType);
+}
+
+VarValue::Extra& VarValue::MutableExtra(Extra*& extra)
+{
+  if (!extra) {
+    extra = new Extra;
+  } else if (extra->refCount.load(std::memory_order_acquire) > 1) {
+    auto copy = new Extra(*extra);
+    Extra::Release(extra);
+    extra = copy;
+  }
+  return *extra;
+}
+
+VarValue::ArrayMember& VarValue::ArrayMember::operator=(
+  const ArrayMember& rhs)
+{
+  using Ptr = std::shared_ptr<std::vector<VarValue>>;
+  return *this = static_cast<const Ptr&>(rhs);
+}
+
+VarValue::ArrayMember& VarValue::ArrayMember::operator=(
+  std::shared_ptr<std::vector<VarValue>> array)
+{
+  if (array || extra) {
+    MutableExtra(extra).array = std::move(array);
+  }
+  return *this;
+}
+
+void VarValue::ArrayMember::reset(std::vector<VarValue>* array)
+{
+  *this = std::shared_ptr<std::vector<VarValue>>(array);
+}
+
+std::vector<VarValue>* VarValue::ArrayMember::get() const noexcept
+{
+  return extra ? extra->array.get() : nullptr;
+}
+
+VarValue::ArrayMember::operator const std::shared_ptr<
+  std::vector<VarValue>>&() const noexcept
+{
+  static const std::shared_ptr<std::vector<VarValue>> kNoArray;
+  return extra ? extra->array : kNoArray;
+}
+
+VarValue::PromiseMember& VarValue::PromiseMember::operator=(
+  const PromiseMember& rhs)
+{
+  using Ptr = std::shared_ptr<Viet::Promise<VarValue>>;
+  return *this = static_cast<const Ptr&>(rhs);
+}
+
+VarValue::PromiseMember& VarValue::PromiseMember::operator=(
+  std::shared_ptr<Viet::Promise<VarValue>> promise)
+{
+  if (promise || extra) {
+    MutableExtra(extra).promise = std::move(promise);
+  }
+  return *this;
+}
+
+Viet::Promise<VarValue>* VarValue::PromiseMember::get() const noexcept
+{
+  return extra ? extra->promise.get() : nullptr;
+}
+
+VarValue::PromiseMember::operator const std::shared_ptr<
+  Viet::Promise<VarValue>>&() const noexcept
+{
+  static const std::shared_ptr<Viet::Promise<VarValue>> kNoPromise;
+  return extra ? extra->promise : kNoPromise;
+}
+
+VarValue::ObjectTypeMember& VarValue::ObjectTypeMember::operator=(
+  const std::string& objectType)
+{
+  id = InternObjectType(objectType);
+  return *this;
+}
+
+VarValue::ObjectTypeMember::operator const std::string&() const
+{
+  return ObjectTypeNames::GetInstance().GetName(id);
 }
 
 int32_t VarValue::GetMetaStackId() const
@@ -405,7 +654,7 @@ VarValue VarValue::operator!()
     case kType_String: {
       var.type = this->kType_Bool;
       static const std::string g_emptyLine;
-      var.data.b = (this->data.string == g_emptyLine);
+      var.data.b = (static_cast<const char*>(*this) == g_emptyLine);
       return var;
     }
     case kType_ObjectArray:
@@ -414,7 +663,7 @@ VarValue VarValue::operator!()
     case kType_FloatArray:
     case kType_BoolArray:
       var.type = this->kType_Bool;
-      var.data.b = (this->pArray->size() < 1);
+      var.data.b = (GetArray()->size() < 1);
       return var;
     default:
       spdlog::error("VarValue::operator! - Wrong type");
@@ -439,18 +688,9 @@ bool VarValue::operator==(const VarValue& argument2) const
         return false;
       }
 
-      std::string s1;
-      std::string s2;
-
-      if (this->data.string != nullptr) {
-        s1 = this->data.string;
-      }
-
-      if (argument2.data.string != nullptr) {
-        s2 = argument2.data.string;
-      }
-
-      return s1 == s2;
+      auto s1 = static_cast<const char*>(*this);
+      auto s2 = static_cast<const char*>(argument2);
+      return !strcmp(s1 ? s1 : "", s2 ? s2 : "");
     }
     case VarValue::kType_Integer:
       return this->CastToInt().data.i == argument2.CastToInt().data.i;
@@ -543,10 +783,10 @@ std::ostream& operator<<(std::ostream& os, const VarValue& varValue)
          << "']";
       break;
     case VarValue::kType_Identifier:
-      os << "[Identifier '" << varValue.data.string << "']";
+      os << "[Identifier '" << static_cast<const char*>(varValue) << "']";
       break;
     case VarValue::kType_String:
-      os << "[String '" << varValue.data.string << "']";
+      os << "[String '" << static_cast<const char*>(varValue) << "']";
       break;
     case VarValue::kType_Integer:
       os << "[Integer '" << varValue.data.i << "']";
@@ -584,24 +824,18 @@ VarValue& VarValue::operator=(const VarValue& arg2)
   // At the moment when this comment has been written,
   // there was no unit test able to reproduce it.Good luck with debugging.
 
+  // Extra is never modified while shared, so strings are shared too instead
+  // of being copied
+  Extra::AddRef(arg2.extra());
+  auto oldExtra = extra();
+
+  extra() = arg2.extra();
   data = arg2.data;
   type = arg2.type;
-  owningObject = arg2.owningObject;
+  flags = arg2.flags;
 
-  // TODO: Is this check actually needed?
-  if (arg2.type >= arg2._ArraysStart && arg2.type < arg2._ArraysEnd) {
-    pArray = arg2.pArray;
-  }
-
-  promise = arg2.promise;
-
-  if (arg2.stringHolder) {
-    stringHolder.reset(new std::string(*arg2.stringHolder));
-    data.string = stringHolder->data();
-  } else {
-    stringHolder.reset();
-    // data.string ptr is copied by 'data = arg2.data;' line in this case
-  }
+  // Last, arg2 may be an element of the array being released
+  Extra::Release(oldExtra);
 
   return *this;
 }
@@ -655,28 +889,29 @@ VarValue VarValue::GetElementsArrayAtString(const VarValue& array,
 {
   std::string returnValue = "[";
 
-  for (size_t i = 0; i < array.pArray->size(); ++i) {
+  const auto& pArray = array.GetArray();
+  for (size_t i = 0; i < pArray->size(); ++i) {
     switch (type) {
       case VarValue::kType_ObjectArray: {
-        auto object = (static_cast<IGameObject*>((*array.pArray)[i]));
+        auto object = (static_cast<IGameObject*>((*pArray)[i]));
         returnValue += object ? object->GetStringID() : "None";
         break;
       }
 
       case VarValue::kType_StringArray:
-        returnValue += (const char*)((*array.pArray)[i]);
+        returnValue += (const char*)((*pArray)[i]);
         break;
 
       case VarValue::kType_IntArray:
-        returnValue += std::to_string((int)((*array.pArray)[i]));
+        returnValue += std::to_string((int)((*pArray)[i]));
         break;
 
       case VarValue::kType_FloatArray:
-        returnValue += std::to_string((double)((*array.pArray)[i]));
+        returnValue += std::to_string((double)((*pArray)[i]));
         break;
 
       case VarValue::kType_BoolArray: {
-        VarValue& temp = ((*array.pArray)[i]);
+        VarValue& temp = ((*pArray)[i]);
         returnValue += (const char*)(CastToString(temp));
         break;
       }
@@ -687,7 +922,7 @@ VarValue VarValue::GetElementsArrayAtString(const VarValue& array,
         break;
     }
 
-    if (i < array.pArray->size() - 1) {
+    if (i < pArray->size() - 1) {
       returnValue += ", ";
     } else {
       returnValue += "]";
@@ -147,7 +147,7 @@ bool VirtualMachine::DynamicCast(const VarValue& object,
 {
   VarValue scriptToCastOwner = object;
   VarValue result;
-  result.objectType = className.data();
+  result.SetObjectType(className.data());
   ActivePexInstance::CastObjectToObject(*this, &result, &scriptToCastOwner);
 
   if (static_cast<IGameObject*>(result) != nullptr) {
@@ -183,20 +183,23 @@ void VirtualMachine::SendEvent(std::shared_ptr<IGameObject> self,
                                const std::vector<VarValue>& arguments,
                                OnEnter enter)
 {
-  for (auto& scriptInstance : self->ListActivePexInstances()) {
-    auto name = scriptInstance->GetActiveStateName();
+  const auto& instances = self->ListActivePexInstances();
+  if (instances.empty()) {
+    return;
+  }
 
-    // TODO: const&
-    auto fn = scriptInstance->GetFunctionByName(
-      eventName, scriptInstance->GetActiveStateName());
-    if (fn.valid) {
+  const uint32_t eventId = GetEventId(eventName);
+  for (auto& scriptInstance : instances) {
+    auto pex = scriptInstance->GetSourcePex();
+    auto fn = FindEventHandler(*scriptInstance, pex, eventId);
+    if (fn) {
       std::shared_ptr<StackData> stackData;
       stackData.reset(new StackData{ StackIdHolder{ *this } });
       if (enter) {
         enter(*stackData);
       }
       scriptInstance->StartFunction(
-        fn, const_cast<std::vector<VarValue>&>(arguments), stackData);
+        *fn, const_cast<std::vector<VarValue>&>(arguments), stackData);
     }
   }
 }
@@ -205,15 +208,102 @@ void VirtualMachine::SendEvent(ActivePexInstance* instance,
                                const char* eventName,
                                const std::vector<VarValue>& arguments)
 {
-  // TODO: const&
-  auto fn =
-    instance->GetFunctionByName(eventName, instance->GetActiveStateName());
-  if (fn.valid) {
+  auto pex = instance->GetSourcePex();
+  auto fn = FindEventHandler(*instance, pex, GetEventId(eventName));
+  if (fn) {
     std::shared_ptr<StackData> stackData;
     stackData.reset(new StackData{ StackIdHolder{ *this } });
-    instance->StartFunction(fn, const_cast<std::vector<VarValue>&>(arguments),
-                            stackData);
+    instance->StartFunction(
+      *fn, const_cast<std::vector<VarValue>&>(arguments), stackData);
+  }
+}
+
+uint32_t VirtualMachine::GetEventId(const char* eventName)
+{
+  CIString key = eventName;
+  auto it = eventIds.find(key);
+  if (it != eventIds.end()) {
+    return it->second;
+  }
+
+  auto eventId = static_cast<uint32_t>(eventNames.size());
+  eventNames.push_back(eventName);
+  eventIds.emplace(std::move(key), eventId);
+  return eventId;
+}
+
+const FunctionInfo* VirtualMachine::FindEventHandler(
+  ActivePexInstance& instance, const std::shared_ptr<PexScript>& pex,
+  uint32_t eventId)
+{
+  if (!pex) {
+    return nullptr;
+  }
+
+  auto [it, inserted] = eventHandlers.try_emplace(pex.get());
+  auto& scriptEventHandlers = it->second;
+
+  if (!inserted && (scriptEventHandlers.pex.owner_before(pex) ||
+                    pex.owner_before(scriptEventHandlers.pex))) {
+    // The previous script at this address is gone
+    scriptEventHandlers = ScriptEventHandlers();
+    inserted = true;
+  }
+
+  if (inserted) {
+    scriptEventHandlers.pex = pex;
+    for (auto& object : pex->objectTable) {
+      for (auto& state : object.states) {
+        auto& names = scriptEventHandlers.stateNames;
+        auto isSame = [&](const std::string* name) {
+          return *name == state.name;
+        };
+        if (std::find_if(names.begin(), names.end(), isSame) == names.end()) {
+          names.push_back(&state.name);
+        }
+      }
+    }
+    scriptEventHandlers.handlersByState.resize(
+      scriptEventHandlers.stateNames.size() + 1);
+
+    if (eventHandlers.size() >= eventHandlersPruneThreshold) {
+      std::erase_if(eventHandlers, [](const auto& entry) {
+        return entry.second.pex.expired();
+      });
+      eventHandlersPruneThreshold =
+        std::max<size_t>(64, eventHandlers.size() * 2);
+    }
   }
+
+  const char* stateName = instance.GetActiveStateNameRaw();
+  auto& stateNames = scriptEventHandlers.stateNames;
+  size_t stateIdx = 0;
+  while (stateIdx < stateNames.size() && *stateNames[stateIdx] != stateName) {
+    ++stateIdx;
+  }
+  auto& handlers = scriptEventHandlers.handlersByState[stateIdx];
+
+  // Resolve events that were interned since the last time
+  for (size_t i = handlers.size(); i < eventNames.size(); ++i) {
+    const FunctionInfo* handler = nullptr;
+    for (auto& object : pex->objectTable) {
+      for (auto& state : object.states) {
+        if (handler || stateIdx == stateNames.size() ||
+            state.name != *stateNames[stateIdx]) {
+          continue;
+        }
+        for (auto& func : state.functions) {
+          if (!Utils::stricmp(func.name.data(), eventNames[i].data())) {
+            handler = &func.function;
+            break;
+          }
+        }
+      }
+    }
+    handlers.push_back(handler);
+  }
+
+  return handlers[eventId];
 }
 
 StackIdHolder::StackIdHolder(VirtualMachine& vm_)
@@ -1,5 +1,6 @@
 #include "ScampServer.h"
 
+#include "ActionListener.h"
 #include "Bot.h"
 #include "ConditionsEvaluator.h"
 #include "FormCallbacks.h"
@@ -180,6 +181,7 @@ ScampServer::ScampServer(const Napi::CallbackInfo& info)
   try {
     promRegistry = std::make_shared<prometheus::Registry>();
     partOne = std::make_shared<PartOne>();
+    partOne->worldState.GetTickMetrics().AttachRegistry(promRegistry);
     listener = std::make_shared<ScampServerListener>(*this);
     partOne->AddListener(listener);
 
@@ -305,6 +307,10 @@ ScampServer::ScampServer(const Napi::CallbackInfo& info)
                  partOne->worldState.isPapyrusHotReloadEnabled ? "enabled"
                                                                : "disabled");
 
+    partOne->worldState.isPapyrusPreloadEnabled =
+      serverSettings.count("isPapyrusPreloadEnabled") != 0 &&
+      serverSettings.at("isPapyrusPreloadEnabled").get<bool>();
+
     if (serverSettings["dataDir"] != nullptr) {
       dataDir = serverSettings["dataDir"];
     } else {
@@ -340,7 +346,20 @@ ScampServer::ScampServer(const Napi::CallbackInfo& info)
                                                defaultLanguage);
     }
 
-    auto espm = new espm::Loader(pluginPaths);
+    std::filesystem::path espmIndexCacheDir;
+    if (auto it = serverSettings.find("espmIndexCacheDir");
+        it != serverSettings.end() && it->is_string()) {
+      espmIndexCacheDir = it->get<std::string>();
+    }
+
+    auto espmLoadStart = std::chrono::steady_clock::now();
+    auto espm = new espm::Loader(pluginPaths, nullptr,
+                                 espm::Loader::BufferType::MappedBuffer,
+                                 espmIndexCacheDir);
+    std::chrono::duration<float> espmLoadDuration =
+      std::chrono::steady_clock::now() - espmLoadStart;
+    logger->info("Loaded {} game files in {} seconds", pluginPaths.size(),
+                 espmLoadDuration.count());
     std::string password = serverSettings.contains("password")
       ? std::string(kNetworkingPasswordPrefix) +
         static_cast<std::string>(serverSettings["password"])
@@ -393,6 +412,45 @@ ScampServer::ScampServer(const Napi::CallbackInfo& info)
     partOne->AttachEspm(espm);
     partOne->animationSystem.Init(&partOne->worldState);
 
+    if (auto it = serverSettings.find("prewarmEspmRecords");
+        it != serverSettings.end() && it->is_boolean() && it->get<bool>()) {
+      auto was = std::chrono::steady_clock::now();
+      espm::PrewarmDecodedRecords<espm::NPC_>(*espm);
+      espm::PrewarmDecodedRecords<espm::RACE>(*espm);
+      std::chrono::duration<float> elapsed =
+        std::chrono::steady_clock::now() - was;
+      logger->info("Decoded {} NPC_ and RACE records in {} seconds",
+                   espm->GetDecodedRecordCache().GetSize(), elapsed.count());
+    }
+
+    auto& espmCache = espm->GetBrowser().GetCache();
+    if (auto it = serverSettings.find("espmCacheMaxMegabytes");
+        it != serverSettings.end() && it->is_number() &&
+        it->get<double>() > 0) {
+      espmCache.SetMaxBytes(
+        static_cast<size_t>(it->get<double>() * 1024 * 1024));
+    }
+
+    if (auto it = serverSettings.find("prewarmCompressedFields");
+        it != serverSettings.end() && it->is_boolean() && it->get<bool>()) {
+      auto was = std::chrono::steady_clock::now();
+      espm->PrewarmCompressedFields({ "NPC_", "CELL", "REFR" });
+      std::chrono::duration<float> elapsed =
+        std::chrono::steady_clock::now() - was;
+      auto stats = espmCache.GetStats();
+      logger->info("Decompressed {} records ({} bytes) in {} seconds",
+                   stats.numEntries, stats.numBytes, elapsed.count());
+    }
+
+    if (auto it = serverSettings.find("chunkStreamingTickBudgetMs");
+        it != serverSettings.end() && it->is_number()) {
+      auto budgetUs = static_cast<int64_t>(it->get<double>() * 1000);
+      partOne->worldState.EnableChunkStreaming(
+        std::chrono::microseconds(budgetUs));
+      logger->info("Chunk streaming enabled with {} ms tick budget",
+                   it->get<double>());
+    }
+
     if (conditionsEvaluatorSettings.is_object()) {
       partOne->worldState.conditionsEvaluatorSettings =
         ConditionsEvaluatorSettings::FromJson(conditionsEvaluatorSettings);
@@ -429,6 +487,31 @@ ScampServer::ScampServer(const Napi::CallbackInfo& info)
       partOne->EnableGamemodeDataUpdatesBroadcast(enableBroadcast);
     }
 
+    if (auto it = serverSettings.find("movementRelayLod");
+        it != serverSettings.end() && it->is_object()) {
+      auto& actionListener = partOne->GetActionListener();
+      auto lodSettings = actionListener.GetMovementRelayLod().GetSettings();
+      lodSettings.enabled = it->value("enabled", lodSettings.enabled);
+      lodSettings.fullRateDistance =
+        it->value("fullRateDistance", lodSettings.fullRateDistance);
+      lodSettings.reducedRateInterval = std::chrono::milliseconds(
+        it->value("reducedRateIntervalMs",
+                  lodSettings.reducedRateInterval.count()));
+      lodSettings.heartbeatInterval = std::chrono::milliseconds(it->value(
+        "heartbeatIntervalMs", lodSettings.heartbeatInterval.count()));
+      actionListener.GetMovementRelayLod().SetSettings(lodSettings);
+    }
+
+    if (auto it = serverSettings.find("enableOutboundBatching");
+        it != serverSettings.end() && it->is_boolean()) {
+      partOne->EnableOutboundBatching(it->get<bool>());
+    }
+
+    if (auto it = serverSettings.find("enableCompactMovement");
+        it != serverSettings.end() && it->is_boolean()) {
+      partOne->EnableCompactMovement(it->get<bool>());
+    }
+
     auto res =
       NapiHelper::RunScript(Env(),
                             "let require = global.require || "
@@ -474,9 +557,14 @@ Napi::Value ScampServer::Tick(const Napi::CallbackInfo& info)
   try {
     tickEnv = info.Env();
 
+    auto& metrics = partOne->worldState.GetTickMetrics();
+    TickMetrics::ScopedTimer tickTimer(metrics, TickMetrics::Phase::Tick);
+
     bool tickFinished = false;
     while (!tickFinished) {
       try {
+        TickMetrics::ScopedTimer timer(metrics,
+                                       TickMetrics::Phase::PacketReceive);
         server->Tick(PartOne::HandlePacket, partOne.get());
         tickFinished = true;
       } catch (const std::exception& e) {
@@ -1185,13 +1273,13 @@ Napi::Value ScampServer::GetNeighborsByPosition(const Napi::CallbackInfo& info)
 
     auto cellX = static_cast<int32_t>(pos[0] / 4096);
     auto cellY = static_cast<int32_t>(pos[1] / 4096);
-    auto& refs = partOne->worldState.GetNeighborsByPosition(
-      cellOrWorldDesc.ToFormId(partOne->worldState.espmFiles), cellX, cellY);
-
-    Napi::Array arr = Napi::Array::New(info.Env(), refs.size());
-    for (auto ref : refs) {
-      arr.Set(arr.Length(), Napi::Number::New(info.Env(), ref->GetFormId()));
-    }
+    Napi::Array arr = Napi::Array::New(info.Env());
+    partOne->worldState.ForEachNeighborByPosition(
+      cellOrWorldDesc.ToFormId(partOne->worldState.espmFiles), cellX, cellY,
+      [&](MpObjectReference* ref) {
+        arr.Set(arr.Length(),
+                Napi::Number::New(info.Env(), ref->GetFormId()));
+      });
     return arr;
   } catch (std::exception& e) {
     throw Napi::Error::New(info.Env(), std::string(e.what()));
@@ -1,5 +1,6 @@
 #include "MessageSerializerFactory.h"
 #include "MpClientPlugin.h"
+#include "ServerFeaturesMessage.h"
 #include <cstdint>
 #include <nlohmann/json.hpp>
 
@@ -12,6 +13,8 @@ MpClientPlugin::State& GetState()
 
 MessageSerializer& GetMessageSerializer()
 {
+  // Compact movement stays disabled until the server advertises it with
+  // ServerFeaturesMessage. Older servers can't parse it
   static std::shared_ptr<MessageSerializer> g_serializer =
     MessageSerializerFactory::CreateMessageSerializer();
   return *g_serializer;
@@ -32,6 +35,16 @@ bool MyDeserializeMessage(const uint8_t* data, size_t length,
     return false;
   }
 
+  if (result->msgType == MsgType::ServerFeatures) {
+    auto message =
+      reinterpret_cast<ServerFeaturesMessage*>(result->message.get());
+    GetMessageSerializer().SetCompactMovementEnabled(
+      message->compactMovement);
+    // Empty content means the message is consumed, see MpClientPlugin.h
+    outJsonContent.clear();
+    return true;
+  }
+
   // TODO(perf): there should be a faster way to get JS object from binary
   // (without extra json building)
   nlohmann::json outJson;
@@ -50,6 +63,8 @@ __declspec(dllexport) const char* MpCommonGetVersion()
 __declspec(dllexport) void CreateClient(const char* targetHostname,
                                         uint16_t targetPort)
 {
+  // The new server may be older than the previous one
+  GetMessageSerializer().SetCompactMovementEnabled(false);
   return MpClientPlugin::CreateClient(GetState(), targetHostname, targetPort);
 }
 
@@ -0,0 +1,64 @@
+#include "MessageBundle.h"
+#include "MinPacketId.h"
+#include "MsgType.h"
+#include <stdexcept>
+
+bool MessageBundle::IsBundle(const uint8_t* data, size_t length)
+{
+  return length >= kHeaderSize && data[0] >= Networking::MinPacketId &&
+    data[1] == static_cast<uint8_t>(MsgType::Bundle);
+}
+
+void MessageBundle::Append(std::vector<uint8_t>& bundle,
+                           const uint8_t* message, size_t length)
+{
+  if (length > kMaxMessageLength) {
+    throw std::runtime_error("MessageBundle: message is too long");
+  }
+
+  if (bundle.empty()) {
+    bundle.push_back(Networking::MinPacketId);
+    bundle.push_back(static_cast<uint8_t>(MsgType::Bundle));
+  }
+
+  bundle.push_back(static_cast<uint8_t>(length & 0xff));
+  bundle.push_back(static_cast<uint8_t>(length >> 8));
+  bundle.insert(bundle.end(), message, message + length);
+}
+
+namespace {
+template <class F>
+bool Visit(const uint8_t* data, size_t length, const F& f)
+{
+  size_t offset = MessageBundle::kHeaderSize;
+  while (offset < length) {
+    if (length - offset < MessageBundle::kLengthPrefixSize) {
+      return false;
+    }
+    size_t messageLength = data[offset] | (data[offset + 1] << 8);
+    offset += MessageBundle::kLengthPrefixSize;
+
+    if (messageLength == 0 || length - offset < messageLength) {
+      return false;
+    }
+    f(data + offset, messageLength);
+    offset += messageLength;
+  }
+  return true;
+}
+}
+
+bool MessageBundle::ForEach(
+  const uint8_t* data, size_t length,
+  const std::function<void(const uint8_t*, size_t)>& f)
+{
+  if (!IsBundle(data, length)) {
+    return false;
+  }
+
+  // Validate first so that a malformed bundle is rejected as a whole
+  if (!Visit(data, length, [](const uint8_t*, size_t) {})) {
+    return false;
+  }
+  return Visit(data, length, f);
+}
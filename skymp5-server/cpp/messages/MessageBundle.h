@@ -0,0 +1,26 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+// Several messages sent to one user as a single packet. Layout: packet id,
+// MsgType::Bundle, then every message prefixed with its length (uint16,
+// little-endian). Messages keep their own packet id byte, so each of them can
+// be passed to MessageSerializer::Deserialize as is
+namespace MessageBundle {
+constexpr size_t kHeaderSize = 2;
+constexpr size_t kLengthPrefixSize = 2;
+constexpr size_t kMaxMessageLength = 0xffff;
+
+bool IsBundle(const uint8_t* data, size_t length);
+
+// Starts a new bundle if 'bundle' is empty. Throws if the message is longer
+// than kMaxMessageLength
+void Append(std::vector<uint8_t>& bundle, const uint8_t* message,
+            size_t length);
+
+// Returns false without visiting any message if the bundle is malformed
+bool ForEach(const uint8_t* data, size_t length,
+             const std::function<void(const uint8_t*, size_t)>& f);
+}
@@ -143,6 +143,17 @@ void MessageSerializer::Serialize(const char* jsonContent,
   }
 
   auto index = static_cast<size_t>(tResult.value_unsafe());
+
+  if (compactMovementEnabled &&
+      index == static_cast<size_t>(MsgType::UpdateMovement)) {
+    UpdateMovementCompactMessage message;
+    message.ReadJson(parsedJson.value());
+    if (UpdateMovementCompactMessage::IsEncodable(message.data)) {
+      ::Serialize(message, outputStream);
+      return;
+    }
+  }
+
   if (index >= serializerFns.size()) {
     // TODO(#2257): logging
     outputStream.Write(static_cast<uint8_t>(Networking::MinPacketId));
@@ -167,6 +178,11 @@ void MessageSerializer::Serialize(const IMessageBase& message,
   ::Serialize(message, outputStream);
 }
 
+void MessageSerializer::SetCompactMovementEnabled(bool enabled)
+{
+  compactMovementEnabled = enabled;
+}
+
 std::optional<DeserializeResult> MessageSerializer::Deserialize(
   const uint8_t* rawMessageJsonOrBinary, size_t length)
 {
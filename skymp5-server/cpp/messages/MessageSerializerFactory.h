@@ -46,6 +46,11 @@ public:
   std::optional<DeserializeResult> Deserialize(
     const uint8_t* rawMessageJsonOrBinary, size_t length);
 
+  // Makes Serialize(jsonContent, ...) encode UpdateMovement as
+  // UpdateMovementCompactMessage where possible. Enable only if the receiving
+  // side can decode it
+  void SetCompactMovementEnabled(bool enabled);
+
 private:
   typedef void (*SerializeFn)(const simdjson::dom::element& inputJson,
                               SLNet::BitStream& outputStream);
@@ -57,4 +62,5 @@ private:
 
   const std::vector<SerializeFn> serializerFns;
   const std::vector<DeserializeFn> deserializerFns;
+  bool compactMovementEnabled = false;
 };
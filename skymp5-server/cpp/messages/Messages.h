@@ -18,6 +18,7 @@
 #include "OpenContainerMessage.h"
 #include "PlayerBowShotMessage.h"
 #include "PutItemMessage.h"
+#include "ServerFeaturesMessage.h"
 #include "SetInventoryMessage.h"
 #include "SetRaceMenuOpenMessage.h"
 #include "SpSnippetMessage.h"
@@ -30,6 +31,7 @@
 #include "UpdateAppearanceMessage.h"
 #include "UpdateEquipmentMessage.h"
 #include "UpdateGameModeDataMessage.h"
+#include "UpdateMovementCompactMessage.h"
 #include "UpdateMovementMessage.h"
 #include "UpdatePropertyMessage.h"
 
@@ -44,6 +46,7 @@
   REGISTER_MESSAGE(HitMessage)                                                \
   REGISTER_MESSAGE(HostMessage)                                               \
   REGISTER_MESSAGE(UpdateMovementMessage)                                     \
+  REGISTER_MESSAGE(UpdateMovementCompactMessage)                              \
   REGISTER_MESSAGE(UpdateAnimationMessage)                                    \
   REGISTER_MESSAGE(DeathStateContainerMessage)                                \
   REGISTER_MESSAGE(ChangeValuesMessage)                                       \
@@ -66,4 +69,5 @@
   REGISTER_MESSAGE(UpdateAnimVariablesMessage)                                \
   REGISTER_MESSAGE(UpdateAppearanceMessage)                                   \
   REGISTER_MESSAGE(UpdateGameModeDataMessage)                                 \
-  REGISTER_MESSAGE(CreateActorMessage)
+  REGISTER_MESSAGE(CreateActorMessage)                                        \
+  REGISTER_MESSAGE(ServerFeaturesMessage)
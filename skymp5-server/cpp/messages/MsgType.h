@@ -40,5 +40,14 @@ enum class MsgType : uint8_t
   UpdateGamemodeData = 32,
   CreateActor = 33,
 
+  // binary-only encoding of UpdateMovement
+  UpdateMovementCompact = 34,
+
+  // several messages in one packet, see MessageBundle.h
+  Bundle = 35,
+
+  // server capabilities, consumed by the client plugin
+  ServerFeatures = 36,
+
   Max
 };
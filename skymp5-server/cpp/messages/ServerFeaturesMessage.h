@@ -0,0 +1,23 @@
+#pragma once
+#include "MessageBase.h"
+#include "MsgType.h"
+#include <type_traits>
+
+// Sent once to every user on connect. The client plugin consumes it and
+// doesn't pass it to scripts
+struct ServerFeaturesMessage : public MessageBase<ServerFeaturesMessage>
+{
+  static constexpr auto kMsgType =
+    std::integral_constant<char,
+                           static_cast<char>(MsgType::ServerFeatures)>{};
+
+  template <class Archive>
+  void Serialize(Archive& archive)
+  {
+    archive.Serialize("t", kMsgType)
+      .Serialize("compactMovement", compactMovement);
+  }
+
+  // The server accepts UpdateMovementCompactMessage from this user
+  bool compactMovement = false;
+};
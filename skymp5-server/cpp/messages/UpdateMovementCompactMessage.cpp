@@ -0,0 +1,269 @@
+#include "UpdateMovementCompactMessage.h"
+#include <algorithm>
+#include <cmath>
+#include <iterator>
+#include <slikenet/BitStream.h>
+#include <stdexcept>
+
+namespace {
+constexpr int kPosStepsPerUnit = 16;
+constexpr float kMaxSpeed = 8191.f;
+constexpr int kSpeedStepsPerUnit = 8;
+
+constexpr const char* kRunModes[] = { "Standing", "Walking", "Running",
+                                      "Sprinting" };
+
+enum Flags : uint8_t
+{
+  kInJumpState = 1 << 0,
+  kSneaking = 1 << 1,
+  kBlocking = 1 << 2,
+  kWeapDrawn = 1 << 3,
+  kDead = 1 << 4,
+  kHasLookAt = 1 << 5,
+  kRunModeShift = 6
+};
+
+int FindRunMode(const std::string& runMode)
+{
+  for (size_t i = 0; i < std::size(kRunModes); ++i) {
+    if (runMode == kRunModes[i]) {
+      return static_cast<int>(i);
+    }
+  }
+  return -1;
+}
+
+bool IsPosEncodable(const std::array<float, 3>& pos)
+{
+  // 128 cells, larger than any worldspace. Further away float precision
+  // itself gets worse than kPosError
+  constexpr float kMaxAbs = 524288.f;
+  for (float v : pos) {
+    if (!std::isfinite(v) || std::abs(v) > kMaxAbs) {
+      return false;
+    }
+  }
+  return true;
+}
+
+class Writer
+{
+public:
+  explicit Writer(std::vector<uint8_t>& out_)
+    : out(out_)
+  {
+  }
+
+  void U8(uint8_t v) { out.push_back(v); }
+
+  void U16(uint16_t v)
+  {
+    out.push_back(static_cast<uint8_t>(v & 0xff));
+    out.push_back(static_cast<uint8_t>(v >> 8));
+  }
+
+  void VarUint(uint32_t v)
+  {
+    while (v >= 0x80) {
+      out.push_back(static_cast<uint8_t>(v | 0x80));
+      v >>= 7;
+    }
+    out.push_back(static_cast<uint8_t>(v));
+  }
+
+  void VarInt(int32_t v)
+  {
+    VarUint((static_cast<uint32_t>(v) << 1) ^ static_cast<uint32_t>(v >> 31));
+  }
+
+  // High bits are the cell, low 16 bits are the offset inside the cell
+  void Pos(const std::array<float, 3>& pos)
+  {
+    for (float v : pos) {
+      auto steps = std::llround(static_cast<double>(v) * kPosStepsPerUnit);
+      VarInt(static_cast<int32_t>(steps >> 16));
+      U16(static_cast<uint16_t>(steps & 0xffff));
+    }
+  }
+
+  void Angle(float degrees)
+  {
+    double turns = static_cast<double>(degrees) / 360.0;
+    turns -= std::floor(turns);
+    U16(static_cast<uint16_t>(std::llround(turns * 65536) & 0xffff));
+  }
+
+private:
+  std::vector<uint8_t>& out;
+};
+
+class Reader
+{
+public:
+  Reader(const uint8_t* data_, size_t length_)
+    : data(data_)
+    , length(length_)
+  {
+  }
+
+  uint8_t U8()
+  {
+    Require(1);
+    return data[pos++];
+  }
+
+  uint16_t U16()
+  {
+    Require(2);
+    uint16_t v = data[pos] | (static_cast<uint16_t>(data[pos + 1]) << 8);
+    pos += 2;
+    return v;
+  }
+
+  uint32_t VarUint()
+  {
+    uint32_t v = 0;
+    for (int shift = 0; shift < 35; shift += 7) {
+      uint8_t byte = U8();
+      v |= static_cast<uint32_t>(byte & 0x7f) << shift;
+      if (!(byte & 0x80)) {
+        return v;
+      }
+    }
+    throw std::runtime_error("UpdateMovementCompactMessage: varint too long");
+  }
+
+  int32_t VarInt()
+  {
+    uint32_t v = VarUint();
+    return static_cast<int32_t>((v >> 1) ^ (~(v & 1) + 1));
+  }
+
+  void Pos(std::array<float, 3>& pos)
+  {
+    for (float& v : pos) {
+      int64_t cell = VarInt();
+      int64_t steps = cell * 65536 + U16();
+      v = static_cast<float>(static_cast<double>(steps) / kPosStepsPerUnit);
+    }
+  }
+
+  float Angle() { return static_cast<float>(U16() * (360.0 / 65536)); }
+
+  size_t GetPosition() const { return pos; }
+
+private:
+  void Require(size_t n)
+  {
+    if (length - pos < n) {
+      throw std::runtime_error("UpdateMovementCompactMessage: unexpected end "
+                               "of data");
+    }
+  }
+
+  const uint8_t* const data;
+  const size_t length;
+  size_t pos = 0;
+};
+}
+
+bool UpdateMovementCompactMessage::IsEncodable(const Data& data)
+{
+  auto isFinite = [](float v) { return std::isfinite(v); };
+  return FindRunMode(data.runMode) != -1 && IsPosEncodable(data.pos) &&
+    (!data.lookAt || IsPosEncodable(*data.lookAt)) &&
+    std::all_of(data.rot.begin(), data.rot.end(), isFinite) &&
+    isFinite(data.direction) && data.healthPercentage >= 0.f &&
+    data.healthPercentage <= 1.f && data.speed >= 0.f &&
+    data.speed < kMaxSpeed;
+}
+
+void UpdateMovementCompactMessage::WriteBinary(SLNet::BitStream& stream) const
+{
+  std::vector<uint8_t> body;
+  Encode(*this, body);
+  stream.Write(static_cast<uint8_t>(kMsgType.value));
+  stream.Write(reinterpret_cast<const char*>(body.data()),
+               static_cast<unsigned int>(body.size()));
+}
+
+void UpdateMovementCompactMessage::ReadBinary(SLNet::BitStream& stream)
+{
+  stream.IgnoreBytes(sizeof(kMsgType.value));
+
+  auto readOffsetBytes = BITS_TO_BYTES(stream.GetReadOffset());
+  auto unreadBytes = BITS_TO_BYTES(stream.GetNumberOfUnreadBits());
+  size_t consumed =
+    Decode(stream.GetData() + readOffsetBytes, unreadBytes, *this);
+  stream.IgnoreBytes(static_cast<unsigned int>(consumed));
+}
+
+void UpdateMovementCompactMessage::Encode(const UpdateMovementMessage& message,
+                                          std::vector<uint8_t>& out)
+{
+  auto& data = message.data;
+  if (!IsEncodable(data)) {
+    throw std::runtime_error(
+      "UpdateMovementCompactMessage: message is not encodable");
+  }
+
+  uint8_t flags = static_cast<uint8_t>(FindRunMode(data.runMode))
+    << kRunModeShift;
+  flags |= data.isInJumpState ? kInJumpState : 0;
+  flags |= data.isSneaking ? kSneaking : 0;
+  flags |= data.isBlocking ? kBlocking : 0;
+  flags |= data.isWeapDrawn ? kWeapDrawn : 0;
+  flags |= data.isDead ? kDead : 0;
+  flags |= data.lookAt ? kHasLookAt : 0;
+
+  Writer w(out);
+  w.VarUint(message.idx);
+  w.VarUint(data.worldOrCell);
+  w.U8(flags);
+  w.Pos(data.pos);
+  for (float v : data.rot) {
+    w.Angle(v);
+  }
+  w.Angle(data.direction);
+  w.U16(static_cast<uint16_t>(std::lround(data.healthPercentage * 65535)));
+  w.U16(static_cast<uint16_t>(std::lround(data.speed * kSpeedStepsPerUnit)));
+  if (data.lookAt) {
+    w.Pos(*data.lookAt);
+  }
+}
+
+size_t UpdateMovementCompactMessage::Decode(const uint8_t* bytes,
+                                            size_t length,
+                                            UpdateMovementMessage& out)
+{
+  Reader r(bytes, length);
+  auto& data = out.data;
+
+  out.idx = r.VarUint();
+  data.worldOrCell = r.VarUint();
+
+  uint8_t flags = r.U8();
+  data.runMode = kRunModes[flags >> kRunModeShift];
+  data.isInJumpState = flags & kInJumpState;
+  data.isSneaking = flags & kSneaking;
+  data.isBlocking = flags & kBlocking;
+  data.isWeapDrawn = flags & kWeapDrawn;
+  data.isDead = flags & kDead;
+
+  r.Pos(data.pos);
+  for (float& v : data.rot) {
+    v = r.Angle();
+  }
+  data.direction = r.Angle();
+  data.healthPercentage = r.U16() / 65535.f;
+  data.speed = static_cast<float>(r.U16()) / kSpeedStepsPerUnit;
+
+  if (flags & kHasLookAt) {
+    r.Pos(data.lookAt.emplace());
+  } else {
+    data.lookAt = std::nullopt;
+  }
+
+  return r.GetPosition();
+}
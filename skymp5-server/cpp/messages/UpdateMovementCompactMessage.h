@@ -0,0 +1,47 @@
+#pragma once
+#include "UpdateMovementMessage.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Binary encoding of UpdateMovementMessage, roughly 2.5 times smaller:
+// positions are fixed-point relative to the 4096 unit cell grid, angles are
+// 16-bit, runMode and flags share a single byte. The JSON form is identical
+// to UpdateMovementMessage, so scripts can't tell them apart.
+//
+// Peers that don't know this message type can't decode it. A client sends it
+// to announce support, see UserInfo::compactMovement
+struct UpdateMovementCompactMessage : public UpdateMovementMessage
+{
+  static constexpr auto kMsgType = std::integral_constant<
+    char, static_cast<char>(MsgType::UpdateMovementCompact)>{};
+
+  // Max absolute error of decoded values. Angles are compared modulo 360
+  static constexpr float kPosError = 1.f / 16;
+  static constexpr float kAngleError = 360.f / 65536 / 2;
+  static constexpr float kHealthPercentageError = 1.f / 65535 / 2;
+  static constexpr float kSpeedError = 1.f / 16;
+
+  UpdateMovementCompactMessage() = default;
+
+  explicit UpdateMovementCompactMessage(const UpdateMovementMessage& message)
+    : UpdateMovementMessage(message)
+  {
+  }
+
+  // False if some value can't be represented: unknown runMode, NaN,
+  // coordinates beyond 128 cells, speed out of [0, 8191), etc. Such messages
+  // should be sent as UpdateMovementMessage
+  static bool IsEncodable(const Data& data);
+
+  void WriteBinary(SLNet::BitStream& stream) const override;
+  void ReadBinary(SLNet::BitStream& stream) override;
+
+  // Message body without the message type byte
+  static void Encode(const UpdateMovementMessage& message,
+                     std::vector<uint8_t>& out);
+
+  // Returns the number of bytes consumed. Throws on malformed input
+  static size_t Decode(const uint8_t* data, size_t length,
+                       UpdateMovementMessage& out);
+};
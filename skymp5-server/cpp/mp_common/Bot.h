@@ -0,0 +1,43 @@
+#pragma once
+#include "Networking.h"
+
+class Bot
+{
+public:
+  Bot(std::shared_ptr<Networking::IClient> cl_)
+    : cl(cl_)
+  {
+  }
+
+  void Destroy() { cl.reset(); }
+
+  void Send(std::string packet)
+  {
+    if (cl)
+      cl->Send(reinterpret_cast<Networking::PacketData>(packet.data()),
+               packet.size(), true);
+  }
+
+  void Tick()
+  {
+    if (cl)
+      cl->Tick(
+        [](void* state, Networking::PacketType packetType,
+           Networking::PacketData, size_t length, const char*) {
+          if (packetType == Networking::PacketType::Message) {
+            auto this_ = reinterpret_cast<Bot*>(state);
+            ++this_->numMessagesReceived;
+            this_->numBytesReceived += length;
+          }
+        },
+        this);
+  }
+
+  size_t GetNumMessagesReceived() const { return numMessagesReceived; }
+  size_t GetNumBytesReceived() const { return numBytesReceived; }
+
+private:
+  std::shared_ptr<Networking::IClient> cl;
+  size_t numMessagesReceived = 0;
+  size_t numBytesReceived = 0;
+};
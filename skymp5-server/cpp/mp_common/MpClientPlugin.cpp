@@ -1,5 +1,6 @@
 #include "MpClientPlugin.h"
 
+#include "MessageBundle.h"
 #include "MessageSerializerFactory.h"
 #include "MsgType.h"
 #include <FileUtils.h>
@@ -50,6 +51,31 @@ bool MpClientPlugin::IsConnected(State& state)
   return state.cl && state.cl->IsConnected();
 }
 
+namespace {
+void HandleMessage(MpClientPlugin::OnPacket onPacket,
+                   MpClientPlugin::DeserializeMessage deserializeMessageFn,
+                   void* state, Networking::PacketData data, size_t length,
+                   const char* error)
+{
+  auto packetType = static_cast<int32_t>(Networking::PacketType::Message);
+
+  std::string deserializedJsonContent;
+  if (deserializeMessageFn(data, length, deserializedJsonContent)) {
+    if (deserializedJsonContent.empty()) {
+      return;
+    }
+    return onPacket(packetType, deserializedJsonContent.data(),
+                    deserializedJsonContent.size(), error, state);
+  }
+
+  // Previously, it was string-only
+  // Now it can be any bytes while still being std::string
+  std::string rawContent =
+    std::string(reinterpret_cast<const char*>(data) + 1, length - 1);
+  onPacket(packetType, rawContent.data(), rawContent.size(), error, state);
+}
+}
+
 void MpClientPlugin::Tick(State& state, OnPacket onPacket,
                           DeserializeMessage deserializeMessageFn,
                           void* state_)
@@ -71,19 +97,19 @@ void MpClientPlugin::Tick(State& state, OnPacket onPacket,
         return onPacket(static_cast<int32_t>(packetType), "", 0, error, state);
       }
 
-      std::string deserializedJsonContent;
-      if (deserializeMessageFn(data, length, deserializedJsonContent)) {
-        return onPacket(static_cast<int32_t>(packetType),
-                        deserializedJsonContent.data(),
-                        deserializedJsonContent.size(), error, state);
+      if (!MessageBundle::IsBundle(data, length)) {
+        return HandleMessage(onPacket, deserializeMessageFn, state, data,
+                             length, error);
       }
 
-      // Previously, it was string-only
-      // Now it can be any bytes while still being std::string
-      std::string rawContent =
-        std::string(reinterpret_cast<const char*>(data) + 1, length - 1);
-      onPacket(static_cast<int32_t>(packetType), rawContent.data(),
-               rawContent.size(), error, state);
+      bool valid = MessageBundle::ForEach(
+        data, length, [&](const uint8_t* message, size_t messageLength) {
+          HandleMessage(onPacket, deserializeMessageFn, state, message,
+                        messageLength, error);
+        });
+      if (!valid) {
+        spdlog::error("MpClientPlugin::Tick - malformed message bundle");
+      }
     },
     &locals);
 }
@@ -14,6 +14,8 @@ struct State
 
 typedef void (*SerializeMessage)(const char* jsonContent,
                                  SLNet::BitStream& outputBuffer);
+// Returning true with empty outJsonContent drops the message: it has been
+// handled by the plugin and isn't passed to onPacket
 typedef bool (*DeserializeMessage)(const uint8_t* data, size_t length,
                                    std::string& outJsonContent);
 
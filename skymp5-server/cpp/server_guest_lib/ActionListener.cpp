@@ -19,6 +19,7 @@
 #include "script_objects/EspmGameObject.h"
 #include <fmt/format.h>
 #include <fmt/ranges.h>
+#include <optional>
 #include <spdlog/spdlog.h>
 #include <unordered_set>
 
@@ -28,6 +29,7 @@
 #include "SpSnippet.h"
 #include "UpdateAnimVariablesMessage.h"
 #include "UpdateEquipmentMessage.h"
+#include "UpdateMovementCompactMessage.h"
 
 namespace FormIdCasts {
 uint32_t LongToNormal(uint64_t longFormId)
@@ -36,10 +38,16 @@ uint32_t LongToNormal(uint64_t longFormId)
 }
 }
 
-MpActor* ActionListener::SendToNeighbours(uint32_t idx,
-                                          Networking::UserId userId,
-                                          Networking::PacketData data,
-                                          size_t length, bool reliable)
+namespace {
+// Only the latest movement of the actor is worth sending
+uint64_t GetMovementCoalesceKey(uint32_t idx)
+{
+  return (static_cast<uint64_t>(MsgType::UpdateMovement) << 32) | idx;
+}
+}
+
+MpActor* ActionListener::FindActorToUpdate(uint32_t idx,
+                                           Networking::UserId userId)
 {
   MpActor* myActor = partOne.serverState.ActorByUser(userId);
   // The old behavior is doing nothing in that case. This is covered by tests
@@ -85,6 +93,19 @@ MpActor* ActionListener::SendToNeighbours(uint32_t idx,
     }
   }
 
+  return actor;
+}
+
+MpActor* ActionListener::SendToNeighbours(uint32_t idx,
+                                          Networking::UserId userId,
+                                          Networking::PacketData data,
+                                          size_t length, bool reliable)
+{
+  MpActor* actor = FindActorToUpdate(idx, userId);
+  if (!actor) {
+    return nullptr;
+  }
+
   for (auto listener : actor->GetActorListeners()) {
     auto targetuserId = partOne.serverState.UserByActor(listener);
     if (targetuserId != Networking::InvalidUserId) {
@@ -103,6 +124,130 @@ MpActor* ActionListener::SendToNeighbours(uint32_t idx,
                           rawMsgData.unparsedLength, reliable);
 }
 
+MpActor* ActionListener::SendMovementToNeighbours(
+  const RawMessageData& rawMsgData, const UpdateMovementMessage& msg)
+{
+  MpActor* actor = FindActorToUpdate(msg.idx, rawMsgData.userId);
+  if (!actor) {
+    return nullptr;
+  }
+
+  auto& userInfo = partOne.serverState.userInfo;
+
+  bool isCompact = rawMsgData.unparsedLength >= 2 &&
+    rawMsgData.unparsed[1] ==
+      static_cast<uint8_t>(MsgType::UpdateMovementCompact);
+  if (isCompact && userInfo[rawMsgData.userId]) {
+    userInfo[rawMsgData.userId]->compactMovement = true;
+  }
+
+  // Re-encoded at most once, usually all listeners use the sender's encoding.
+  // Users with compact movement can decode both, so a message that isn't
+  // compact-encodable is sent to them as is
+  std::optional<SerializedMessage> reencoded;
+
+  uint64_t coalesceKey = GetMovementCoalesceKey(msg.idx);
+  auto& sendTarget = partOne.GetSendTarget();
+
+  // Movement of an actor without a user is sent by its host
+  bool isHostedNpc =
+    partOne.serverState.UserByActor(actor) == Networking::InvalidUserId;
+  NiPoint3 sourcePos = { msg.data.pos[0], msg.data.pos[1], msg.data.pos[2] };
+  uint64_t discreteState = MovementRelayLod::GetDiscreteState(msg.data);
+  bool forceRelay = actor->GetTeleportFlag();
+  auto now = MovementRelayLod::Clock::now();
+
+  for (auto listener : actor->GetActorListeners()) {
+    auto targetUserId = partOne.serverState.UserByActor(listener);
+    if (targetUserId == Networking::InvalidUserId) {
+      continue;
+    }
+
+    if (targetUserId != rawMsgData.userId && userInfo[targetUserId]) {
+      auto& relayState =
+        userInfo[targetUserId]->relayedMovementByIdx[msg.idx];
+      auto minInterval = forceRelay
+        ? std::chrono::milliseconds(0)
+        : movementRelayLod.GetMinInterval(listener->GetPos(),
+                                          listener->GetViewDirection(),
+                                          sourcePos, isHostedNpc);
+      if (!movementRelayLod.ShouldRelay(relayState, discreteState,
+                                        minInterval, now)) {
+        if (MovementRelayLod::HoldBack(relayState, msg, minInterval)) {
+          heldBackMovement.push(
+            { relayState.heldBackDue, targetUserId, msg.idx });
+        }
+        continue;
+      }
+    }
+
+    bool targetIsCompact =
+      userInfo[targetUserId] && userInfo[targetUserId]->compactMovement;
+    if (targetIsCompact == isCompact) {
+      sendTarget.SendCoalesced(targetUserId, rawMsgData.unparsed,
+                               rawMsgData.unparsedLength, coalesceKey);
+      continue;
+    }
+
+    if (!reencoded) {
+      if (isCompact) {
+        reencoded = PartOne::SerializeMessage(UpdateMovementMessage(msg));
+      } else if (UpdateMovementCompactMessage::IsEncodable(msg.data)) {
+        reencoded =
+          PartOne::SerializeMessage(UpdateMovementCompactMessage(msg));
+      } else {
+        reencoded = SerializedMessage();
+      }
+    }
+
+    if (reencoded->IsEmpty()) {
+      sendTarget.SendCoalesced(targetUserId, rawMsgData.unparsed,
+                               rawMsgData.unparsedLength, coalesceKey);
+    } else {
+      sendTarget.SendCoalesced(targetUserId, reencoded->GetData(),
+                               reencoded->GetLength(), coalesceKey);
+    }
+  }
+
+  return actor;
+}
+
+void ActionListener::FlushHeldBackMovement()
+{
+  auto now = MovementRelayLod::Clock::now();
+  auto& sendTarget = partOne.GetSendTarget();
+
+  while (!heldBackMovement.empty() && heldBackMovement.top().due <= now) {
+    auto entry = heldBackMovement.top();
+    heldBackMovement.pop();
+
+    // The state is erased once the actor leaves the user's view
+    auto& userInfo = partOne.serverState.userInfo[entry.userId];
+    if (!userInfo) {
+      continue;
+    }
+    auto it = userInfo->relayedMovementByIdx.find(entry.idx);
+    if (it == userInfo->relayedMovementByIdx.end()) {
+      continue;
+    }
+
+    // Nothing to send if the movement was relayed in the meantime
+    auto message = MovementRelayLod::TakeHeldBack(it->second, now);
+    if (!message) {
+      continue;
+    }
+
+    bool compact = userInfo->compactMovement &&
+      UpdateMovementCompactMessage::IsEncodable(message->data);
+    auto serialized = compact
+      ? PartOne::SerializeMessage(UpdateMovementCompactMessage(*message))
+      : PartOne::SerializeMessage(*message);
+    sendTarget.SendCoalesced(entry.userId, serialized.GetData(),
+                             serialized.GetLength(),
+                             GetMovementCoalesceKey(entry.idx));
+  }
+}
+
 void ActionListener::OnCustomPacket(const RawMessageData& rawMsgData,
                                     const CustomPacketMessage& msg)
 {
@@ -116,7 +261,7 @@ void ActionListener::OnCustomPacket(const RawMessageData& rawMsgData,
 void ActionListener::OnUpdateMovement(const RawMessageData& rawMsgData,
                                       const UpdateMovementMessage& msg)
 {
-  auto actor = SendToNeighbours(msg.idx, rawMsgData);
+  auto actor = SendMovementToNeighbours(rawMsgData, msg);
   if (actor) {
     bool teleportFlag = actor->GetTeleportFlag();
     actor->SetTeleportFlag(false);
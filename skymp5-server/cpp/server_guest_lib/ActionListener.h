@@ -3,13 +3,17 @@
 #include "ConsoleCommands.h"
 #include "CraftService.h"
 #include "Messages.h"
+#include "MovementRelayLod.h"
 #include "MpActor.h"
 #include "PartOne.h"
 #include "RawMessageData.h"
 #include "SpellCastData.h"
 #include "SweetHidePlayerNamesService.h"
 #include "libespm/Loader.h"
+#include <functional>
 #include <memory>
+#include <queue>
+#include <vector>
 
 class ServerState;
 class WorldState;
@@ -83,6 +87,11 @@ public:
 
   virtual void OnUnknown(const RawMessageData& rawMsgData);
 
+  MovementRelayLod& GetMovementRelayLod() noexcept { return movementRelayLod; }
+
+  // Relays movement held back by MovementRelayLod once it's due
+  void FlushHeldBackMovement();
+
   // for CraftTest.cpp
   const std::shared_ptr<CraftService>& GetCraftService() noexcept
   {
@@ -98,6 +107,9 @@ private:
   void SendPapyrusOnHitEvent(MpActor* aggressor, MpObjectReference* target,
                              const HitData& hitData);
 
+  // Returns the actor with the given idx if the user is allowed to update it
+  MpActor* FindActorToUpdate(uint32_t idx, Networking::UserId userId);
+
   // Returns user's actor if there is attached one
   MpActor* SendToNeighbours(uint32_t idx, Networking::UserId userId,
                             Networking::PacketData data, size_t length,
@@ -106,9 +118,32 @@ private:
   MpActor* SendToNeighbours(uint32_t idx, const RawMessageData& rawMsgData,
                             bool reliable = false);
 
+  // Like SendToNeighbours, but relays the message to every user in the
+  // movement encoding the user has negotiated
+  MpActor* SendMovementToNeighbours(const RawMessageData& rawMsgData,
+                                    const UpdateMovementMessage& msg);
+
   PartOne& partOne;
 
   // TODO: inverse dependency
   std::shared_ptr<CraftService> craftService;
   std::shared_ptr<SweetHidePlayerNamesService> sweetHidePlayerNamesService;
+
+  MovementRelayLod movementRelayLod;
+
+  struct HeldBackMovement
+  {
+    MovementRelayLod::Clock::time_point due;
+    Networking::UserId userId = Networking::InvalidUserId;
+    uint32_t idx = 0;
+
+    bool operator>(const HeldBackMovement& rhs) const noexcept
+    {
+      return due > rhs.due;
+    }
+  };
+
+  std::priority_queue<HeldBackMovement, std::vector<HeldBackMovement>,
+                      std::greater<>>
+    heldBackMovement;
 };
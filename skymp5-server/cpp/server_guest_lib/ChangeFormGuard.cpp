@@ -1,9 +1,10 @@
 #include "ChangeFormGuard.h"
 #include "WorldState.h"
 
-void ChangeFormGuard_::RequestSave(MpObjectReference* self)
+void ChangeFormGuard_::RequestSave(MpObjectReference* self,
+                                   uint32_t fieldGroups)
 {
   [[likely]] if (auto worldState = self->GetParent()) {
-    worldState->RequestSave(*self);
+    worldState->RequestSave(*self, fieldGroups);
   }
 }
@@ -2,11 +2,12 @@
 #include "MpChangeForms.h"
 #include <chrono>
 #include <optional>
+#include <utility>
 
 class MpObjectReference;
 
 namespace ChangeFormGuard_ {
-void RequestSave(MpObjectReference* self);
+void RequestSave(MpObjectReference* self, uint32_t fieldGroups);
 }
 
 class ChangeFormGuard
@@ -24,13 +25,18 @@ public:
     NoRequestSave
   };
 
+  // fieldGroups are MpChangeFormField groups modified by f. Groups modified
+  // without requesting a save are remembered and saved with the next request
   void EditChangeForm(std::function<void(MpChangeForm&)> f,
-                      Mode mode = Mode::RequestSave)
+                      Mode mode = Mode::RequestSave,
+                      uint32_t fieldGroups = MpChangeFormField::All)
   {
     f(changeForm);
+    unsavedFieldGroups |= fieldGroups;
     if (!blockSaving && mode == Mode::RequestSave) {
       lastSaveRequest = std::chrono::system_clock::now();
-      ChangeFormGuard_::RequestSave(self);
+      ChangeFormGuard_::RequestSave(self,
+                                    std::exchange(unsavedFieldGroups, 0));
     }
   }
 
@@ -44,4 +50,8 @@ private:
   MpChangeForm changeForm;
   MpObjectReference* const self;
   std::optional<std::chrono::system_clock::time_point> lastSaveRequest;
+
+  // The first save writes the whole form, so that partial updates are never
+  // applied to a form that doesn't exist in the database yet
+  uint32_t unsavedFieldGroups = MpChangeFormField::All;
 };
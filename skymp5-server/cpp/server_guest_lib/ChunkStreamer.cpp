@@ -0,0 +1,163 @@
+#include "ChunkStreamer.h"
+#include "EspmRefFilter.h"
+#include "libespm/CombineBrowser.h"
+#include "libespm/CompressedFieldsCache.h"
+#include "libespm/Utils.h"
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <spdlog/spdlog.h>
+#include <thread>
+#include <unordered_set>
+
+namespace {
+bool IsAttachCandidate(const espm::CombineBrowser& br,
+                       const espm::LookupResult& lookupRes,
+                       espm::CompressedFieldsCache& cache)
+{
+  auto mapping = br.GetCombMapping(lookupRes.fileIdx);
+  if (!mapping) {
+    return false;
+  }
+
+  auto res = EspmRefFilter::Check(br, lookupRes.rec, *mapping, cache);
+
+  // AttachEspmRecord rejects references without position as well, later
+  return res.verdict == EspmRefFilter::Verdict::Accepted && res.data.loc;
+}
+}
+
+struct ChunkStreamer::Impl
+{
+  const espm::CombineBrowser* browser = nullptr;
+  size_t numFiles = 0;
+
+  // Accessed by the worker thread only
+  espm::CompressedFieldsCache workerCache;
+
+  mutable std::mutex m;
+  std::condition_variable cv;
+  std::deque<ChunkKey> requested;
+  std::deque<PreparedChunk> ready;
+  size_t numPending = 0;
+  bool destroyed = false;
+
+  std::unique_ptr<std::thread> thr;
+
+  void ThreadMain();
+  PreparedChunk Prepare(const ChunkKey& key);
+};
+
+ChunkStreamer::ChunkStreamer(const espm::CombineBrowser& browser,
+                             size_t numFiles)
+  : pImpl(std::make_unique<Impl>())
+{
+  pImpl->browser = &browser;
+  pImpl->numFiles = numFiles;
+
+  auto p = pImpl.get();
+  pImpl->thr = std::make_unique<std::thread>([p] { p->ThreadMain(); });
+}
+
+ChunkStreamer::~ChunkStreamer()
+{
+  {
+    std::lock_guard l(pImpl->m);
+    pImpl->destroyed = true;
+  }
+  pImpl->cv.notify_one();
+  pImpl->thr->join();
+}
+
+void ChunkStreamer::Request(const ChunkKey& key)
+{
+  {
+    std::lock_guard l(pImpl->m);
+    pImpl->requested.push_back(key);
+    ++pImpl->numPending;
+  }
+  pImpl->cv.notify_one();
+}
+
+bool ChunkStreamer::TryPop(PreparedChunk& outChunk)
+{
+  std::lock_guard l(pImpl->m);
+  if (pImpl->ready.empty()) {
+    return false;
+  }
+  outChunk = std::move(pImpl->ready.front());
+  pImpl->ready.pop_front();
+  --pImpl->numPending;
+  return true;
+}
+
+size_t ChunkStreamer::GetNumPending() const
+{
+  std::lock_guard l(pImpl->m);
+  return pImpl->numPending;
+}
+
+void ChunkStreamer::Impl::ThreadMain()
+{
+  while (true) {
+    ChunkKey key;
+    {
+      std::unique_lock l(m);
+      cv.wait(l, [this] { return destroyed || !requested.empty(); });
+      if (destroyed) {
+        return;
+      }
+      key = requested.front();
+      requested.pop_front();
+    }
+
+    PreparedChunk chunk;
+    try {
+      chunk = Prepare(key);
+    } catch (std::exception& e) {
+      spdlog::error("ChunkStreamer - failed to prepare chunk {:x} ({}, {}): "
+                    "{}",
+                    key.cellOrWorld, key.x, key.y, e.what());
+      chunk.key = key;
+    }
+
+    std::lock_guard l(m);
+    ready.push_back(std::move(chunk));
+  }
+}
+
+ChunkStreamer::PreparedChunk ChunkStreamer::Impl::Prepare(const ChunkKey& key)
+{
+  PreparedChunk res;
+  res.key = key;
+
+  auto& br = *browser;
+  std::unordered_set<uint32_t> visited;
+
+  for (size_t i = 0; i < numFiles; ++i) {
+    auto combMapping = br.GetCombMapping(i);
+    auto rawMapping = br.GetRawMapping(i);
+    if (!combMapping || !rawMapping) {
+      continue;
+    }
+
+    uint32_t mappedCellOrWorld =
+      espm::utils::GetMappedId(key.cellOrWorld, *rawMapping);
+    auto recordsAtPos = br.GetRecordsAtPos(mappedCellOrWorld, key.x, key.y);
+    for (auto rec : *recordsAtPos[i]) {
+      auto formId = espm::utils::GetMappedId(rec->GetId(), *combMapping);
+      if (formId >= 0xff000000 || !visited.insert(formId).second) {
+        continue;
+      }
+
+      auto lookupRes = br.LookupById(formId);
+      if (lookupRes.rec && IsAttachCandidate(br, lookupRes, workerCache)) {
+        res.candidateFormIds.push_back(formId);
+      } else {
+        res.rejectedFormIds.push_back(formId);
+      }
+    }
+  }
+
+  return res;
+}
@@ -0,0 +1,57 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace espm {
+class CombineBrowser;
+}
+
+// Prepares ESP references of grid chunks on a background thread, so that the
+// tick thread only attaches references that can actually become forms.
+// Browser lookups are read-only, so the worker shares the CombineBrowser with
+// the tick thread but uses its own CompressedFieldsCache.
+class ChunkStreamer
+{
+public:
+  struct ChunkKey
+  {
+    uint32_t cellOrWorld = 0;
+    int16_t x = 0;
+    int16_t y = 0;
+  };
+
+  struct PreparedChunk
+  {
+    ChunkKey key;
+
+    // Winning (last in load order) references of this chunk whose records
+    // passed checks that don't depend on the world state: base type, initial
+    // flags, etc. Should still be passed to WorldState::LoadForm
+    std::vector<uint32_t> candidateFormIds;
+
+    // References that can never be attached
+    std::vector<uint32_t> rejectedFormIds;
+  };
+
+  ChunkStreamer(const espm::CombineBrowser& browser, size_t numFiles);
+  ~ChunkStreamer();
+
+  // Thread-safe. The caller is responsible for not requesting the same chunk
+  // twice
+  void Request(const ChunkKey& key);
+
+  // Thread-safe. Returns false if no chunk is ready yet
+  bool TryPop(PreparedChunk& outChunk);
+
+  // Thread-safe. Number of requested chunks that haven't been popped yet
+  size_t GetNumPending() const;
+
+private:
+  ChunkStreamer(const ChunkStreamer&) = delete;
+  ChunkStreamer& operator=(const ChunkStreamer&) = delete;
+
+  struct Impl;
+  std::unique_ptr<Impl> pImpl;
+};
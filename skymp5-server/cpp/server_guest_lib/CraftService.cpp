@@ -10,6 +10,7 @@
 #include <fmt/format.h>
 #include <fmt/ranges.h>
 #include <spdlog/spdlog.h>
+#include <stdexcept>
 #include <vector>
 
 CraftService::CraftService(PartOne& partOne_)
@@ -75,11 +76,58 @@ void CraftService::OnCraftItem(const RawMessageData& rawMsgData,
 bool CraftService::RecipeItemsMatch(const espm::LookupResult& lookupRes,
                                     const Inventory& inputObjects,
                                     uint32_t resultObjectId)
+{
+  auto recipe = IndexRecipe(lookupRes);
+  return recipe && recipe->resultObjectId == resultObjectId &&
+    InputObjectsMatch(*recipe, AggregateInventory(inputObjects));
+}
+
+void CraftService::IndexRecipes(const espm::CombineBrowser& br)
+{
+  recipesByResultObjectId.clear();
+  for (auto& lookupRes : br.GetDistinctRecordsByType("COBJ")) {
+    if (auto recipe = IndexRecipe(lookupRes)) {
+      recipesByResultObjectId[recipe->resultObjectId].push_back(
+        std::move(*recipe));
+    }
+  }
+  indexedBrowser = &br;
+}
+
+std::vector<espm::COBJ::InputObject> CraftService::AggregateInputObjects(
+  std::vector<espm::COBJ::InputObject> inputObjects)
+{
+  std::sort(inputObjects.begin(), inputObjects.end(),
+            [](const auto& a, const auto& b) { return a.formId < b.formId; });
+
+  std::vector<espm::COBJ::InputObject> res;
+  for (auto& entry : inputObjects) {
+    if (!res.empty() && res.back().formId == entry.formId) {
+      res.back().count += entry.count;
+    } else {
+      res.push_back(entry);
+    }
+  }
+  return res;
+}
+
+std::vector<espm::COBJ::InputObject> CraftService::AggregateInventory(
+  const Inventory& inputObjects)
+{
+  std::vector<espm::COBJ::InputObject> res;
+  res.reserve(inputObjects.entries.size());
+  for (auto& entry : inputObjects.entries) {
+    res.push_back({ entry.baseId, entry.count });
+  }
+  return AggregateInputObjects(std::move(res));
+}
+
+std::optional<CraftService::IndexedRecipe> CraftService::IndexRecipe(
+  const espm::LookupResult& lookupRes)
 {
   auto recipe = reinterpret_cast<const espm::COBJ*>(lookupRes.rec);
 
-  espm::CompressedFieldsCache dummyCache;
-  auto recipeData = recipe->GetData(dummyCache);
+  auto recipeData = recipe->GetData(lookupRes.parent->GetCache());
 
   enum
   {
@@ -89,20 +137,36 @@ bool CraftService::RecipeItemsMatch(const espm::LookupResult& lookupRes,
   const bool isTemper = recipeData.benchKeywordId == ArmorTable ||
     recipeData.benchKeywordId == SharpeningWheel;
   if (isTemper) {
-    return false;
+    return std::nullopt;
   }
 
-  auto thisInputObjects = recipeData.inputObjects;
-  for (auto& entry : thisInputObjects) {
-    auto formId = lookupRes.ToGlobalId(entry.formId);
-    if (inputObjects.GetItemCount(formId) != entry.count) {
+  for (auto& entry : recipeData.inputObjects) {
+    entry.formId = lookupRes.ToGlobalId(entry.formId);
+  }
+
+  IndexedRecipe res;
+  res.lookupRes = lookupRes;
+  res.inputObjects = AggregateInputObjects(std::move(recipeData.inputObjects));
+  res.resultObjectId = lookupRes.ToGlobalId(recipeData.outputObjectFormId);
+  return res;
+}
+
+bool CraftService::InputObjectsMatch(
+  const IndexedRecipe& recipe,
+  const std::vector<espm::COBJ::InputObject>& inputObjects)
+{
+  // Items that the recipe doesn't require are ignored
+  auto it = inputObjects.begin();
+  for (auto& entry : recipe.inputObjects) {
+    while (it != inputObjects.end() && it->formId < entry.formId) {
+      ++it;
+    }
+    uint32_t count =
+      it != inputObjects.end() && it->formId == entry.formId ? it->count : 0;
+    if (count != entry.count) {
       return false;
     }
   }
-  auto formId = lookupRes.ToGlobalId(recipeData.outputObjectFormId);
-  if (formId != resultObjectId) {
-    return false;
-  }
   return true;
 }
 
@@ -112,17 +176,27 @@ std::vector<espm::LookupResult> CraftService::FindRecipe(
   const espm::CombineBrowser& br, const Inventory& inputObjects,
   uint32_t resultObjectId)
 {
-  if (allRecipes.empty()) {
-    allRecipes = br.GetDistinctRecordsByType("COBJ");
+  if (indexedBrowser != &br) {
+    throw std::runtime_error(
+      "CraftService::FindRecipe - Recipes of this browser are not indexed");
   }
 
   std::vector<espm::LookupResult> candidatesConsideredUsable;
 
-  for (auto& recipe : allRecipes) {
-    if (!RecipeItemsMatch(recipe, inputObjects, resultObjectId)) {
+  auto it = recipesByResultObjectId.find(resultObjectId);
+  if (it == recipesByResultObjectId.end()) {
+    return candidatesConsideredUsable;
+  }
+
+  auto aggregatedInputObjects = AggregateInventory(inputObjects);
+
+  for (auto& indexedRecipe : it->second) {
+    if (!InputObjectsMatch(indexedRecipe, aggregatedInputObjects)) {
       continue;
     }
 
+    auto& recipe = indexedRecipe.lookupRes;
+
     spdlog::info("CraftService::FindRecipe - Recipe candidate found: {:x}",
                  recipe.ToGlobalId(recipe.rec->GetId()));
 
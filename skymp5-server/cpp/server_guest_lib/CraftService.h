@@ -2,6 +2,7 @@
 #include "libespm/Loader.h"
 #include <cstdint>
 #include <optional>
+#include <unordered_map>
 #include <vector>
 
 class PartOne;
@@ -23,6 +24,15 @@ public:
                         const Inventory& inputObjects,
                         uint32_t resultObjectId);
 
+  // Called by PartOne when the ESP is attached
+  void IndexRecipes(const espm::CombineBrowser& br);
+
+  // Sums counts of duplicate form ids and sorts by form id.
+  // public for CraftTest.cpp
+  static std::vector<espm::COBJ::InputObject> AggregateInputObjects(
+    std::vector<espm::COBJ::InputObject> inputObjects);
+
+  // Expects 'br' to be the browser passed to IndexRecipes.
   // public for CraftTest.cpp
   std::vector<espm::LookupResult> FindRecipe(
     std::optional<MpActor*> me,
@@ -31,6 +41,26 @@ public:
     uint32_t resultObjectId);
 
 private:
+  // Recipe with ids converted to global ones
+  struct IndexedRecipe
+  {
+    espm::LookupResult lookupRes;
+    std::vector<espm::COBJ::InputObject> inputObjects; // Aggregated
+    uint32_t resultObjectId = 0;
+  };
+
+  // std::nullopt for temper recipes, they are never matched
+  static std::optional<IndexedRecipe> IndexRecipe(
+    const espm::LookupResult& lookupRes);
+
+  static std::vector<espm::COBJ::InputObject> AggregateInventory(
+    const Inventory& inputObjects);
+
+  // Both arguments are aggregated
+  static bool InputObjectsMatch(
+    const IndexedRecipe& recipe,
+    const std::vector<espm::COBJ::InputObject>& inputObjects);
+
   bool ConsiderRecipeCandidate(
     std::optional<MpActor*> me,
     std::optional<std::vector<uint32_t>> workbenchKeywordIds,
@@ -44,6 +74,10 @@ private:
                                      const espm::COBJ::Data& recipeData);
 
   PartOne& partOne;
-  std::vector<espm::LookupResult> allRecipes;
   espm::CompressedFieldsCache cache;
+
+  // Recipes keep the load order within a result object
+  std::unordered_map<uint32_t, std::vector<IndexedRecipe>>
+    recipesByResultObjectId;
+  const espm::CombineBrowser* indexedBrowser = nullptr;
 };
@@ -0,0 +1,70 @@
+#include "EspmRefFilter.h"
+#include "libespm/ACHR.h"
+#include "libespm/FLOR.h"
+#include "libespm/TREE.h"
+#include "libespm/Utils.h"
+
+EspmRefFilter::Result EspmRefFilter::Check(
+  const espm::CombineBrowser& br, const espm::RecordHeader* record,
+  const espm::IdMapping& mapping, espm::CompressedFieldsCache& cache)
+{
+  // this place is a hotpath.
+  // we want to use reinterpret_cast<> instead of espm::Convert<>
+  // in order to reduce amount of generated assembly code
+  auto* refr = reinterpret_cast<const espm::REFR*>(record);
+
+  auto data = refr->GetData(cache);
+  uint32_t baseId = espm::utils::GetMappedId(data.baseId, mapping);
+  Result res{ Verdict::Accepted, std::move(data), baseId,
+              br.LookupById(baseId) };
+  if (!res.base.rec) {
+    res.verdict = Verdict::BaseNotFound;
+    return res;
+  }
+
+  espm::Type t = res.base.rec->GetType();
+  res.isNpc = t == "NPC_";
+  bool isFurniture = t == "FURN";
+  bool isActivator = t == "ACTI";
+  bool isDoor = t == "DOOR";
+  bool isContainer = t == "CONT";
+  bool isFlor = t == "FLOR" &&
+    reinterpret_cast<const espm::FLOR*>(res.base.rec)
+      ->GetData(cache)
+      .resultItem;
+  bool isTree = t == "TREE" &&
+    reinterpret_cast<const espm::TREE*>(res.base.rec)
+      ->GetData(cache)
+      .resultItem;
+
+  if (!res.isNpc && !isFurniture && !isActivator && !espm::utils::IsItem(t) &&
+      !isDoor && !isContainer && !isFlor && !isTree) {
+    res.verdict = Verdict::SkippedBaseType;
+    return res;
+  }
+
+  // TODO: Load dead references
+  if (res.isNpc && reinterpret_cast<const espm::ACHR*>(record)->StartsDead()) {
+    res.verdict = Verdict::StartsDead;
+    return res;
+  }
+
+  // TODO: Load disabled references
+  enum
+  {
+    InitiallyDisabled = 0x800,
+    DeletedRecord = 0x20
+  };
+
+  if (refr->GetFlags() & InitiallyDisabled) {
+    res.verdict = Verdict::InitiallyDisabled;
+    return res;
+  }
+
+  if (refr->GetFlags() & DeletedRecord) {
+    res.verdict = Verdict::Deleted;
+    return res;
+  }
+
+  return res;
+}
@@ -0,0 +1,34 @@
+#pragma once
+#include "libespm/CombineBrowser.h"
+#include "libespm/CompressedFieldsCache.h"
+#include "libespm/LookupResult.h"
+#include "libespm/REFR.h"
+
+// Checks of WorldState::AttachEspmRecord that only depend on ESP data, shared
+// with ChunkStreamer which runs them off the tick thread. Checks depending on
+// server settings or on the world state are left for AttachEspmRecord
+namespace EspmRefFilter {
+
+enum class Verdict
+{
+  Accepted,
+  BaseNotFound,
+  SkippedBaseType,
+  StartsDead,
+  InitiallyDisabled,
+  Deleted
+};
+
+struct Result
+{
+  Verdict verdict = Verdict::Accepted;
+  espm::REFR::Data data;
+  uint32_t baseId = 0;
+  espm::LookupResult base;
+  bool isNpc = false;
+};
+
+Result Check(const espm::CombineBrowser& br, const espm::RecordHeader* record,
+             const espm::IdMapping& mapping,
+             espm::CompressedFieldsCache& cache);
+}
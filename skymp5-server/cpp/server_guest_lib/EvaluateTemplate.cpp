@@ -0,0 +1,56 @@
+#include "EvaluateTemplate.h"
+#include <sstream>
+#include <stdexcept>
+
+void ThrowEvaluateTemplateError(WorldState* worldState, uint32_t baseId,
+                                const std::vector<FormDesc>& templateChain,
+                                uint16_t templateFlag)
+{
+  const std::vector<FormDesc> chainDefault = { FormDesc::FromFormId(
+    baseId, worldState->espmFiles) };
+  const std::vector<FormDesc>& chain =
+    templateChain.size() > 0 ? templateChain : chainDefault;
+
+  std::stringstream detailedLog;
+
+  for (auto it = chain.begin(); it != chain.end(); it++) {
+    auto templateChainElement = it->ToFormId(worldState->espmFiles);
+
+    detailedLog << "Processing FormDesc: " << it->ToString() << "\n";
+
+    auto npcLookupResult =
+      worldState->GetEspm().GetBrowser().LookupById(templateChainElement);
+    detailedLog << "Variable npcLookupResult: " << npcLookupResult.rec << "\n";
+
+    auto npc = espm::Convert<espm::NPC_>(npcLookupResult.rec);
+    detailedLog << "Variable npc: " << npc << "\n";
+
+    if (!npc) {
+      detailedLog << "Variable npc was nullptr, failing EvaluateTemplate\n";
+      break;
+    }
+
+    const auto& npcData =
+      worldState->GetEspm().GetDecodedRecordCache().Get(templateChainElement,
+                                                        npc);
+
+    detailedLog << "Variable npcData: baseTemplate=" << npcData.baseTemplate
+                << ", templateDataFlags=" << npcData.templateDataFlags << "\n";
+  }
+
+  std::stringstream ss;
+  ss << "EvaluateTemplate failed: baseId=" << std::hex << baseId
+     << ", templateChain=";
+
+  for (size_t i = 0; i < templateChain.size(); ++i) {
+    ss << templateChain[i].ToString();
+    if (i != templateChain.size() - 1) {
+      ss << ",";
+    }
+  }
+
+  ss << ", templateFlag=" << templateFlag;
+  ss << ", detailedLog=" << detailedLog.str();
+
+  throw std::runtime_error(ss.str());
+}
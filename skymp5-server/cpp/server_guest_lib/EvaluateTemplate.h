@@ -1,69 +1,38 @@
 #pragma once
 #include "FormDesc.h"
+#include "TemplateChainCache.h"
 #include "WorldState.h"
 #include "libespm/espm.h"
-#include <sstream>
-#include <stdexcept>
+#include <optional>
+#include <string>
+#include <type_traits>
 #include <vector>
 
+// Walks the chain again, this time logging every step. Only called once
+// EvaluateTemplate is known to fail, so the happy path doesn't pay for logs
+[[noreturn]] void ThrowEvaluateTemplateError(
+  WorldState* worldState, uint32_t baseId,
+  const std::vector<FormDesc>& templateChain, uint16_t templateFlag);
+
+// Callbacks may return references to npcData, they stay valid for the
+// lifetime of the Loader
 template <uint16_t TemplateFlag, class Callback>
-auto EvaluateTemplate(WorldState* worldState, uint32_t baseId,
+decltype(auto) EvaluateTemplate(WorldState* worldState, uint32_t baseId,
                       const std::vector<FormDesc>& templateChain,
                       const Callback& callback)
 {
-  const std::vector<FormDesc> chainDefault = { FormDesc::FromFormId(
-    baseId, worldState->espmFiles) };
-  const std::vector<FormDesc>& chain =
-    templateChain.size() > 0 ? templateChain : chainDefault;
-
-  std::stringstream detailedLog;
-
-  for (auto it = chain.begin(); it != chain.end(); it++) {
-    auto templateChainElement = it->ToFormId(worldState->espmFiles);
-
-    detailedLog << "Processing FormDesc: " << it->ToString() << "\n";
-
-    auto npcLookupResult =
-      worldState->GetEspm().GetBrowser().LookupById(templateChainElement);
-    detailedLog << "Variable npcLookupResult: " << npcLookupResult.rec << "\n";
-
-    auto npc = espm::Convert<espm::NPC_>(npcLookupResult.rec);
-    detailedLog << "Variable npc: " << npc << "\n";
-
-    if (!npc) {
-      detailedLog << "Variable npc was nullptr, failing EvaluateTemplate\n";
-      break;
-    }
-
-    auto npcData = npc->GetData(worldState->GetEspmCache());
+  static_assert(TemplateChainCache::GetFlagIndex(TemplateFlag).has_value());
 
-    detailedLog << "Variable npcData: baseTemplate=" << npcData.baseTemplate
-                << ", templateDataFlags=" << npcData.templateDataFlags << "\n";
+  const auto& resolution = worldState->GetTemplateChainCache().Resolve(
+    worldState, baseId, templateChain);
 
-    if (npcData.baseTemplate == 0) {
-      return callback(npcLookupResult, npcData);
-    }
-
-    if (!(npcData.templateDataFlags & TemplateFlag)) {
-      return callback(npcLookupResult, npcData);
-    }
-  }
-
-  std::stringstream ss;
-  ss << "EvaluateTemplate failed: baseId=" << std::hex << baseId
-     << ", templateChain=";
-
-  for (size_t i = 0; i < templateChain.size(); ++i) {
-    ss << templateChain[i].ToString();
-    if (i != templateChain.size() - 1) {
-      ss << ",";
-    }
+  auto source = resolution.FindSource(TemplateFlag);
+  if (!source) {
+    ThrowEvaluateTemplateError(worldState, baseId, templateChain,
+                               TemplateFlag);
   }
 
-  ss << ", templateFlag=" << TemplateFlag;
-  ss << ", detailedLog=" << detailedLog.str();
-
-  throw std::runtime_error(ss.str());
+  return callback(source->lookupResult, *source->data);
 }
 
 template <uint16_t TemplateFlag, class Callback>
@@ -72,8 +41,9 @@ auto EvaluateTemplateNoThrow(WorldState* worldState, uint32_t baseId,
                              const Callback& callback,
                              std::string* outException)
 {
-  using ResultType = decltype(EvaluateTemplate<TemplateFlag, Callback>(
-    worldState, baseId, templateChain, callback));
+  using ResultType =
+    std::decay_t<decltype(EvaluateTemplate<TemplateFlag, Callback>(
+      worldState, baseId, templateChain, callback))>;
   std::optional<ResultType> result;
 
   try {
@@ -1,6 +1,7 @@
 #pragma once
 #include "MessageBase.h"
 #include "NetworkingInterface.h"
+#include "SerializedMessage.h"
 #include <functional>
 
 class MpObjectReference;
@@ -20,15 +21,25 @@ public:
 
   using GetUserIdFn = std::function<Networking::UserId(MpActor* actor)>;
 
+  using SerializeMessageFn =
+    std::function<SerializedMessage(const IMessageBase& message)>;
+
+  using SendSerializedToUserFn = std::function<void(
+    MpActor* actor, const SerializedMessage& message, bool reliable)>;
+
   SubscribeCallback subscribe, unsubscribe;
   SendToUserFn sendToUser;
   SendToUserDeferredFn sendToUserDeferred;
   GetUserIdFn getUserId;
+  SerializeMessageFn serializeMessage;
+  SendSerializedToUserFn sendSerializedToUser;
 
   static FormCallbacks DoNothing()
   {
     return { [](auto, auto) {}, [](auto, auto) {}, [](auto, auto&, auto) {},
              [](auto, auto&, auto, auto, auto) {},
-             [](auto) { return Networking::InvalidUserId; } };
+             [](auto) { return Networking::InvalidUserId; },
+             [](auto&) { return SerializedMessage(); },
+             [](auto, auto&, auto) {} };
   }
 };
@@ -1,5 +1,6 @@
 #include "GetBaseActorValues.h"
 #include "EvaluateTemplate.h"
+#include "TemplateChainCache.h"
 #include "WorldState.h"
 #include <spdlog/spdlog.h>
 
@@ -26,8 +27,17 @@ BaseActorValues GetBaseActorValues(WorldState* worldState, uint32_t baseId,
                                    uint32_t raceIdOverride,
                                    const std::vector<FormDesc>& templateChain)
 {
+  // Only depends on ESP data, so the result is memoized per template chain
+  auto& resolution = worldState->GetTemplateChainCache().Resolve(
+    worldState, baseId, templateChain);
+  if (auto it = resolution.baseActorValues.find(raceIdOverride);
+      it != resolution.baseActorValues.end()) {
+    BaseActorValues actorValues;
+    static_cast<ActorValues&>(actorValues) = it->second;
+    return actorValues;
+  }
 
-  auto npcData = espm::GetData<espm::NPC_>(baseId, worldState);
+  const auto& npcData = espm::GetData<espm::NPC_>(baseId, worldState);
 
   uint32_t raceId = raceIdOverride
     ? raceIdOverride
@@ -36,11 +46,14 @@ BaseActorValues GetBaseActorValues(WorldState* worldState, uint32_t baseId,
         [](const auto& npcLookupResult, const auto& npcData) {
           return npcLookupResult.ToGlobalId(npcData.race);
         });
-  auto raceData = espm::GetData<espm::RACE>(raceId, worldState);
+  const auto& raceData = espm::GetData<espm::RACE>(raceId, worldState);
 
-  espm::NPC_::Data attributesNpcData = EvaluateTemplate<espm::NPC_::UseStats>(
-    worldState, baseId, templateChain,
-    [](const auto&, const auto& npcData) { return npcData; });
+  const espm::NPC_::Data& attributesNpcData =
+    EvaluateTemplate<espm::NPC_::UseStats>(
+      worldState, baseId, templateChain,
+      [](const auto&, const auto& npcData) -> const espm::NPC_::Data& {
+        return npcData;
+      });
 
   BaseActorValues actorValues;
 
@@ -83,5 +96,6 @@ BaseActorValues GetBaseActorValues(WorldState* worldState, uint32_t baseId,
     baseId, raceIdOverride, raceData.startingHealth,
     attributesNpcData.healthOffset);
 
+  resolution.baseActorValues[raceIdOverride] = actorValues;
   return actorValues;
 }
@@ -0,0 +1,164 @@
+#include "LeveledListCache.h"
+#include <algorithm>
+
+namespace {
+bool IsLeveledType(const espm::LookupResult& lookupRes) noexcept
+{
+  espm::Type type = lookupRes.rec->GetType();
+  return type == espm::LVLI::kType || type == espm::LVLN::kType ||
+    type == "LVSP" /* for the future leveled spell implementation */;
+}
+}
+
+LeveledListCache::LeveledListCache(const espm::CombineBrowser& br_)
+  : br(br_)
+{
+}
+
+auto LeveledListCache::GetCompiledList(const espm::LookupResult& lookupRes)
+  -> const CompiledList*
+{
+  return Compile(lookupRes);
+}
+
+auto LeveledListCache::Compile(const espm::LookupResult& lookupRes)
+  -> CompiledList*
+{
+  if (!lookupRes.rec || !IsLeveledType(lookupRes)) {
+    return nullptr;
+  }
+
+  auto [it, inserted] = lists.try_emplace(lookupRes.rec);
+  CompiledList& res = it->second;
+  if (!inserted) {
+    return &res;
+  }
+
+  auto leveledList =
+    reinterpret_cast<const espm::LeveledListBase*>(lookupRes.rec);
+  auto data = leveledList->GetData(br.GetCache());
+
+  res.chanceNone = data.chanceNoneGlobalId ? 100 : data.chanceNone;
+  res.useAll = data.leveledItemFlags & espm::LeveledListBase::UseAll;
+  res.calcForEach = data.leveledItemFlags & espm::LeveledListBase::Each;
+
+  res.entries.reserve(data.numEntries);
+  for (size_t i = 0; i < data.numEntries; ++i) {
+    CompiledEntry entry;
+    entry.formId = lookupRes.ToGlobalId(data.entries[i].formId);
+    entry.count = data.entries[i].count;
+    entry.level = data.entries[i].level;
+    res.entries.push_back(entry);
+  }
+  std::stable_sort(res.entries.begin(), res.entries.end(),
+                   [](const CompiledEntry& a, const CompiledEntry& b) {
+                     return a.level < b.level;
+                   });
+  return &res;
+}
+
+std::vector<LeveledListUtils::Entry> LeveledListCache::EvaluateList(
+  const espm::LookupResult& lookupRes, std::mt19937& rng, uint32_t pcLevel,
+  uint8_t* chanceNoneOverride)
+{
+  auto list = Compile(lookupRes);
+  if (!list) {
+    return {};
+  }
+
+  std::vector<LeveledListUtils::Entry> res;
+  auto [begin, end] = Choose(*list, rng, pcLevel, chanceNoneOverride);
+  for (size_t i = begin; i < end; ++i) {
+    res.push_back({ list->entries[i].formId, list->entries[i].count });
+  }
+  return res;
+}
+
+std::map<uint32_t, uint32_t> LeveledListCache::EvaluateListRecurse(
+  const espm::LookupResult& lookupRes, std::mt19937& rng, uint32_t countMult,
+  uint32_t pcLevel, uint8_t* chanceNoneOverride)
+{
+  std::map<uint32_t, uint32_t> res;
+
+  auto list = Compile(lookupRes);
+  if (!list) {
+    return res;
+  }
+
+  if (list->calcForEach && countMult != 1) {
+    for (uint32_t i = 0; i < countMult; ++i) {
+      AddRecurse(*list, rng, pcLevel, nullptr, res);
+    }
+    return res;
+  }
+
+  AddRecurse(*list, rng, pcLevel, chanceNoneOverride, res);
+
+  if (countMult != 1) {
+    for (auto& p : res) {
+      p.second *= countMult;
+    }
+  }
+  return res;
+}
+
+size_t LeveledListCache::GetSize() const noexcept
+{
+  return lists.size();
+}
+
+std::pair<size_t, size_t> LeveledListCache::Choose(
+  const CompiledList& list, std::mt19937& rng, uint32_t pcLevel,
+  uint8_t* chanceNoneOverride)
+{
+  int chanceNone = chanceNoneOverride ? *chanceNoneOverride : list.chanceNone;
+  if (chanceNone > 0) {
+    std::uniform_real_distribution<double> dist(0.0, 100.0);
+    if (dist(rng) < chanceNone) {
+      return { 0, 0 };
+    }
+  }
+
+  size_t numAllowed = list.entries.size();
+  if (pcLevel) {
+    numAllowed =
+      std::upper_bound(list.entries.begin(), list.entries.end(), pcLevel,
+                       [](uint32_t level, const CompiledEntry& entry) {
+                         return level < entry.level;
+                       }) -
+      list.entries.begin();
+  }
+
+  if (!list.useAll && numAllowed > 0) {
+    std::uniform_int_distribution<size_t> dist(0, numAllowed - 1);
+    auto i = dist(rng);
+    return { i, i + 1 };
+  }
+  return { 0, numAllowed };
+}
+
+void LeveledListCache::AddRecurse(CompiledList& list, std::mt19937& rng,
+                                  uint32_t pcLevel,
+                                  uint8_t* chanceNoneOverride,
+                                  std::map<uint32_t, uint32_t>& res)
+{
+  auto [begin, end] = Choose(list, rng, pcLevel, chanceNoneOverride);
+  for (size_t i = begin; i < end; ++i) {
+    auto& entry = list.entries[i];
+    if (!entry.resolved) {
+      auto entryLookupRes = br.LookupById(entry.formId);
+      entry.exists = entryLookupRes.rec != nullptr;
+      entry.leveledList = Compile(entryLookupRes);
+      entry.resolved = true;
+    }
+
+    if (!entry.exists) {
+      continue;
+    }
+    if (entry.leveledList) {
+      AddRecurse(*entry.leveledList, rng, pcLevel, nullptr, res);
+    } else {
+      res[entry.formId] += entry.count;
+    }
+  }
+}
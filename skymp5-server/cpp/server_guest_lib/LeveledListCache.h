@@ -0,0 +1,81 @@
+#pragma once
+#include "LeveledListUtils.h"
+#include "libespm/Combiner.h"
+#include "libespm/espm.h"
+#include <cstdint>
+#include <map>
+#include <random>
+#include <unordered_map>
+#include <vector>
+
+// Leveled lists compiled for evaluation: record data decoded once, form ids
+// converted to global ones. Entries are sorted by level, so entries allowed
+// for a pc level are a prefix of the table. Lists are compiled on first use,
+// nested lists are resolved on first evaluation of the entry. Results only
+// depend on ESP data, so WorldState drops the cache in AttachEspm and nowhere
+// else.
+// Randomness comes from the caller, see WorldState::GetRandomEngine
+class LeveledListCache
+{
+public:
+  struct CompiledList;
+
+  struct CompiledEntry
+  {
+    uint32_t formId = 0;
+    uint32_t count = 0;
+    uint32_t level = 0;
+
+    // Fields below are only valid after resolving
+    bool resolved = false;
+
+    // false if there is no record with formId
+    bool exists = false;
+
+    // Non-null for nested leveled lists
+    CompiledList* leveledList = nullptr;
+  };
+
+  struct CompiledList
+  {
+    int chanceNone = 0;
+    bool useAll = false;
+    bool calcForEach = false;
+    std::vector<CompiledEntry> entries;
+  };
+
+  explicit LeveledListCache(const espm::CombineBrowser& br);
+
+  // nullptr if lookupRes is not a leveled list
+  const CompiledList* GetCompiledList(const espm::LookupResult& lookupRes);
+
+  // See LeveledListUtils for the meaning of arguments
+  std::vector<LeveledListUtils::Entry> EvaluateList(
+    const espm::LookupResult& lookupRes, std::mt19937& rng,
+    uint32_t pcLevel = 0, uint8_t* chanceNoneOverride = nullptr);
+
+  std::map<uint32_t, uint32_t> EvaluateListRecurse(
+    const espm::LookupResult& lookupRes, std::mt19937& rng,
+    uint32_t countMult = 1, uint32_t pcLevel = 0,
+    uint8_t* chanceNoneOverride = nullptr);
+
+  size_t GetSize() const noexcept;
+
+private:
+  CompiledList* Compile(const espm::LookupResult& lookupRes);
+
+  // Range of entries chosen by a single evaluation, see
+  // LeveledListUtils::EvaluateList
+  static std::pair<size_t, size_t> Choose(const CompiledList& list,
+                                          std::mt19937& rng, uint32_t pcLevel,
+                                          uint8_t* chanceNoneOverride);
+
+  void AddRecurse(CompiledList& list, std::mt19937& rng, uint32_t pcLevel,
+                  uint8_t* chanceNoneOverride,
+                  std::map<uint32_t, uint32_t>& res);
+
+  const espm::CombineBrowser& br;
+
+  // Node-based, so pointers to values stay valid
+  std::unordered_map<const espm::RecordHeader*, CompiledList> lists;
+};
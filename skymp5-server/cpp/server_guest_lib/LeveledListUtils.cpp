@@ -1,16 +1,16 @@
 #include "LeveledListUtils.h"
 #include "EvaluateTemplate.h"
+#include "LeveledListCache.h"
 #include <optional>
 #include <random>
 #include <spdlog/spdlog.h>
 #include <stdexcept>
 
 namespace {
-bool IsLeveledType(const espm::LookupResult& lookupRes) noexcept
+std::mt19937& GetThreadRandomEngine()
 {
-  espm::Type type = lookupRes.rec->GetType();
-  return type == espm::LVLI::kType || type == espm::LVLN::kType ||
-    type == "LVSP" /* for the future leveled spell implementation */;
+  thread_local std::mt19937 g_engine{ std::random_device{}() };
+  return g_engine;
 }
 }
 
@@ -18,108 +18,17 @@ std::vector<LeveledListUtils::Entry> LeveledListUtils::EvaluateList(
   const espm::CombineBrowser& br, const espm::LookupResult& lookupRes,
   uint32_t pcLevel, uint8_t* chanceNoneOverride)
 {
-  espm::CompressedFieldsCache dummyCache;
-
-  const espm::LeveledListBase* leveledList = nullptr;
-  if (IsLeveledType(lookupRes)) {
-    leveledList =
-      reinterpret_cast<const espm::LeveledListBase*>(lookupRes.rec);
-  }
-  if (!leveledList) {
-    return {};
-  }
-  auto data = leveledList->GetData(dummyCache);
-
-  std::vector<Entry> res;
-
-  int chanceNone = data.chanceNoneGlobalId ? 100 : data.chanceNone;
-  if (chanceNoneOverride) {
-    chanceNone = *chanceNoneOverride;
-  }
-
-  std::uniform_real_distribution<double> dist(0.0, 100.0);
-
-  std::random_device rd;
-  std::mt19937 mt(rd());
-  bool none = dist(mt) < chanceNone;
-  if (!none) {
-    std::vector<const espm::LeveledListBase::Entry*> entriesAllowed;
-    for (size_t i = 0; i < data.numEntries; ++i) {
-      if (!pcLevel || data.entries[i].level <= pcLevel) {
-        entriesAllowed.push_back(&data.entries[i]);
-      }
-    }
-
-    bool useRandomEntry =
-      !(data.leveledItemFlags & espm::LeveledListBase::UseAll);
-    if (useRandomEntry && !entriesAllowed.empty()) {
-      std::uniform_int_distribution<int> dist(0, entriesAllowed.size() - 1);
-      auto entry = entriesAllowed[dist(mt)];
-
-      uint32_t formId = lookupRes.ToGlobalId(entry->formId);
-      res.push_back({ formId, entry->count });
-    } else {
-      for (auto entry : entriesAllowed) {
-        uint32_t formId = lookupRes.ToGlobalId(entry->formId);
-        res.push_back({ formId, entry->count });
-      }
-    }
-  }
-  return res;
+  return LeveledListCache(br).EvaluateList(lookupRes, GetThreadRandomEngine(),
+                                           pcLevel, chanceNoneOverride);
 }
 
 std::map<uint32_t, uint32_t> LeveledListUtils::EvaluateListRecurse(
   const espm::CombineBrowser& br, const espm::LookupResult& lookupRes,
   uint32_t countMult, uint32_t pcLevel, uint8_t* chanceNoneOverride)
 {
-  espm::CompressedFieldsCache dummyCache;
-
-  const espm::LeveledListBase* leveledList = nullptr;
-  if (IsLeveledType(lookupRes)) {
-    leveledList =
-      reinterpret_cast<const espm::LeveledListBase*>(lookupRes.rec);
-  }
-
-  bool calcForEach = leveledList &&
-    (leveledList->GetData(dummyCache).leveledItemFlags &
-     espm::LeveledListBase::Each);
-
-  if (calcForEach && countMult != 1) {
-    std::map<uint32_t, uint32_t> res;
-    for (uint32_t i = 0; i < countMult; ++i) {
-      auto stepRes = EvaluateListRecurse(br, lookupRes, 1, pcLevel);
-      for (auto& p : stepRes) {
-        res[p.first] += p.second;
-      }
-    }
-    return res;
-  }
-
-  std::map<uint32_t, uint32_t> res;
-  auto firstEvalRes = EvaluateList(br, lookupRes, pcLevel, chanceNoneOverride);
-  for (auto& e : firstEvalRes) {
-    auto eLookupRes = br.LookupById(e.formId);
-    if (!eLookupRes.rec) {
-      continue;
-    }
-    if (IsLeveledType(eLookupRes)) {
-      auto childRes = EvaluateListRecurse(br, eLookupRes, 1, pcLevel);
-      for (auto& p : childRes) {
-        res[p.first] += p.second;
-      }
-
-    } else {
-      res[e.formId] += e.count;
-    }
-  }
-
-  if (countMult != 1 && !calcForEach) {
-    for (auto& p : res) {
-      p.second *= countMult;
-    }
-  }
-
-  return res;
+  return LeveledListCache(br).EvaluateListRecurse(
+    lookupRes, GetThreadRandomEngine(), countMult, pcLevel,
+    chanceNoneOverride);
 }
 
 std::vector<uint32_t> LeveledListUtils::EvaluateTemplateChain(
@@ -166,8 +75,7 @@ uint32_t LeveledListUtils::GetBaseTemplateId(
   const espm::NPC_* cursor, uint32_t fileIdx,
   const espm::CombineBrowser& browser)
 {
-  espm::CompressedFieldsCache dummyCache;
-  auto data = cursor->GetData(dummyCache);
+  auto data = cursor->GetData(browser.GetCache());
   if (!data.baseTemplate) {
     return 0; // Indicates there's no base template
   }
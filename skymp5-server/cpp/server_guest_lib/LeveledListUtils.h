@@ -16,6 +16,8 @@ public:
 
   // It seems that pcLevel=0 makes it thinking that pcLevel=maximum possible pc
   // level
+  // These overloads compile visited lists on every call and use a thread
+  // local random engine. Prefer WorldState::GetLeveledListCache in the server
   static std::vector<Entry> EvaluateList(
     const espm::CombineBrowser& br, const espm::LookupResult& lookupRes,
     uint32_t pcLevel = 0, uint8_t* chanceNoneOverride = nullptr);
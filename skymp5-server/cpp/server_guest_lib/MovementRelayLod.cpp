@@ -0,0 +1,99 @@
+#include "MovementRelayLod.h"
+#include <cmath>
+
+uint64_t MovementRelayLod::GetDiscreteState(
+  const UpdateMovementMessage::Data& data)
+{
+  uint64_t runMode = 0;
+  if (data.runMode == "Walking") {
+    runMode = 1;
+  } else if (data.runMode == "Running") {
+    runMode = 2;
+  } else if (data.runMode == "Sprinting") {
+    runMode = 3;
+  } else if (data.runMode != "Standing") {
+    runMode = 4;
+  }
+
+  uint64_t flags = (data.isInJumpState ? 1 : 0) |
+    (data.isSneaking ? 2 : 0) | (data.isBlocking ? 4 : 0) |
+    (data.isWeapDrawn ? 8 : 0) | (data.isDead ? 16 : 0) |
+    (data.lookAt ? 32 : 0);
+
+  return (static_cast<uint64_t>(data.worldOrCell) << 32) | (runMode << 8) |
+    flags;
+}
+
+std::chrono::milliseconds MovementRelayLod::GetMinInterval(
+  const NiPoint3& listenerPos, const NiPoint3& listenerViewDirection,
+  const NiPoint3& sourcePos, bool isHostedNpc) const
+{
+  NiPoint3 toSource = sourcePos - listenerPos;
+  toSource.z = 0;
+
+  float sqrDistance = toSource.SqrLength();
+  if (sqrDistance <= settings.fullRateDistance * settings.fullRateDistance) {
+    return std::chrono::milliseconds(0);
+  }
+
+  if (isHostedNpc) {
+    static const float kDegreesToRadians = std::acos(-1.f) / 180.f;
+    float minCos =
+      std::cos(settings.facingHalfAngleDegrees * kDegreesToRadians);
+
+    // Both vectors are horizontal, view direction is normalized
+    float dot = toSource.x * listenerViewDirection.x +
+      toSource.y * listenerViewDirection.y;
+    bool isFacing = dot >= minCos * std::sqrt(sqrDistance);
+    if (!isFacing) {
+      return settings.heartbeatInterval;
+    }
+  }
+
+  return settings.reducedRateInterval;
+}
+
+bool MovementRelayLod::ShouldRelay(RelayState& relayState,
+                                   uint64_t discreteState,
+                                   std::chrono::milliseconds minInterval,
+                                   Clock::time_point now) const
+{
+  bool relay = !settings.enabled || !relayState.relayed ||
+    relayState.discreteState != discreteState ||
+    now - relayState.lastRelayed >= minInterval;
+
+  if (relay) {
+    relayState.lastRelayed = now;
+    relayState.discreteState = discreteState;
+    relayState.relayed = true;
+    relayState.heldBack.reset();
+  }
+  return relay;
+}
+
+bool MovementRelayLod::HoldBack(RelayState& relayState,
+                                const UpdateMovementMessage& message,
+                                std::chrono::milliseconds minInterval)
+{
+  bool scheduled = relayState.heldBack.has_value();
+  relayState.heldBack = message;
+  if (!scheduled) {
+    relayState.heldBackDue = relayState.lastRelayed + minInterval;
+  }
+  return !scheduled;
+}
+
+std::optional<UpdateMovementMessage> MovementRelayLod::TakeHeldBack(
+  RelayState& relayState, Clock::time_point now)
+{
+  if (!relayState.heldBack || now < relayState.heldBackDue) {
+    return std::nullopt;
+  }
+
+  std::optional<UpdateMovementMessage> res;
+  res.swap(relayState.heldBack);
+  relayState.lastRelayed = now;
+  relayState.discreteState = GetDiscreteState(res->data);
+  relayState.relayed = true;
+  return res;
+}
@@ -0,0 +1,71 @@
+#pragma once
+#include "NiPoint3.h"
+#include "UpdateMovementMessage.h"
+#include <chrono>
+#include <cstdint>
+#include <optional>
+
+// Decides how often movement of an actor is relayed to each listener.
+// Listeners within fullRateDistance get every update, farther ones in the
+// 3x3 grid neighbourhood get reducedRateInterval, listeners not facing a
+// hosted NPC get heartbeatInterval. Changes of run mode, flags or cell are
+// relayed at once regardless of the tier. The latest movement held back by
+// the interval is relayed once the interval expires, so listeners never keep
+// a stale position of an actor that stopped
+class MovementRelayLod
+{
+public:
+  using Clock = std::chrono::steady_clock;
+
+  struct Settings
+  {
+    bool enabled = true;
+    float fullRateDistance = 4096.f;
+    std::chrono::milliseconds reducedRateInterval{ 250 };
+    std::chrono::milliseconds heartbeatInterval{ 1000 };
+
+    // Half of the listener's view cone used for the NPC heartbeat tier
+    float facingHalfAngleDegrees = 75.f;
+  };
+
+  // Movement of one actor as last relayed to one listener
+  struct RelayState
+  {
+    Clock::time_point lastRelayed;
+    uint64_t discreteState = 0;
+    bool relayed = false;
+
+    // Latest movement that wasn't relayed and the time to relay it at
+    std::optional<UpdateMovementMessage> heldBack;
+    Clock::time_point heldBackDue;
+  };
+
+  const Settings& GetSettings() const noexcept { return settings; }
+  void SetSettings(const Settings& newSettings) { settings = newSettings; }
+
+  // Cell, run mode and flags packed into a single value
+  static uint64_t GetDiscreteState(const UpdateMovementMessage::Data& data);
+
+  std::chrono::milliseconds GetMinInterval(
+    const NiPoint3& listenerPos, const NiPoint3& listenerViewDirection,
+    const NiPoint3& sourcePos, bool isHostedNpc) const;
+
+  // Updates relayState if the movement should be relayed now
+  bool ShouldRelay(RelayState& relayState, uint64_t discreteState,
+                   std::chrono::milliseconds minInterval,
+                   Clock::time_point now) const;
+
+  // Keeps the movement ShouldRelay rejected. Returns true if nothing was held
+  // back before, so the caller has to relay relayState.heldBack at
+  // relayState.heldBackDue
+  static bool HoldBack(RelayState& relayState,
+                       const UpdateMovementMessage& message,
+                       std::chrono::milliseconds minInterval);
+
+  // Returns the held back movement if it's due and marks it relayed
+  static std::optional<UpdateMovementMessage> TakeHeldBack(
+    RelayState& relayState, Clock::time_point now);
+
+private:
+  Settings settings;
+};
@@ -6,6 +6,7 @@
 #include "EvaluateTemplate.h"
 #include "FormCallbacks.h"
 #include "GetBaseActorValues.h"
+#include "LeveledListCache.h"
 #include "LeveledListUtils.h"
 #include "LocationalDataUtils.h"
 #include "MathUtils.h"
@@ -14,6 +15,7 @@
 #include "ServerState.h"
 #include "SpSnippet.h"
 #include "SpSnippetFunctionGen.h"
+#include "TemplateChainCache.h"
 #include "WorldState.h"
 #include "gamemode_events/DeathEvent.h"
 #include "gamemode_events/DropItemEvent.h"
@@ -186,9 +188,7 @@ void MpActor::EquipBestWeapon()
   UpdateEquipmentMessage msg;
   msg.data = newEq;
   msg.idx = GetIdx();
-  for (auto listener : GetActorListeners()) {
-    listener->GetActorToSendTo().SendToUser(msg, true);
-  }
+  SendMessageToActorListeners(msg, true);
 }
 
 void MpActor::AddSpell(const uint32_t spellId)
@@ -224,18 +224,21 @@ void MpActor::SetRaceMenuOpen(bool isOpen)
 
 void MpActor::SetAppearance(const Appearance* newAppearance)
 {
-  EditChangeForm([&](MpChangeForm& changeForm) {
-    if (newAppearance)
-      changeForm.appearanceDump = newAppearance->ToJson();
-    else
-      changeForm.appearanceDump.clear();
-  });
+  EditChangeForm(
+    [&](MpChangeForm& changeForm) {
+      if (newAppearance)
+        changeForm.appearanceDump = newAppearance->ToJson();
+      else
+        changeForm.appearanceDump.clear();
+    },
+    Mode::RequestSave, MpChangeFormField::Appearance);
 }
 
 void MpActor::SetEquipment(const Equipment& newEquipment)
 {
   EditChangeForm(
-    [&](MpChangeForm& changeForm) { changeForm.equipment = newEquipment; });
+    [&](MpChangeForm& changeForm) { changeForm.equipment = newEquipment; },
+    Mode::RequestSave, MpChangeFormField::Equipment);
 }
 
 void MpActor::SetHealthRespawnPercentage(float percentage)
@@ -425,6 +428,15 @@ void MpActor::SendToUser(const IMessageBase& message, bool reliable)
   }
 }
 
+void MpActor::SendToUser(const SerializedMessage& message, bool reliable)
+{
+  if (callbacks->sendSerializedToUser) {
+    callbacks->sendSerializedToUser(this, message, reliable);
+  } else {
+    throw std::runtime_error("sendSerializedToUser is nullptr");
+  }
+}
+
 void MpActor::SendToUserDeferred(const IMessageBase& message, bool reliable,
                                  int deferredChannelId,
                                  bool overwritePreviousChannelMessages)
@@ -653,21 +665,23 @@ void MpActor::SetPercentage(espm::ActorValue av, float percentage)
     Kill(nullptr);
     return;
   }
-  EditChangeForm([&](MpChangeForm& changeForm) {
-    switch (av) {
-      case espm::ActorValue::Health:
-        changeForm.actorValues.healthPercentage = percentage;
-        break;
-      case espm::ActorValue::Magicka:
-        changeForm.actorValues.magickaPercentage = percentage;
-        break;
-      case espm::ActorValue::Stamina:
-        changeForm.actorValues.staminaPercentage = percentage;
-        break;
-      default:
-        break;
-    }
-  });
+  EditChangeForm(
+    [&](MpChangeForm& changeForm) {
+      switch (av) {
+        case espm::ActorValue::Health:
+          changeForm.actorValues.healthPercentage = percentage;
+          break;
+        case espm::ActorValue::Magicka:
+          changeForm.actorValues.magickaPercentage = percentage;
+          break;
+        case espm::ActorValue::Stamina:
+          changeForm.actorValues.staminaPercentage = percentage;
+          break;
+        default:
+          break;
+      }
+    },
+    Mode::RequestSave, MpChangeFormField::ActorValues);
 
   // Updating timestamp. Note: calling this multiple times for different AVs
   // is fine but might be slightly inefficient if batched.
@@ -684,11 +698,15 @@ void MpActor::SetPercentages(const ActorValues& actorValues,
     Kill(aggressor);
     return;
   }
-  EditChangeForm([&](MpChangeForm& changeForm) {
-    changeForm.actorValues.healthPercentage = actorValues.healthPercentage;
-    changeForm.actorValues.magickaPercentage = actorValues.magickaPercentage;
-    changeForm.actorValues.staminaPercentage = actorValues.staminaPercentage;
-  });
+  EditChangeForm(
+    [&](MpChangeForm& changeForm) {
+      changeForm.actorValues.healthPercentage = actorValues.healthPercentage;
+      changeForm.actorValues.magickaPercentage =
+        actorValues.magickaPercentage;
+      changeForm.actorValues.staminaPercentage =
+        actorValues.staminaPercentage;
+    },
+    Mode::RequestSave, MpChangeFormField::ActorValues);
   SetLastAttributesPercentagesUpdate(std::chrono::steady_clock::now());
 }
 
@@ -852,12 +870,12 @@ bool MpActor::IsSpellLearnedFromBase(const uint32_t spellId) const
 {
   // TODO: support npc templates here?
 
-  const auto npcData = espm::GetData<espm::NPC_>(GetBaseId(), GetParent());
+  const auto& npcData = espm::GetData<espm::NPC_>(GetBaseId(), GetParent());
   const auto npc = GetParent()->GetEspm().GetBrowser().LookupById(GetBaseId());
 
   const uint32_t raceId = npc.ToGlobalId(npcData.race);
 
-  const auto raceData = espm::GetData<espm::RACE>(raceId, GetParent());
+  const auto& raceData = espm::GetData<espm::RACE>(raceId, GetParent());
   const auto race = GetParent()->GetEspm().GetBrowser().LookupById(raceId);
 
   for (auto npcSpellRaw : npcData.spells) {
@@ -1092,68 +1110,17 @@ void MpActor::EnsureTemplateChainEvaluated(espm::Loader& loader,
   const auto& templateChain = ChangeForm().templateChain;
 
   if (!templateChain.empty()) {
+    // One memoized walk resolves all 13 template flags at once
+    bool fullyResolved = false;
+    try {
+      fullyResolved = worldState->GetTemplateChainCache()
+                        .Resolve(worldState, baseId, templateChain)
+                        .IsFullyResolved();
+    } catch (std::exception&) {
+      // e.g. a plugin from the chain is no longer loaded
+    }
 
-    std::string errorTraits;
-    std::string errorStats;
-    std::string errorFactions;
-    std::string errorSpelllist;
-    std::string errorAIData;
-    std::string errorAIPackages;
-    std::string errorUnused;
-    std::string errorBaseData;
-    std::string errorInventory;
-    std::string errorScript;
-    std::string errorDefPackList;
-    std::string errorAttackData;
-    std::string errorKeywords;
-
-    auto doNothing = [](const auto&, const auto&) { return 1; };
-
-    EvaluateTemplateNoThrow<espm::NPC_::UseTraits>(
-      worldState, baseId, templateChain, doNothing, &errorTraits);
-
-    EvaluateTemplateNoThrow<espm::NPC_::UseStats>(
-      worldState, baseId, templateChain, doNothing, &errorStats);
-
-    EvaluateTemplateNoThrow<espm::NPC_::UseFactions>(
-      worldState, baseId, templateChain, doNothing, &errorFactions);
-
-    EvaluateTemplateNoThrow<espm::NPC_::UseSpelllist>(
-      worldState, baseId, templateChain, doNothing, &errorSpelllist);
-
-    EvaluateTemplateNoThrow<espm::NPC_::UseAIData>(
-      worldState, baseId, templateChain, doNothing, &errorAIData);
-
-    EvaluateTemplateNoThrow<espm::NPC_::UseAIPackages>(
-      worldState, baseId, templateChain, doNothing, &errorAIPackages);
-
-    EvaluateTemplateNoThrow<espm::NPC_::Unused>(
-      worldState, baseId, templateChain, doNothing, &errorUnused);
-
-    EvaluateTemplateNoThrow<espm::NPC_::UseBaseData>(
-      worldState, baseId, templateChain, doNothing, &errorBaseData);
-
-    EvaluateTemplateNoThrow<espm::NPC_::UseInventory>(
-      worldState, baseId, templateChain, doNothing, &errorInventory);
-
-    EvaluateTemplateNoThrow<espm::NPC_::UseScript>(
-      worldState, baseId, templateChain, doNothing, &errorScript);
-
-    EvaluateTemplateNoThrow<espm::NPC_::UseDefPackList>(
-      worldState, baseId, templateChain, doNothing, &errorDefPackList);
-
-    EvaluateTemplateNoThrow<espm::NPC_::UseAttackData>(
-      worldState, baseId, templateChain, doNothing, &errorAttackData);
-
-    EvaluateTemplateNoThrow<espm::NPC_::UseKeywords>(
-      worldState, baseId, templateChain, doNothing, &errorKeywords);
-
-    if (errorTraits.empty() && errorStats.empty() && errorFactions.empty() &&
-        errorSpelllist.empty() && errorAIData.empty() &&
-        errorAIPackages.empty() && errorUnused.empty() &&
-        errorBaseData.empty() && errorInventory.empty() &&
-        errorScript.empty() && errorDefPackList.empty() &&
-        errorAttackData.empty() && errorKeywords.empty()) {
+    if (fullyResolved) {
       return;
     }
 
@@ -1266,8 +1233,8 @@ std::map<uint32_t, uint32_t> MpActor::EvaluateDeathItem()
   }
 
   const auto kCountMult = 1;
-  auto map = LeveledListUtils::EvaluateListRecurse(
-    loader.GetBrowser(), deathItemLookupRes, kCountMult,
+  auto map = worldState->GetLeveledListCache().EvaluateListRecurse(
+    deathItemLookupRes, worldState->GetRandomEngine(), kCountMult,
     kPlayerCharacterLevel);
   return map;
 }
@@ -1403,7 +1370,7 @@ void MpActor::RespawnWithDelay(bool shouldTeleport)
                   changeForm.inv = inventoryToKeep;
                   changeForm.baseContainerAdded = false;
                 },
-                Mode::NoRequestSave);
+                Mode::NoRequestSave, MpChangeFormField::Inventory);
               EnsureBaseContainerAdded(worldState->GetEspm());
               spdlog::info("MpActor::RespawnWithDelay {:x} - {} inventory "
                            "entries with keyword kept",
@@ -1789,9 +1756,11 @@ void MpActor::SetActorValue(espm::ActorValue actorValue, float value)
 
   std::vector<espm::ActorValue> avFilter = { actorValue };
   NetSendChangeValues(currentActorValues, avFilter);
-  EditChangeForm([&](MpChangeForm& changeForm) {
-    changeForm.actorValues = currentActorValues;
-  });
+  EditChangeForm(
+    [&](MpChangeForm& changeForm) {
+      changeForm.actorValues = currentActorValues;
+    },
+    Mode::RequestSave, MpChangeFormField::ActorValues);
 }
 
 // TODO: only used in legacy MGEF implementation, remove when MGEF is rewritten
@@ -1799,7 +1768,8 @@ void MpActor::SetActorValues(const ActorValues& actorValues)
 {
   NetSendChangeValues(actorValues, std::nullopt);
   EditChangeForm(
-    [&](MpChangeForm& changeForm) { changeForm.actorValues = actorValues; });
+    [&](MpChangeForm& changeForm) { changeForm.actorValues = actorValues; },
+    Mode::RequestSave, MpChangeFormField::ActorValues);
 }
 
 void MpActor::ApplyMagicEffect(espm::Effects::Effect& effect, bool hasSweetpie,
@@ -1889,9 +1859,11 @@ void MpActor::ApplyMagicEffect(espm::Effects::Effect& effect, bool hasSweetpie,
         activeEffects.Get(av).value().get();
       worldState->RemoveEffectTimer(entry.timerId);
     }
-    EditChangeForm([av, pEntry = &entry](MpChangeForm& changeForm) {
-      changeForm.activeMagicEffects.Add(av, *pEntry);
-    });
+    EditChangeForm(
+      [av, pEntry = &entry](MpChangeForm& changeForm) {
+        changeForm.activeMagicEffects.Add(av, *pEntry);
+      },
+      Mode::RequestSave, MpChangeFormField::Effects);
     if (isRate) {
       SetActorValue(av, effect.magnitude);
     } else {
@@ -1934,9 +1906,11 @@ void MpActor::RemoveMagicEffect(const espm::ActorValue actorValue)
       GetParent(), GetBaseId(), GetRaceId(), ChangeForm().templateChain);
     const float baseActorValue = baseActorValues.GetValue(actorValue);
     SetActorValue(actorValue, baseActorValue);
-    EditChangeForm([actorValue](MpChangeForm& changeForm) {
-      changeForm.activeMagicEffects.Remove(actorValue);
-    });
+    EditChangeForm(
+      [actorValue](MpChangeForm& changeForm) {
+        changeForm.activeMagicEffects.Remove(actorValue);
+      },
+      Mode::RequestSave, MpChangeFormField::Effects);
   } catch (std::exception& e) {
     spdlog::error("MpActor::RemoveMagicEffect {:x} - {}", GetFormId(),
                   e.what());
@@ -1950,7 +1924,8 @@ void MpActor::RemoveAllMagicEffects()
       GetParent(), GetBaseId(), GetRaceId(), ChangeForm().templateChain);
     SetActorValues(baseActorValues);
     EditChangeForm(
-      [](MpChangeForm& changeForm) { changeForm.activeMagicEffects.Clear(); });
+      [](MpChangeForm& changeForm) { changeForm.activeMagicEffects.Clear(); },
+      Mode::RequestSave, MpChangeFormField::Effects);
   } catch (std::exception& e) {
     spdlog::error("MpActor::RemoveAllMagicEffects {:x} - {}", GetFormId(),
                   e.what());
@@ -79,6 +79,7 @@ public:
   void Disable() override;
 
   void SendToUser(const IMessageBase& message, bool reliable);
+  void SendToUser(const SerializedMessage& message, bool reliable);
   void SendToUserDeferred(const IMessageBase& message, bool reliable,
                           int deferredChannelId,
                           bool overwritePreviousChannelMessages);
@@ -20,43 +20,68 @@ std::vector<FormDesc> ToFormDescsArray(const std::vector<std::string>& strings)
 }
 }
 
-nlohmann::json MpChangeForm::ToJson(const MpChangeForm& changeForm)
+nlohmann::json MpChangeForm::ToJson(const MpChangeForm& changeForm,
+                                    uint32_t fieldGroups)
 {
   auto res = nlohmann::json::object();
-  res["recType"] = static_cast<int>(changeForm.recType);
   res["formDesc"] = changeForm.formDesc.ToString();
+
+  if (fieldGroups & MpChangeFormField::Position) {
+    res["position"] = { changeForm.position[0], changeForm.position[1],
+                        changeForm.position[2] };
+    res["angle"] = { changeForm.angle[0], changeForm.angle[1],
+                     changeForm.angle[2] };
+    res["worldOrCellDesc"] = changeForm.worldOrCellDesc.ToString();
+  }
+
+  if (fieldGroups & MpChangeFormField::Inventory) {
+    res["inv"] = changeForm.inv.ToJson();
+    res["baseContainerAdded"] = changeForm.baseContainerAdded;
+  }
+
+  if (fieldGroups & MpChangeFormField::DynamicFields) {
+    res["dynamicFields"] = changeForm.dynamicFields.GetAsJson();
+  }
+
+  if (fieldGroups & MpChangeFormField::Appearance) {
+    if (changeForm.appearanceDump.empty()) {
+      res["appearanceDump"] = nullptr;
+    } else {
+      res["appearanceDump"] = nlohmann::json::parse(changeForm.appearanceDump);
+    }
+  }
+
+  if (fieldGroups & MpChangeFormField::Equipment) {
+    res["equipmentDump"] = changeForm.equipment.ToJson();
+  }
+
+  if (fieldGroups & MpChangeFormField::ActorValues) {
+    res["healthPercentage"] = changeForm.actorValues.healthPercentage;
+    res["magickaPercentage"] = changeForm.actorValues.magickaPercentage;
+    res["staminaPercentage"] = changeForm.actorValues.staminaPercentage;
+  }
+
+  if (fieldGroups & MpChangeFormField::Effects) {
+    res["effects"] = changeForm.activeMagicEffects.ToJson();
+  }
+
+  if (!(fieldGroups & MpChangeFormField::Other)) {
+    return res;
+  }
+
+  res["recType"] = static_cast<int>(changeForm.recType);
   res["baseDesc"] = changeForm.baseDesc.ToString();
-  res["position"] = { changeForm.position[0], changeForm.position[1],
-                      changeForm.position[2] };
-  res["angle"] = { changeForm.angle[0], changeForm.angle[1],
-                   changeForm.angle[2] };
-  res["worldOrCellDesc"] = changeForm.worldOrCellDesc.ToString();
-  res["inv"] = changeForm.inv.ToJson();
   res["isHarvested"] = changeForm.isHarvested;
   res["isOpen"] = changeForm.isOpen;
-  res["baseContainerAdded"] = changeForm.baseContainerAdded;
   res["nextRelootDatetime"] = changeForm.nextRelootDatetime;
   res["isDisabled"] = changeForm.isDisabled;
   res["profileId"] = changeForm.profileId;
   res["isDeleted"] = changeForm.isDeleted;
   res["count"] = changeForm.count;
   res["isRaceMenuOpen"] = changeForm.isRaceMenuOpen;
-  res["dynamicFields"] = changeForm.dynamicFields.GetAsJson();
-
-  if (changeForm.appearanceDump.empty()) {
-    res["appearanceDump"] = nullptr;
-  } else {
-    res["appearanceDump"] = nlohmann::json::parse(changeForm.appearanceDump);
-  }
-
-  res["equipmentDump"] = changeForm.equipment.ToJson();
 
   res["learnedSpells"] = changeForm.learnedSpells.GetLearnedSpells();
 
-  res["healthPercentage"] = changeForm.actorValues.healthPercentage;
-  res["magickaPercentage"] = changeForm.actorValues.magickaPercentage;
-  res["staminaPercentage"] = changeForm.actorValues.staminaPercentage;
-
   res["healthRespawnPercentage"] = changeForm.healthRespawnPercentage;
   res["magickaRespawnPercentage"] = changeForm.magickaRespawnPercentage;
   res["staminaRespawnPercentage"] = changeForm.staminaRespawnPercentage;
@@ -75,7 +100,6 @@ nlohmann::json MpChangeForm::ToJson(const MpChangeForm& changeForm)
     changeForm.spawnPoint.cellOrWorldDesc.ToString();
 
   res["spawnDelay"] = changeForm.spawnDelay;
-  res["effects"] = changeForm.activeMagicEffects.ToJson();
 
   if (!changeForm.templateChain.empty()) {
     res["templateChain"] = ToStringArray(changeForm.templateChain);
@@ -115,6 +139,56 @@ nlohmann::json MpChangeForm::ToJson(const MpChangeForm& changeForm)
   return res;
 }
 
+std::vector<const char*> MpChangeForm::GetJsonKeys(uint32_t fieldGroups)
+{
+  static const std::vector<std::pair<uint32_t, std::vector<const char*>>>
+    kKeysByGroup = {
+      { MpChangeFormField::Position,
+        { "position", "angle", "worldOrCellDesc" } },
+      { MpChangeFormField::Inventory, { "inv", "baseContainerAdded" } },
+      { MpChangeFormField::DynamicFields, { "dynamicFields" } },
+      { MpChangeFormField::Appearance, { "appearanceDump" } },
+      { MpChangeFormField::Equipment, { "equipmentDump" } },
+      { MpChangeFormField::ActorValues,
+        { "healthPercentage", "magickaPercentage", "staminaPercentage" } },
+      { MpChangeFormField::Effects, { "effects" } },
+      { MpChangeFormField::Other,
+        { "recType",
+          "baseDesc",
+          "isHarvested",
+          "isOpen",
+          "nextRelootDatetime",
+          "isDisabled",
+          "profileId",
+          "isDeleted",
+          "count",
+          "isRaceMenuOpen",
+          "learnedSpells",
+          "healthRespawnPercentage",
+          "magickaRespawnPercentage",
+          "staminaRespawnPercentage",
+          "isDead",
+          "consoleCommandsAllowed",
+          "spawnPoint_pos",
+          "spawnPoint_rot",
+          "spawnPoint_cellOrWorldDesc",
+          "spawnDelay",
+          "templateChain",
+          "setNodeTextureSet",
+          "setNodeScale",
+          "displayName",
+          "factions" } }
+    };
+
+  std::vector<const char*> res = { "formDesc" };
+  for (auto& [group, keys] : kKeysByGroup) {
+    if (fieldGroups & group) {
+      res.insert(res.end(), keys.begin(), keys.end());
+    }
+  }
+  return res;
+}
+
 MpChangeForm MpChangeForm::JsonToChangeForm(simdjson::dom::element& element)
 {
   static const JsonPointer recType("recType");
@@ -54,6 +54,23 @@ private:
   Data _learnedSpellIds{};
 };
 
+// Groups of MpChangeForm fields for partial saves. Every group is stored under
+// a fixed set of JSON keys, see MpChangeFormREFR::GetJsonKeys
+namespace MpChangeFormField {
+enum : uint32_t
+{
+  Position = 1 << 0,      // position, angle, worldOrCellDesc
+  Inventory = 1 << 1,     // inv, baseContainerAdded
+  Appearance = 1 << 2,    // appearanceDump
+  Equipment = 1 << 3,     // equipment
+  ActorValues = 1 << 4,   // actorValues
+  DynamicFields = 1 << 5, // dynamicFields
+  Effects = 1 << 6,       // activeMagicEffects
+  Other = 1 << 7,         // everything else
+  All = (1 << 8) - 1
+};
+}
+
 class MpChangeFormREFR
 {
 public:
@@ -132,6 +149,11 @@ public:
 
   DynamicFields dynamicFields;
 
+  // Not saved and not compared. MpChangeFormField groups changed since the
+  // previous save of this form. Drivers supporting partial updates may write
+  // only these, others always write the whole form
+  uint32_t dirtyFieldGroups = MpChangeFormField::All;
+
   auto ToTuple() const
   {
     return std::make_tuple(
@@ -145,7 +167,15 @@ public:
       setNodeTextureSet, setNodeScale, displayName);
   }
 
-  static nlohmann::json ToJson(const MpChangeFormREFR& changeForm);
+  // Writes formDesc and the fields of the given groups only. Optional fields
+  // are omitted when empty, even if their group is requested
+  static nlohmann::json ToJson(
+    const MpChangeFormREFR& changeForm,
+    uint32_t fieldGroups = MpChangeFormField::All);
+
+  // Top-level keys ToJson may write for the given groups
+  static std::vector<const char*> GetJsonKeys(uint32_t fieldGroups);
+
   static MpChangeFormREFR JsonToChangeForm(simdjson::dom::element& element);
 };
 
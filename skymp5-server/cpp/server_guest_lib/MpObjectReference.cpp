@@ -4,7 +4,7 @@
 #include "FormCallbacks.h"
 #include "GetWeightFromRecord.h"
 #include "Inventory.h"
-#include "LeveledListUtils.h"
+#include "LeveledListCache.h"
 #include "MathUtils.h"
 #include "MessageBase.h"
 #include "MpActor.h"
@@ -28,8 +28,10 @@
 #include "script_storages/IScriptStorage.h"
 #include <ScopedTask.h>
 #include <TimeUtils.h>
+#include <algorithm>
 #include <antigo/Context.h>
 #include <antigo/ResolvedContext.h>
+#include <cstdlib>
 #include <map>
 #include <numeric>
 #include <optional>
@@ -152,6 +154,14 @@ std::pair<int16_t, int16_t> GetGridPos(const NiPoint3& pos) noexcept
 {
   return { int16_t(pos.x / 4096), int16_t(pos.y / 4096) };
 }
+
+// True if cells are the same or share a side or a corner
+bool IsAdjacentGridPos(std::pair<int32_t, int32_t> lhs,
+                       std::pair<int32_t, int32_t> rhs) noexcept
+{
+  return std::abs(lhs.first - rhs.first) <= 1 &&
+    std::abs(lhs.second - rhs.second) <= 1;
+}
 }
 
 struct AnimGraphHolder
@@ -539,7 +549,8 @@ void MpObjectReference::SetPos(const NiPoint3& newPos, SetPosMode setPosMode)
 
   EditChangeForm(
     [&newPos](MpChangeFormREFR& changeForm) { changeForm.position = newPos; },
-    MakeMode(IsLocationSavingNeeded(), setPosMode));
+    MakeMode(IsLocationSavingNeeded(), setPosMode),
+    MpChangeFormField::Position);
 
   if (oldGridPos != newGridPos || !everSubscribedOrListened)
     ForceSubscriptionsUpdate();
@@ -603,7 +614,8 @@ void MpObjectReference::SetAngle(const NiPoint3& newAngle,
 {
   EditChangeForm(
     [&](MpChangeFormREFR& changeForm) { changeForm.angle = newAngle; },
-    MakeMode(IsLocationSavingNeeded(), setAngleMode));
+    MakeMode(IsLocationSavingNeeded(), setAngleMode),
+    MpChangeFormField::Position);
 }
 
 void MpObjectReference::SetHarvested(bool harvested)
@@ -693,14 +705,34 @@ void MpObjectReference::ForceSubscriptionsUpdate()
   auto& gridInfo = worldState->grids[worldOrCell];
   MoveOnGrid(*gridInfo.grid);
 
-  auto& was = *this->listeners;
   auto pos = GetGridPos(GetPos());
-  auto& now =
-    worldState->GetNeighborsByPosition(worldOrCell, pos.first, pos.second);
 
   std::vector<MpObjectReference*> toRemove;
-  std::set_difference(was.begin(), was.end(), now.begin(), now.end(),
-                      std::inserter(toRemove, toRemove.begin()));
+  std::vector<MpObjectReference*> toAdd;
+
+  if (everSubscribedOrListened && subscribedGridPos != pos &&
+      IsAdjacentGridPos(subscribedGridPos, pos)) {
+    worldState->LoadChunksAround(worldOrCell, pos.first, pos.second);
+    if (AsActor()) {
+      worldState->PrefetchChunks(worldOrCell, subscribedGridPos, pos);
+    }
+    CollectSubscriptionsDelta(*gridInfo.grid, subscribedGridPos, pos,
+                              toRemove, toAdd);
+  } else {
+    auto& was = *this->listeners;
+    std::vector<MpObjectReference*> now;
+    worldState->ForEachNeighborByPosition(
+      worldOrCell, pos.first, pos.second,
+      [&](MpObjectReference* ref) { now.push_back(ref); });
+    // Same order as in std::set<MpObjectReference*>
+    std::sort(now.begin(), now.end());
+
+    std::set_difference(was.begin(), was.end(), now.begin(), now.end(),
+                        std::inserter(toRemove, toRemove.begin()));
+    std::set_difference(now.begin(), now.end(), was.begin(), was.end(),
+                        std::inserter(toAdd, toAdd.begin()));
+  }
+
   for (auto listener : toRemove) {
     Unsubscribe(this, listener);
     // Unsubscribe from self is NEEDED. See comment below
@@ -708,9 +740,6 @@ void MpObjectReference::ForceSubscriptionsUpdate()
       Unsubscribe(listener, this);
   }
 
-  std::vector<MpObjectReference*> toAdd;
-  std::set_difference(now.begin(), now.end(), was.begin(), was.end(),
-                      std::inserter(toAdd, toAdd.begin()));
   for (auto listener : toAdd) {
     Subscribe(this, listener);
     // Note: Self-subscription is OK this check is performed as we don't want
@@ -720,9 +749,54 @@ void MpObjectReference::ForceSubscriptionsUpdate()
       Subscribe(listener, this);
   }
 
+  subscribedGridPos = pos;
   everSubscribedOrListened = true;
 }
 
+void MpObjectReference::CollectSubscriptionsDelta(
+  const SpatialHashGrid<MpObjectReference*>& grid,
+  std::pair<int16_t, int16_t> from, std::pair<int16_t, int16_t> to,
+  std::vector<MpObjectReference*>& outToRemove,
+  std::vector<MpObjectReference*>& outToAdd) const
+{
+  // When moving to an adjacent cell, the 3x3 areas around the old and the
+  // new cell overlap. Objects in the overlapping cells are already
+  // subscribed, so only cells that are leaving or entering the area are
+  // visited
+  for (int32_t x = from.first - 1; x <= from.first + 1; ++x) {
+    for (int32_t y = from.second - 1; y <= from.second + 1; ++y) {
+      if (!IsAdjacentGridPos({ x, y }, to)) {
+        grid.ForEachInCell(x, y, [&](MpObjectReference* ref) {
+          if (listeners->count(ref)) {
+            outToRemove.push_back(ref);
+          }
+        });
+      }
+    }
+  }
+
+  // Disabled and deleted references leave the grid, so no cell has them,
+  // but they may still be listening. The full diff drops them as they're
+  // not neighbours anymore
+  for (auto ref : *listeners) {
+    if (!grid.Contains(ref)) {
+      outToRemove.push_back(ref);
+    }
+  }
+
+  for (int32_t x = to.first - 1; x <= to.first + 1; ++x) {
+    for (int32_t y = to.second - 1; y <= to.second + 1; ++y) {
+      if (!IsAdjacentGridPos({ x, y }, from)) {
+        grid.ForEachInCell(x, y, [&](MpObjectReference* ref) {
+          if (!listeners->count(ref)) {
+            outToAdd.push_back(ref);
+          }
+        });
+      }
+    }
+  }
+}
+
 void MpObjectReference::SetPrimitive(const NiPoint3& boundsDiv2)
 {
   auto vertices = Primitive::GetVertices(GetPos(), GetAngle(), boundsDiv2);
@@ -732,9 +806,16 @@ void MpObjectReference::SetPrimitive(const NiPoint3& boundsDiv2)
 
 void MpObjectReference::UpdateHoster(uint32_t newHosterId)
 {
-  auto hostedMsg = CreatePropertyMessage_(this, "isHostedByOther", "true");
-  auto notHostedMsg = CreatePropertyMessage_(this, "isHostedByOther", "false");
-  for (auto listener : this->GetActorListeners()) {
+  auto& listeners = this->GetActorListeners();
+  if (listeners.empty()) {
+    return;
+  }
+
+  auto hostedMsg = SerializeMessage(
+    CreatePropertyMessage_(this, "isHostedByOther", "true"));
+  auto notHostedMsg = SerializeMessage(
+    CreatePropertyMessage_(this, "isHostedByOther", "false"));
+  for (auto listener : listeners) {
     if (newHosterId != 0 && newHosterId != listener->GetFormId()) {
       listener->GetActorToSendTo().SendToUser(hostedMsg, true);
     } else {
@@ -749,9 +830,11 @@ void MpObjectReference::SetPropertyValueDump(const std::string& propertyName,
                                              bool isVisibleByNeighbor)
 {
   auto msg = CreatePropertyMessage_(this, propertyName.c_str(), valueDump);
-  EditChangeForm([&](MpChangeFormREFR& changeForm) {
-    changeForm.dynamicFields.SetValueDump(propertyName, valueDump);
-  });
+  EditChangeForm(
+    [&](MpChangeFormREFR& changeForm) {
+      changeForm.dynamicFields.SetValueDump(propertyName, valueDump);
+    },
+    Mode::RequestSave, MpChangeFormField::DynamicFields);
   if (isVisibleByNeighbor) {
     SendMessageToActorListeners(msg, true);
   } else if (isVisibleByOwner) {
@@ -775,7 +858,7 @@ void MpObjectReference::SetPosAndAngleSilent(const NiPoint3& pos,
       changeForm.position = pos;
       changeForm.angle = rot;
     },
-    Mode::NoRequestSave);
+    Mode::NoRequestSave, MpChangeFormField::Position);
 }
 
 void MpObjectReference::Delete()
@@ -807,19 +890,23 @@ void MpObjectReference::SetAnimationVariableBool(
 
 void MpObjectReference::SetInventory(const Inventory& inv)
 {
-  EditChangeForm([&](MpChangeFormREFR& changeForm) {
-    changeForm.baseContainerAdded = true;
-    changeForm.inv = inv;
-  });
+  EditChangeForm(
+    [&](MpChangeFormREFR& changeForm) {
+      changeForm.baseContainerAdded = true;
+      changeForm.inv = inv;
+    },
+    Mode::RequestSave, MpChangeFormField::Inventory);
   SendInventoryUpdate();
 }
 
 void MpObjectReference::AddItem(uint32_t baseId, uint32_t count)
 {
-  EditChangeForm([&](MpChangeFormREFR& changeForm) {
-    changeForm.baseContainerAdded = true;
-    changeForm.inv.AddItem(baseId, count);
-  });
+  EditChangeForm(
+    [&](MpChangeFormREFR& changeForm) {
+      changeForm.baseContainerAdded = true;
+      changeForm.inv.AddItem(baseId, count);
+    },
+    Mode::RequestSave, MpChangeFormField::Inventory);
   SendInventoryUpdate();
 
   if (auto worldState = GetParent(); worldState->HasEspm()) {
@@ -846,10 +933,12 @@ void MpObjectReference::AddItem(uint32_t baseId, uint32_t count)
 void MpObjectReference::AddItems(const std::vector<Inventory::Entry>& entries)
 {
   if (entries.size() > 0) {
-    EditChangeForm([&](MpChangeFormREFR& changeForm) {
-      changeForm.baseContainerAdded = true;
-      changeForm.inv.AddItems(entries);
-    });
+    EditChangeForm(
+      [&](MpChangeFormREFR& changeForm) {
+        changeForm.baseContainerAdded = true;
+        changeForm.inv.AddItems(entries);
+      },
+      Mode::RequestSave, MpChangeFormField::Inventory);
     SendInventoryUpdate();
   }
 
@@ -873,9 +962,9 @@ void MpObjectReference::RemoveItem(uint32_t baseId, uint32_t count,
 void MpObjectReference::RemoveItems(
   const std::vector<Inventory::Entry>& entries, MpObjectReference* target)
 {
-  EditChangeForm([&](MpChangeFormREFR& changeForm) {
-    changeForm.inv.RemoveItems(entries);
-  });
+  EditChangeForm(
+    [&](MpChangeFormREFR& changeForm) { changeForm.inv.RemoveItems(entries); },
+    Mode::RequestSave, MpChangeFormField::Inventory);
 
   if (target)
     target->AddItems(entries);
@@ -903,7 +992,7 @@ void MpObjectReference::RelootContainer()
     [&](MpChangeFormREFR& changeForm) {
       changeForm.baseContainerAdded = false;
     },
-    Mode::NoRequestSave);
+    Mode::NoRequestSave, MpChangeFormField::Inventory);
   EnsureBaseContainerAdded(*GetParent()->espm);
 }
 
@@ -959,10 +1048,12 @@ void MpObjectReference::RegisterPrivateIndexedProperty(
                   formId, key);
   }
 
-  EditChangeForm([&](MpChangeFormREFR& changeForm) {
-    changeForm.dynamicFields.SetValueDump(propertyName,
-                                          propertyValueStringified);
-  });
+  EditChangeForm(
+    [&](MpChangeFormREFR& changeForm) {
+      changeForm.dynamicFields.SetValueDump(propertyName,
+                                            propertyValueStringified);
+    },
+    Mode::RequestSave, MpChangeFormField::DynamicFields);
 
   if (!isNull(propertyValueStringified)) {
     auto key = worldState->MakePrivateIndexedPropertyMapKey(
@@ -1271,9 +1362,11 @@ void MpObjectReference::SetCellOrWorldObsolete(const FormDesc& newWorldOrCell)
     gridIterator->second.grid->Forget(this);
   }
 
-  EditChangeForm([&](MpChangeFormREFR& changeForm) {
-    changeForm.worldOrCellDesc = newWorldOrCell;
-  });
+  EditChangeForm(
+    [&](MpChangeFormREFR& changeForm) {
+      changeForm.worldOrCellDesc = newWorldOrCell;
+    },
+    Mode::RequestSave, MpChangeFormField::Position);
 }
 
 void MpObjectReference::VisitNeighbours(const Visitor& visitor)
@@ -1295,13 +1388,9 @@ void MpObjectReference::VisitNeighbours(const Visitor& visitor)
     return;
   }
 
-  auto& grid = gridIterator->second;
   auto pos = GetGridPos(GetPos());
-  auto& neighbours =
-    worldState->GetNeighborsByPosition(worldOrCell, pos.first, pos.second);
-  for (auto neighbour : neighbours) {
-    visitor(neighbour);
-  }
+  worldState->ForEachNeighborByPosition(worldOrCell, pos.first, pos.second,
+                                        visitor);
 }
 
 void MpObjectReference::SendPapyrusEvent(const char* eventName,
@@ -1392,8 +1481,9 @@ void MpObjectReference::GivePickupItemsToActivationSource(
   auto leveledItem = espm::Convert<espm::LVLI>(resultItemLookupRes.rec);
   if (leveledItem) {
     const auto kCountMult = 1;
-    auto map = LeveledListUtils::EvaluateListRecurse(
-      loader.GetBrowser(), resultItemLookupRes, kCountMult,
+    auto worldState = GetParent();
+    auto map = worldState->GetLeveledListCache().EvaluateListRecurse(
+      resultItemLookupRes, worldState->GetRandomEngine(), kCountMult,
       kPlayerCharacterLevel, chanceNoneOverride.get());
     for (auto& p : map) {
       activationSource.AddItem(p.first, p.second);
@@ -1836,7 +1926,7 @@ void MpObjectReference::InitScripts()
   }
 }
 
-void MpObjectReference::MoveOnGrid(GridImpl<MpObjectReference*>& grid)
+void MpObjectReference::MoveOnGrid(SpatialHashGrid<MpObjectReference*>& grid)
 {
   auto newGridPos = GetGridPos(GetPos());
   grid.Move(this, newGridPos.first, newGridPos.second);
@@ -1933,9 +2023,10 @@ void MpObjectReference::AddContainerObject(
   auto leveledItem = espm::Convert<espm::LVLI>(formLookupRes.rec);
   if (leveledItem) {
     constexpr uint32_t kCountMult = 1;
-    auto map = LeveledListUtils::EvaluateListRecurse(
-      espm.GetBrowser(), formLookupRes, kCountMult, kPlayerCharacterLevel,
-      chanceNoneOverride.get());
+    auto worldState = GetParent();
+    auto map = worldState->GetLeveledListCache().EvaluateListRecurse(
+      formLookupRes, worldState->GetRandomEngine(), kCountMult,
+      kPlayerCharacterLevel, chanceNoneOverride.get());
     for (auto& p : map) {
       (*itemsToAdd)[p.first] += p.second;
     }
@@ -2028,9 +2119,24 @@ void MpObjectReference::CheckInteractionAbility(MpObjectReference& refr)
 void MpObjectReference::SendMessageToActorListeners(const IMessageBase& msg,
                                                     bool reliable) const
 {
-  for (auto listener : GetActorListeners()) {
-    listener->GetActorToSendTo().SendToUser(msg, true);
+  auto& listeners = GetActorListeners();
+  if (listeners.empty()) {
+    return;
+  }
+
+  auto serializedMsg = SerializeMessage(msg);
+  for (auto listener : listeners) {
+    listener->GetActorToSendTo().SendToUser(serializedMsg, true);
+  }
+}
+
+SerializedMessage MpObjectReference::SerializeMessage(
+  const IMessageBase& msg) const
+{
+  if (!callbacks->serializeMessage) {
+    throw std::runtime_error("serializeMessage is nullptr");
   }
+  return callbacks->serializeMessage(msg);
 }
 
 void MpObjectReference::BeforeDestroy()
@@ -1,13 +1,14 @@
 #pragma once
 #include "ChangeFormGuard.h"
 #include "FormIndex.h"
-#include "Grid.h"
 #include "Inventory.h"
 #include "JsonUtils.h"
 #include "LocationalData.h"
 #include "MessageBase.h"
 #include "MpChangeForms.h"
 #include "MpForm.h"
+#include "SerializedMessage.h"
+#include "SpatialHashGrid.h"
 #include "libespm/Loader.h"
 #include <chrono>
 #include <functional>
@@ -217,14 +218,22 @@ protected:
 
   void EnsureBaseContainerAdded(espm::Loader& espm);
 
+  // Serializes the message once and sends the same buffer to every listener
   void SendMessageToActorListeners(const IMessageBase& msg,
                                    bool reliable) const;
 
+  SerializedMessage SerializeMessage(const IMessageBase& msg) const;
+
 private:
   void AddContainerObject(const espm::CONT::ContainerObject& containerObject,
                           std::map<uint32_t, uint32_t>* itemsToAdd);
   void InitScripts();
-  void MoveOnGrid(GridImpl<MpObjectReference*>& grid);
+  void MoveOnGrid(SpatialHashGrid<MpObjectReference*>& grid);
+  void CollectSubscriptionsDelta(
+    const SpatialHashGrid<MpObjectReference*>& grid,
+    std::pair<int16_t, int16_t> from, std::pair<int16_t, int16_t> to,
+    std::vector<MpObjectReference*>& outToRemove,
+    std::vector<MpObjectReference*>& outToAdd) const;
   void InitListenersAndEmitters();
   void SendOpenContainer(uint32_t refId);
   void CheckInteractionAbility(MpObjectReference& ac);
@@ -238,6 +247,7 @@ private:
                                        float occupationReach);
 
   bool everSubscribedOrListened = false;
+  std::pair<int16_t, int16_t> subscribedGridPos = { 0, 0 };
   std::unique_ptr<std::set<MpObjectReference*>> listeners;
   std::vector<MpActor*> actorListenerArray;
 
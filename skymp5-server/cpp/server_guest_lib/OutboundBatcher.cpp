@@ -0,0 +1,182 @@
+#include "OutboundBatcher.h"
+#include "MessageBundle.h"
+#include <unordered_map>
+#include <vector>
+
+namespace {
+struct Entry
+{
+  size_t offset = 0;
+  size_t length = 0;
+  bool replaced = false;
+};
+
+struct Stream
+{
+  std::vector<uint8_t> buffer;
+  std::vector<Entry> entries;
+
+  size_t Push(Networking::PacketData data, size_t length)
+  {
+    entries.push_back({ buffer.size(), length });
+    buffer.insert(buffer.end(), data, data + length);
+    return entries.size() - 1;
+  }
+
+  void Clear()
+  {
+    buffer.clear();
+    entries.clear();
+  }
+};
+
+struct UserQueue
+{
+  Stream reliable, unreliable;
+
+  // Coalesce key => index in unreliable.entries
+  std::unordered_map<uint64_t, size_t> coalesced;
+
+  bool dirty = false;
+};
+}
+
+struct OutboundBatcher::Impl
+{
+  Networking::ISendTarget* underlyingSendTarget = nullptr;
+
+  std::vector<UserQueue> users;
+  std::vector<Networking::UserId> dirtyUsers;
+
+  // Reused between flushes to avoid allocations
+  std::vector<uint8_t> bundle;
+
+  UserQueue& GetQueue(Networking::UserId userId);
+  void FlushStream(Networking::UserId userId, const Stream& stream,
+                   bool reliable);
+};
+
+OutboundBatcher::OutboundBatcher(Networking::ISendTarget& underlyingSendTarget)
+  : pImpl(std::make_unique<Impl>())
+{
+  pImpl->underlyingSendTarget = &underlyingSendTarget;
+}
+
+OutboundBatcher::~OutboundBatcher() = default;
+
+void OutboundBatcher::Enqueue(Networking::UserId targetUserId,
+                              Networking::PacketData data, size_t length,
+                              bool reliable)
+{
+  if (length == 0) {
+    return;
+  }
+  auto& queue = pImpl->GetQueue(targetUserId);
+  (reliable ? queue.reliable : queue.unreliable).Push(data, length);
+}
+
+void OutboundBatcher::EnqueueCoalesced(Networking::UserId targetUserId,
+                                       Networking::PacketData data,
+                                       size_t length, uint64_t coalesceKey)
+{
+  if (length == 0) {
+    return;
+  }
+  auto& queue = pImpl->GetQueue(targetUserId);
+
+  auto [it, inserted] = queue.coalesced.emplace(coalesceKey, 0);
+  if (!inserted) {
+    queue.unreliable.entries[it->second].replaced = true;
+  }
+  it->second = queue.unreliable.Push(data, length);
+}
+
+void OutboundBatcher::Forget(Networking::UserId targetUserId)
+{
+  if (targetUserId >= pImpl->users.size()) {
+    return;
+  }
+  auto& queue = pImpl->users[targetUserId];
+  queue.reliable.Clear();
+  queue.unreliable.Clear();
+  queue.coalesced.clear();
+}
+
+void OutboundBatcher::Flush()
+{
+  for (auto userId : pImpl->dirtyUsers) {
+    auto& queue = pImpl->users[userId];
+    pImpl->FlushStream(userId, queue.reliable, true);
+    pImpl->FlushStream(userId, queue.unreliable, false);
+    queue.reliable.Clear();
+    queue.unreliable.Clear();
+    queue.coalesced.clear();
+    queue.dirty = false;
+  }
+  pImpl->dirtyUsers.clear();
+}
+
+UserQueue& OutboundBatcher::Impl::GetQueue(Networking::UserId userId)
+{
+  if (userId >= users.size()) {
+    users.resize(static_cast<size_t>(userId) + 1);
+  }
+
+  auto& queue = users[userId];
+  if (!queue.dirty) {
+    queue.dirty = true;
+    dirtyUsers.push_back(userId);
+  }
+  return queue;
+}
+
+void OutboundBatcher::Impl::FlushStream(Networking::UserId userId,
+                                        const Stream& stream, bool reliable)
+{
+  const Entry* single = nullptr;
+  size_t numBundled = 0;
+
+  auto sendEntry = [&](const Entry& entry) {
+    underlyingSendTarget->Send(userId, stream.buffer.data() + entry.offset,
+                               entry.length, reliable);
+  };
+
+  auto sendBundle = [&] {
+    if (numBundled == 1) {
+      sendEntry(*single);
+    } else if (numBundled > 1) {
+      underlyingSendTarget->Send(userId, bundle.data(), bundle.size(),
+                                 reliable);
+    }
+    bundle.clear();
+    numBundled = 0;
+  };
+
+  constexpr size_t kOverhead =
+    MessageBundle::kHeaderSize + MessageBundle::kLengthPrefixSize;
+
+  for (auto& entry : stream.entries) {
+    if (entry.replaced) {
+      continue;
+    }
+
+    if (entry.length + kOverhead > kMaxBundleSize) {
+      // Too big to share a bundle with anything, RakNet splits it anyway
+      sendBundle();
+      sendEntry(entry);
+      continue;
+    }
+
+    if (bundle.size() + MessageBundle::kLengthPrefixSize + entry.length >
+        kMaxBundleSize) {
+      sendBundle();
+    }
+
+    MessageBundle::Append(bundle, stream.buffer.data() + entry.offset,
+                          entry.length);
+    single = &entry;
+    ++numBundled;
+  }
+
+  sendBundle();
+}
@@ -0,0 +1,41 @@
+#pragma once
+#include "NetworkingInterface.h"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+// Collects messages sent to each user and sends them on Flush as bundles
+// (see MessageBundle.h). Reliable and unreliable messages go to separate
+// bundles, each split at kMaxBundleSize so that an unreliable bundle fits
+// into a single datagram. A bundle holding a single message is sent without
+// the bundle header.
+class OutboundBatcher
+{
+public:
+  static constexpr size_t kMaxBundleSize = 1200;
+
+  explicit OutboundBatcher(Networking::ISendTarget& underlyingSendTarget);
+  ~OutboundBatcher();
+
+  void Enqueue(Networking::UserId targetUserId, Networking::PacketData data,
+               size_t length, bool reliable);
+
+  // Replaces an unreliable message with the same key that hasn't been
+  // flushed yet, i.e. only the latest movement of an actor reaches the user
+  void EnqueueCoalesced(Networking::UserId targetUserId,
+                        Networking::PacketData data, size_t length,
+                        uint64_t coalesceKey);
+
+  // Drops messages that haven't been sent yet. The user id may be reused by
+  // the next connection
+  void Forget(Networking::UserId targetUserId);
+
+  void Flush();
+
+private:
+  OutboundBatcher(const OutboundBatcher&) = delete;
+  OutboundBatcher& operator=(const OutboundBatcher&) = delete;
+
+  struct Impl;
+  std::unique_ptr<Impl> pImpl;
+};
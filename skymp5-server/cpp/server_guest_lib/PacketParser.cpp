@@ -8,6 +8,7 @@
 #include "MpActor.h"
 #include "MsgType.h"
 #include "SpellCastData.h"
+#include <optional>
 #include <simdjson.h>
 #include <slikenet/BitStream.h>
 
@@ -16,12 +17,14 @@ struct PacketParser::Impl
   simdjson::dom::parser simdjsonParser;
   std::shared_ptr<MessageSerializer> serializer;
   std::once_flag jsonWarning;
+  TickMetrics* tickMetrics = nullptr;
 };
 
-PacketParser::PacketParser()
+PacketParser::PacketParser(TickMetrics* tickMetrics)
 {
   pImpl.reset(new Impl);
   pImpl->serializer = MessageSerializerFactory::CreateMessageSerializer();
+  pImpl->tickMetrics = tickMetrics;
 }
 
 void PacketParser::TransformPacketIntoAction(Networking::UserId userId,
@@ -39,6 +42,15 @@ void PacketParser::TransformPacketIntoAction(Networking::UserId userId,
     userId,
   };
 
+  std::optional<TickMetrics::ScopedTimer> timer;
+  if (pImpl->tickMetrics) {
+    // Type is taken from the binary header, so legacy JSON packets are
+    // reported as Invalid
+    auto msgType = TickMetrics::GetMsgType(data, length);
+    pImpl->tickMetrics->CountReceived(msgType, length);
+    timer.emplace(*pImpl->tickMetrics, msgType);
+  }
+
   auto result = pImpl->serializer->Deserialize(data, length);
   if (result != std::nullopt) {
     if (result->format == DeserializeInputFormat::Json) {
@@ -98,6 +110,12 @@ void PacketParser::TransformPacketIntoAction(Networking::UserId userId,
         actionListener.OnUpdateMovement(rawMsgData, *message);
         return;
       }
+      case MsgType::UpdateMovementCompact: {
+        auto message = reinterpret_cast<UpdateMovementCompactMessage*>(
+          result->message.get());
+        actionListener.OnUpdateMovement(rawMsgData, *message);
+        return;
+      }
       case MsgType::UpdateAnimation: {
         auto message =
           reinterpret_cast<UpdateAnimationMessage*>(result->message.get());
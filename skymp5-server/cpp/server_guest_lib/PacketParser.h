@@ -1,13 +1,15 @@
 #pragma once
 #include "ActionListener.h"
 #include "NetworkingInterface.h" // UserId, PacketData
+#include "TickMetrics.h"
 #include <cstdint>
 #include <memory>
 
 class PacketParser
 {
 public:
-  PacketParser();
+  // Received messages are counted and timed in tickMetrics if not nullptr
+  explicit PacketParser(TickMetrics* tickMetrics = nullptr);
   void TransformPacketIntoAction(Networking::UserId userId,
                                  Networking::PacketData packetData,
                                  size_t packetLength,
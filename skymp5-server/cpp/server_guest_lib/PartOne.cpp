@@ -9,6 +9,7 @@
 #include "CustomPacketMessage.h"
 #include "DestroyActorMessage.h"
 #include "HostStopMessage.h"
+#include "ServerFeaturesMessage.h"
 #include "SetRaceMenuOpenMessage.h"
 #include "UpdateGameModeDataMessage.h"
 
@@ -19,8 +20,9 @@
 #include "PacketParser.h"
 
 PartOneSendTargetWrapper::PartOneSendTargetWrapper(
-  Networking::ISendTarget& underlyingSendTarget_)
+  Networking::ISendTarget& underlyingSendTarget_, TickMetrics* tickMetrics_)
   : underlyingSendTarget(underlyingSendTarget_)
+  , tickMetrics(tickMetrics_)
 {
 }
 
@@ -28,6 +30,12 @@ void PartOneSendTargetWrapper::Send(Networking::UserId targetUserId,
                                     Networking::PacketData data, size_t length,
                                     bool reliable)
 {
+  if (tickMetrics) {
+    tickMetrics->CountSent(TickMetrics::GetMsgType(data, length), length);
+  }
+  if (batcher) {
+    return batcher->Enqueue(targetUserId, data, length, reliable);
+  }
   return underlyingSendTarget.Send(targetUserId, data, length, reliable);
 }
 
@@ -43,6 +51,54 @@ void PartOneSendTargetWrapper::Send(Networking::UserId targetUserId,
        stream.GetNumberOfBytesUsed(), reliable);
 }
 
+void PartOneSendTargetWrapper::Send(Networking::UserId targetUserId,
+                                    const SerializedMessage& message,
+                                    bool reliable)
+{
+  if (message.IsEmpty()) {
+    return;
+  }
+  Send(targetUserId, message.GetData(), message.GetLength(), reliable);
+}
+
+void PartOneSendTargetWrapper::SendCoalesced(Networking::UserId targetUserId,
+                                             Networking::PacketData data,
+                                             size_t length,
+                                             uint64_t coalesceKey)
+{
+  if (tickMetrics) {
+    tickMetrics->CountSent(TickMetrics::GetMsgType(data, length), length);
+  }
+  if (batcher) {
+    return batcher->EnqueueCoalesced(targetUserId, data, length, coalesceKey);
+  }
+  return underlyingSendTarget.Send(targetUserId, data, length, false);
+}
+
+void PartOneSendTargetWrapper::EnableBatching(bool enable)
+{
+  if (!enable) {
+    FlushBatches();
+    batcher.reset();
+  } else if (!batcher) {
+    batcher = std::make_unique<OutboundBatcher>(underlyingSendTarget);
+  }
+}
+
+void PartOneSendTargetWrapper::FlushBatches()
+{
+  if (batcher) {
+    batcher->Flush();
+  }
+}
+
+void PartOneSendTargetWrapper::ForgetBatches(Networking::UserId targetUserId)
+{
+  if (batcher) {
+    batcher->Forget(targetUserId);
+  }
+}
+
 class FakeSendTarget : public Networking::ISendTarget
 {
 public:
@@ -77,8 +133,6 @@ struct PartOne::Impl
                      MpObjectReference* emitter, MpObjectReference* listener)>
     onSubscribe, onUnsubscribe;
 
-  espm::CompressedFieldsCache compressedFieldsCache;
-
   std::shared_ptr<PacketParser> packetParser;
   std::shared_ptr<ActionListener> actionListener;
 
@@ -94,6 +148,8 @@ struct PartOne::Impl
   std::shared_ptr<OpenSSLSigner> sslSigner; // nullptr if no private key set
   std::string sslSignerKeyAlias;            // empty string
   bool enableGamemodeDataUpdatesBroadcast = false;
+  bool enableOutboundBatching = false;
+  bool enableCompactMovement = false;
 
   PartOne::OnActorStreamIn onActorStreamIn;
 };
@@ -124,8 +180,12 @@ void PartOne::SetSendTarget(Networking::ISendTarget* sendTarget)
   Networking::ISendTarget* underlyingSendTargetToSet =
     sendTarget ? sendTarget : &pImpl->fakeSendTarget;
 
-  pImpl->sendTarget.reset(
-    new PartOneSendTargetWrapper(*underlyingSendTargetToSet));
+  if (pImpl->sendTarget) {
+    pImpl->sendTarget->FlushBatches();
+  }
+  pImpl->sendTarget.reset(new PartOneSendTargetWrapper(
+    *underlyingSendTargetToSet, &worldState.GetTickMetrics()));
+  pImpl->sendTarget->EnableBatching(pImpl->enableOutboundBatching);
 }
 
 void PartOne::SetDamageFormula(std::unique_ptr<IDamageFormula> dmgFormula)
@@ -145,9 +205,27 @@ bool PartOne::IsConnected(Networking::UserId userId) const
 
 void PartOne::Tick()
 {
-  TickPacketHistoryPlaybacks();
-  TickDeferredMessages();
+  auto& metrics = worldState.GetTickMetrics();
+  TickMetrics::ScopedTimer tickTimer(metrics, TickMetrics::Phase::PartOneTick);
+
+  {
+    TickMetrics::ScopedTimer timer(metrics,
+                                   TickMetrics::Phase::PacketHistoryPlayback);
+    TickPacketHistoryPlaybacks();
+  }
+  {
+    TickMetrics::ScopedTimer timer(metrics,
+                                   TickMetrics::Phase::DeferredMessages);
+    TickDeferredMessages();
+  }
   worldState.Tick();
+  if (pImpl->actionListener) {
+    pImpl->actionListener->FlushHeldBackMovement();
+  }
+  {
+    TickMetrics::ScopedTimer timer(metrics, TickMetrics::Phase::FlushBatches);
+    pImpl->sendTarget->FlushBatches();
+  }
 }
 
 uint32_t PartOne::CreateActor(uint32_t formId, const NiPoint3& pos,
@@ -325,6 +403,9 @@ void PartOne::AttachEspm(espm::Loader* espm)
 {
   pImpl->espm = espm;
   worldState.AttachEspm(espm, [this] { return CreateFormCallbacks(); });
+
+  InitActionListener();
+  pImpl->actionListener->GetCraftService()->IndexRecipes(espm->GetBrowser());
 }
 
 void PartOne::AttachSaveStorage(
@@ -455,9 +536,11 @@ void PartOne::HandlePacket(void* partOneInstance, Networking::UserId userId,
           // TODO: apply dependency inversion here: connection handling code
           // should not depend on animation system
           this_->animationSystem.ClearInfo(actor);
+          this_->serverState.ForgetRelayedMovement(actor->GetIdx());
         }
         this_->serverState.Disconnect(userId);
         this_->serverState.disconnectingUserId = Networking::InvalidUserId;
+        this_->GetSendTarget().ForgetBatches(userId);
       });
 
       this_->serverState.disconnectingUserId = userId;
@@ -576,6 +659,17 @@ void PartOne::EnableGamemodeDataUpdatesBroadcast(bool enable)
   pImpl->enableGamemodeDataUpdatesBroadcast = enable;
 }
 
+void PartOne::EnableOutboundBatching(bool enable)
+{
+  pImpl->enableOutboundBatching = enable;
+  pImpl->sendTarget->EnableBatching(enable);
+}
+
+void PartOne::EnableCompactMovement(bool enable)
+{
+  pImpl->enableCompactMovement = enable;
+}
+
 std::string PartOne::SignJavaScriptSources(const std::string& src) const
 {
   if (src.empty()) {
@@ -731,7 +825,22 @@ FormCallbacks PartOne::CreateFormCallbacks()
     return st->UserByActor(actor);
   };
 
-  return { subscribe, unsubscribe, sendToUser, sendToUserDeferred, getUserId };
+  FormCallbacks::SerializeMessageFn serializeMessage =
+    [](const IMessageBase& message) { return SerializeMessage(message); };
+
+  FormCallbacks::SendSerializedToUserFn sendSerializedToUser =
+    [this, st](MpActor* actor, const SerializedMessage& message,
+               bool reliable) {
+      auto targetuserId = st->UserByActor(actor);
+      if (targetuserId != Networking::InvalidUserId &&
+          st->disconnectingUserId != targetuserId) {
+        pImpl->sendTarget->Send(targetuserId, message, reliable);
+      }
+    };
+
+  return { subscribe,          unsubscribe, sendToUser,
+           sendToUserDeferred, getUserId,   serializeMessage,
+           sendSerializedToUser };
 }
 
 ActionListener& PartOne::GetActionListener()
@@ -887,8 +996,16 @@ void PartOne::Init()
     }
 
     auto listenerUserId = serverState.UserByActor(listenerAsActor);
-    if (listenerUserId != Networking::InvalidUserId &&
-        listenerUserId != serverState.disconnectingUserId) {
+    if (listenerUserId == Networking::InvalidUserId) {
+      return;
+    }
+
+    // Also covers destroyed forms: their idx may be reused by another form
+    if (auto& info = serverState.userInfo[listenerUserId]) {
+      info->relayedMovementByIdx.erase(emitter->GetIdx());
+    }
+
+    if (listenerUserId != serverState.disconnectingUserId) {
       DestroyActorMessage message;
       message.idx = emitter->GetIdx();
       sendTarget->Send(listenerUserId, message, true);
@@ -903,6 +1020,13 @@ void PartOne::AddUser(Networking::UserId userId, UserType type,
   for (auto& listener : worldState.listeners)
     listener->OnConnect(userId);
 
+  // Clients keep sending UpdateMovement until they see this
+  if (pImpl->enableCompactMovement) {
+    ServerFeaturesMessage featuresMsg;
+    featuresMsg.compactMovement = true;
+    GetSendTarget().Send(userId, featuresMsg, true);
+  }
+
   // Save CPU time by not serializing UpdateGamemodeDataMessage each time
   if (!pImpl->updateGamemodeDataMsg.empty()) {
     GetSendTarget().Send(userId,
@@ -923,7 +1047,8 @@ void PartOne::HandleMessagePacket(Networking::UserId userId,
   }
 
   if (!pImpl->packetParser) {
-    pImpl->packetParser = std::make_shared<PacketParser>();
+    pImpl->packetParser =
+      std::make_shared<PacketParser>(&worldState.GetTickMetrics());
   }
 
   InitActionListener();
@@ -1034,6 +1159,16 @@ void PartOne::TickDeferredMessages()
   }
 }
 
+SerializedMessage PartOne::SerializeMessage(const IMessageBase& message)
+{
+  SLNet::BitStream stream;
+  GetMessageSerializerInstance().Serialize(message, stream);
+
+  auto begin = reinterpret_cast<const uint8_t*>(stream.GetData());
+  return SerializedMessage(
+    std::vector<uint8_t>(begin, begin + stream.GetNumberOfBytesUsed()));
+}
+
 MessageSerializer& PartOne::GetMessageSerializerInstance()
 {
   static auto g_serializer =
@@ -6,9 +6,12 @@
 #include "MpActor.h"
 #include "MpChangeForms.h"
 #include "NiPoint3.h"
+#include "OutboundBatcher.h"
 #include "PartOneListener.h"
+#include "SerializedMessage.h"
 #include "ServerState.h"
 #include "SpellCastData.h"
+#include "TickMetrics.h"
 #include "WorldState.h"
 #include "formulas/IDamageFormula.h"
 #include "libespm/Loader.h"
@@ -27,8 +30,10 @@ class MessageSerializer;
 class PartOneSendTargetWrapper : public Networking::ISendTarget
 {
 public:
+  // Sent messages are counted in tickMetrics if not nullptr
   explicit PartOneSendTargetWrapper(
-    Networking::ISendTarget& underlyingSendTarget_);
+    Networking::ISendTarget& underlyingSendTarget_,
+    TickMetrics* tickMetrics_ = nullptr);
 
   void Send(Networking::UserId targetUserId, Networking::PacketData data,
             size_t length, bool reliable) override;
@@ -36,8 +41,25 @@ public:
   void Send(Networking::UserId targetUserId, const IMessageBase& message,
             bool reliable);
 
+  void Send(Networking::UserId targetUserId, const SerializedMessage& message,
+            bool reliable);
+
+  // Unreliable. With batching enabled, replaces a message with the same key
+  // that hasn't been flushed yet. Without batching, same as Send
+  void SendCoalesced(Networking::UserId targetUserId,
+                     Networking::PacketData data, size_t length,
+                     uint64_t coalesceKey);
+
+  // Messages are collected until FlushBatches and sent to each user as
+  // bundles. The client must understand MsgType::Bundle
+  void EnableBatching(bool enable);
+  void FlushBatches();
+  void ForgetBatches(Networking::UserId targetUserId);
+
 private:
   Networking::ISendTarget& underlyingSendTarget;
+  TickMetrics* const tickMetrics;
+  std::unique_ptr<OutboundBatcher> batcher;
 };
 
 class PartOne
@@ -123,6 +145,14 @@ public:
 
   void EnableGamemodeDataUpdatesBroadcast(bool enable);
 
+  // See PartOneSendTargetWrapper::EnableBatching. Batches are flushed at the
+  // end of Tick
+  void EnableOutboundBatching(bool enable);
+
+  // Advertises compact movement to users on connect. Clients that don't know
+  // ServerFeaturesMessage can't connect to a server with this enabled
+  void EnableCompactMovement(bool enable);
+
   void SetPacketHistoryRecording(Networking::UserId userId, bool value);
   PacketHistory GetPacketHistory(Networking::UserId userId);
   void ClearPacketHistory(Networking::UserId userId);
@@ -134,6 +164,9 @@ public:
 
   static MessageSerializer& GetMessageSerializerInstance();
 
+  // Encodes the message once so that it can be sent to multiple users
+  static SerializedMessage SerializeMessage(const IMessageBase& message);
+
 private:
   void Init();
 
@@ -25,11 +25,10 @@ std::vector<NiPoint3> Primitive::GetVertices(NiPoint3 pos, NiPoint3 rotRad,
   return res;
 }
 
-std::vector<NiPoint3> Primitive::GetVertices(const espm::REFR* refr)
+std::vector<NiPoint3> Primitive::GetVertices(
+  const espm::REFR* refr, espm::CompressedFieldsCache& cache)
 {
-  espm::CompressedFieldsCache dummyCache;
-
-  auto data = refr->GetData(dummyCache);
+  auto data = refr->GetData(cache);
   NiPoint3 pos = { data.loc->pos[0], data.loc->pos[1], data.loc->pos[2] };
   NiPoint3 rotRad = { data.loc->rotRadians[0], data.loc->rotRadians[1],
                       data.loc->rotRadians[2] };
@@ -0,0 +1,30 @@
+#pragma once
+#include "NetworkingInterface.h"
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+// Message that has already been encoded by MessageSerializer. Copies share
+// the same immutable buffer, so broadcasting to N users costs one encoding
+class SerializedMessage
+{
+public:
+  SerializedMessage() = default;
+
+  explicit SerializedMessage(std::vector<uint8_t> bytes)
+    : buffer(std::make_shared<const std::vector<uint8_t>>(std::move(bytes)))
+  {
+  }
+
+  Networking::PacketData GetData() const noexcept
+  {
+    return buffer ? buffer->data() : nullptr;
+  }
+
+  size_t GetLength() const noexcept { return buffer ? buffer->size() : 0; }
+
+  bool IsEmpty() const noexcept { return GetLength() == 0; }
+
+private:
+  std::shared_ptr<const std::vector<uint8_t>> buffer;
+};
@@ -76,3 +76,12 @@ void ServerState::EnsureUserExists(Networking::UserId userId)
                              " doesn't exist");
   }
 }
+
+void ServerState::ForgetRelayedMovement(uint32_t actorIdx) noexcept
+{
+  for (Networking::UserId i = 0; i <= maxConnectedId; ++i) {
+    if (userInfo[i]) {
+      userInfo[i]->relayedMovementByIdx.erase(actorIdx);
+    }
+  }
+}
@@ -1,6 +1,7 @@
 #pragma once
 #include "ActorsMap.h"
 #include "Config.h"
+#include "MovementRelayLod.h"
 #include <Networking.h>
 #include <array>
 #include <chrono>
@@ -50,6 +51,14 @@ struct UserInfo
 
   std::vector<std::vector<DeferredMessage>> deferredChannels;
 
+  // Set once the user sends UpdateMovementCompactMessage. Movement of other
+  // actors is then relayed to the user in the same encoding
+  bool compactMovement = false;
+
+  // Movement of other actors relayed to the user, by actor idx
+  std::unordered_map<uint32_t, MovementRelayLod::RelayState>
+    relayedMovementByIdx;
+
   std::string guid;
 };
 
@@ -74,4 +83,7 @@ public:
   const std::string& UserGuid(Networking::UserId userId);
   Networking::UserId UserByActor(MpActor* actor);
   void EnsureUserExists(Networking::UserId userId);
+
+  // Drops the movement relay state of the actor for every user
+  void ForgetRelayedMovement(uint32_t actorIdx) noexcept;
 };
@@ -0,0 +1,85 @@
+#include "TemplateChainCache.h"
+#include "FormDesc.h"
+#include "WorldState.h"
+#include "libespm/espm.h"
+
+auto TemplateChainCache::Resolution::FindSource(uint16_t templateFlag) const
+  -> const Element*
+{
+  auto flagIndex = GetFlagIndex(templateFlag);
+  if (!flagIndex) {
+    return nullptr;
+  }
+  int32_t i = sourceIndex[*flagIndex];
+  return i >= 0 ? &elements[i] : nullptr;
+}
+
+bool TemplateChainCache::Resolution::IsFullyResolved() const noexcept
+{
+  for (auto i : sourceIndex) {
+    if (i < 0) {
+      return false;
+    }
+  }
+  return true;
+}
+
+TemplateChainCache::Resolution& TemplateChainCache::Resolve(
+  WorldState* worldState, uint32_t baseId,
+  const std::vector<FormDesc>& templateChain)
+{
+  std::vector<uint32_t> chain;
+  if (templateChain.empty()) {
+    chain.push_back(baseId);
+  } else {
+    chain.reserve(templateChain.size());
+    for (auto& formDesc : templateChain) {
+      chain.push_back(formDesc.ToFormId(worldState->espmFiles));
+    }
+  }
+
+  auto it = resolutions.find(chain);
+  if (it != resolutions.end()) {
+    return it->second;
+  }
+
+  Resolution res;
+  res.sourceIndex.fill(-1);
+
+  auto& loader = worldState->GetEspm();
+  size_t numResolved = 0;
+
+  for (auto formId : chain) {
+    auto lookupResult = loader.GetBrowser().LookupById(formId);
+    auto npc = espm::Convert<espm::NPC_>(lookupResult.rec);
+    if (!npc) {
+      break;
+    }
+
+    const auto& npcData = loader.GetDecodedRecordCache().Get(formId, npc);
+    auto elementIndex = static_cast<int32_t>(res.elements.size());
+    res.elements.push_back({ formId, lookupResult, &npcData });
+
+    for (size_t i = 0; i < kNumTemplateFlags; ++i) {
+      if (res.sourceIndex[i] != -1) {
+        continue;
+      }
+      if (npcData.baseTemplate == 0 ||
+          !(npcData.templateDataFlags & (1 << i))) {
+        res.sourceIndex[i] = elementIndex;
+        ++numResolved;
+      }
+    }
+
+    if (numResolved == kNumTemplateFlags) {
+      break;
+    }
+  }
+
+  return resolutions.emplace(std::move(chain), std::move(res)).first->second;
+}
+
+size_t TemplateChainCache::GetSize() const noexcept
+{
+  return resolutions.size();
+}
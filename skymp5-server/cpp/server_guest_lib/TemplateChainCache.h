@@ -0,0 +1,78 @@
+#pragma once
+#include "ActorValues.h"
+#include "libespm/LookupResult.h"
+#include "libespm/NPC_.h"
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
+class WorldState;
+struct FormDesc;
+
+// Memoizes template chain walks. For every distinct (baseId, templateChain)
+// the chain is walked once, resolving all template flags at the same time.
+// Results only depend on ESP data, so WorldState drops the cache in
+// AttachEspm and nowhere else
+class TemplateChainCache
+{
+public:
+  static constexpr size_t kNumTemplateFlags = 13;
+
+  struct Element
+  {
+    uint32_t formId = 0;
+    espm::LookupResult lookupResult;
+
+    // Owned by the DecodedRecordCache of the Loader
+    const espm::NPC_::Data* data = nullptr;
+  };
+
+  struct Resolution
+  {
+    // NPC_ records of the chain that were visited, in chain order. The walk
+    // stops at the first non-NPC_ element or when all flags are resolved
+    std::vector<Element> elements;
+
+    // Index in 'elements' of the record providing data for each template
+    // flag, -1 if EvaluateTemplate fails for the flag
+    std::array<int32_t, kNumTemplateFlags> sourceIndex;
+
+    // Memoized GetBaseActorValues results by raceIdOverride
+    std::unordered_map<uint32_t, ActorValues> baseActorValues;
+
+    // nullptr if EvaluateTemplate fails for the flag. templateFlag is one of
+    // espm::NPC_::TemplateFlags
+    const Element* FindSource(uint16_t templateFlag) const;
+
+    bool IsFullyResolved() const noexcept;
+  };
+
+  // Flag bit position, i.e. UseTraits (0x01) is 0 and UseKeywords is 12
+  static constexpr std::optional<size_t> GetFlagIndex(
+    uint16_t templateFlag) noexcept
+  {
+    if (!std::has_single_bit(templateFlag)) {
+      return std::nullopt;
+    }
+    auto res = static_cast<size_t>(std::countr_zero(templateFlag));
+    if (res >= kNumTemplateFlags) {
+      return std::nullopt;
+    }
+    return res;
+  }
+
+  // Keys are combined form ids of the chain, or just baseId if templateChain
+  // is empty (like in EvaluateTemplate)
+  Resolution& Resolve(WorldState* worldState, uint32_t baseId,
+                      const std::vector<FormDesc>& templateChain);
+
+  size_t GetSize() const noexcept;
+
+private:
+  std::map<std::vector<uint32_t>, Resolution> resolutions;
+};
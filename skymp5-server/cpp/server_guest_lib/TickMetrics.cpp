@@ -0,0 +1,274 @@
+#include "TickMetrics.h"
+#include "MinPacketId.h"
+#include <array>
+#include <prometheus/core.h>
+#include <prometheus/counter.h>
+#include <prometheus/histogram.h>
+#include <vector>
+
+namespace {
+constexpr size_t kNumPhases = static_cast<size_t>(TickMetrics::Phase::Count);
+constexpr size_t kNumMsgTypes = static_cast<size_t>(MsgType::Max);
+
+// From 10 microseconds (a single cheap message) to a second (a stalled tick)
+const std::vector<double> kSecondsBuckets = {
+  0.00001, 0.000025, 0.00005, 0.0001, 0.00025, 0.0005, 0.001, 0.0025,
+  0.005,   0.01,     0.025,   0.05,   0.1,     0.25,   0.5,   1,
+};
+
+using Histogram = prometheus::Histogram<double>;
+using Counter = prometheus::Counter<uint64_t>;
+
+struct TrafficCounters
+{
+  Counter* numMessages = nullptr;
+  Counter* numBytes = nullptr;
+};
+}
+
+struct TickMetrics::Impl
+{
+  std::shared_ptr<prometheus::Registry> registry;
+
+  prometheus::CustomFamily<Histogram>* phaseFamily = nullptr;
+  prometheus::CustomFamily<Histogram>* messageHandlingFamily = nullptr;
+  prometheus::CustomFamily<Counter>* receivedMessagesFamily = nullptr;
+  prometheus::CustomFamily<Counter>* receivedBytesFamily = nullptr;
+  prometheus::CustomFamily<Counter>* sentMessagesFamily = nullptr;
+  prometheus::CustomFamily<Counter>* sentBytesFamily = nullptr;
+
+  // Label instances are added on first use, so that message types that are
+  // never seen don't produce empty series
+  std::array<Histogram*, kNumPhases> phases = {};
+  std::array<Histogram*, kNumMsgTypes> messageHandling = {};
+  std::array<TrafficCounters, kNumMsgTypes> received = {};
+  std::array<TrafficCounters, kNumMsgTypes> sent = {};
+
+  TrafficCounters& GetTrafficCounters(
+    std::array<TrafficCounters, kNumMsgTypes>& counters,
+    prometheus::CustomFamily<Counter>& messagesFamily,
+    prometheus::CustomFamily<Counter>& bytesFamily, MsgType msgType)
+  {
+    auto& res = counters[static_cast<size_t>(msgType)];
+    if (!res.numMessages) {
+      const char* name = GetMsgTypeName(msgType);
+      res.numMessages = &messagesFamily.Add({ { "msg_type", name } });
+      res.numBytes = &bytesFamily.Add({ { "msg_type", name } });
+    }
+    return res;
+  }
+};
+
+TickMetrics::TickMetrics() = default;
+
+TickMetrics::~TickMetrics() = default;
+
+void TickMetrics::AttachRegistry(
+  std::shared_ptr<prometheus::Registry> registry)
+{
+  if (!registry) {
+    pImpl.reset();
+    return;
+  }
+
+  auto impl = std::make_unique<Impl>();
+  impl->registry = registry;
+  impl->phaseFamily = &registry->Add<Histogram>(
+    "skymp_server_tick_phase_seconds",
+    "Time spent in each phase of the server tick. Phases nest, see "
+    "TickMetrics.h");
+  impl->messageHandlingFamily = &registry->Add<Histogram>(
+    "skymp_server_message_handling_seconds",
+    "Time spent on parsing and handling of a single received message");
+  impl->receivedMessagesFamily = &registry->Add<Counter>(
+    "skymp_server_received_messages_total",
+    "Count of received messages by message type");
+  impl->receivedBytesFamily = &registry->Add<Counter>(
+    "skymp_server_received_bytes_total",
+    "Size of received messages by message type");
+  impl->sentMessagesFamily = &registry->Add<Counter>(
+    "skymp_server_sent_messages_total",
+    "Count of sent messages by message type, before batching");
+  impl->sentBytesFamily = &registry->Add<Counter>(
+    "skymp_server_sent_bytes_total",
+    "Size of sent messages by message type, before batching");
+  pImpl = std::move(impl);
+}
+
+void TickMetrics::ObservePhase(Phase phase,
+                               std::chrono::steady_clock::duration d)
+{
+  if (!pImpl || phase >= Phase::Count) {
+    return;
+  }
+
+  auto& histogram = pImpl->phases[static_cast<size_t>(phase)];
+  if (!histogram) {
+    histogram = &pImpl->phaseFamily->Add({ { "phase", GetPhaseName(phase) } },
+                                         kSecondsBuckets);
+  }
+  histogram->Observe(std::chrono::duration<double>(d).count());
+}
+
+void TickMetrics::ObserveMessageHandling(MsgType msgType,
+                                         std::chrono::steady_clock::duration d)
+{
+  if (!pImpl || msgType >= MsgType::Max) {
+    return;
+  }
+
+  auto& histogram = pImpl->messageHandling[static_cast<size_t>(msgType)];
+  if (!histogram) {
+    histogram = &pImpl->messageHandlingFamily->Add(
+      { { "msg_type", GetMsgTypeName(msgType) } }, kSecondsBuckets);
+  }
+  histogram->Observe(std::chrono::duration<double>(d).count());
+}
+
+void TickMetrics::CountReceived(MsgType msgType, size_t numBytes)
+{
+  if (!pImpl || msgType >= MsgType::Max) {
+    return;
+  }
+
+  auto& counters = pImpl->GetTrafficCounters(
+    pImpl->received, *pImpl->receivedMessagesFamily,
+    *pImpl->receivedBytesFamily, msgType);
+  counters.numMessages->Increment();
+  counters.numBytes->Increment(numBytes);
+}
+
+void TickMetrics::CountSent(MsgType msgType, size_t numBytes)
+{
+  if (!pImpl || msgType >= MsgType::Max) {
+    return;
+  }
+
+  auto& counters =
+    pImpl->GetTrafficCounters(pImpl->sent, *pImpl->sentMessagesFamily,
+                              *pImpl->sentBytesFamily, msgType);
+  counters.numMessages->Increment();
+  counters.numBytes->Increment(numBytes);
+}
+
+MsgType TickMetrics::GetMsgType(const uint8_t* packet, size_t length) noexcept
+{
+  if (length < 2 || packet[0] != Networking::MinPacketId ||
+      packet[1] >= static_cast<uint8_t>(MsgType::Max)) {
+    return MsgType::Invalid;
+  }
+  return static_cast<MsgType>(packet[1]);
+}
+
+const char* TickMetrics::GetPhaseName(Phase phase) noexcept
+{
+  switch (phase) {
+    case Phase::Tick:
+      return "tick";
+    case Phase::PacketReceive:
+      return "packet_receive";
+    case Phase::PartOneTick:
+      return "part_one_tick";
+    case Phase::PacketHistoryPlayback:
+      return "packet_history_playback";
+    case Phase::DeferredMessages:
+      return "deferred_messages";
+    case Phase::WorldStateTick:
+      return "world_state_tick";
+    case Phase::SaveStorage:
+      return "save_storage";
+    case Phase::Timers:
+      return "timers";
+    case Phase::ChunkStreaming:
+      return "chunk_streaming";
+    case Phase::ChunkLoad:
+      return "chunk_load";
+    case Phase::FlushBatches:
+      return "flush_batches";
+    case Phase::PapyrusEvent:
+      return "papyrus_event";
+    default:
+      return "unknown";
+  }
+}
+
+const char* TickMetrics::GetMsgTypeName(MsgType msgType) noexcept
+{
+  static constexpr const char* kNames[] = {
+    "Invalid",
+    "CustomPacket",
+    "UpdateMovement",
+    "UpdateAnimation",
+    "UpdateAppearance",
+    "UpdateEquipment",
+    "Activate",
+    "UpdateProperty",
+    "PutItem",
+    "TakeItem",
+    "FinishSpSnippet",
+    "OnEquip",
+    "ConsoleCommand",
+    "CraftItem",
+    "Host",
+    "CustomEvent",
+    "ChangeValues",
+    "OnHit",
+    "DeathStateContainer",
+    "DropItem",
+    "Teleport",
+    "OpenContainer",
+    "PlayerBowShot",
+    "SpellCast",
+    "UpdateAnimVariables",
+    "DestroyActor",
+    "HostStart",
+    "HostStop",
+    "SetInventory",
+    "SetRaceMenuOpen",
+    "SpSnippet",
+    "Teleport2",
+    "UpdateGamemodeData",
+    "CreateActor",
+    "UpdateMovementCompact",
+    "Bundle",
+    "ServerFeatures",
+  };
+  static_assert(std::size(kNames) == kNumMsgTypes,
+                "Update kNames after changing MsgType");
+
+  auto i = static_cast<size_t>(msgType);
+  return i < kNumMsgTypes ? kNames[i] : "Unknown";
+}
+
+TickMetrics::ScopedTimer::ScopedTimer(TickMetrics& metrics_, Phase phase_)
+  : metrics(metrics_.IsEnabled() ? &metrics_ : nullptr)
+  , phase(phase_)
+{
+  if (metrics) {
+    start = std::chrono::steady_clock::now();
+  }
+}
+
+TickMetrics::ScopedTimer::ScopedTimer(TickMetrics& metrics_,
+                                      MsgType msgType_)
+  : metrics(metrics_.IsEnabled() ? &metrics_ : nullptr)
+  , msgType(msgType_)
+{
+  if (metrics) {
+    start = std::chrono::steady_clock::now();
+  }
+}
+
+TickMetrics::ScopedTimer::~ScopedTimer()
+{
+  if (!metrics) {
+    return;
+  }
+
+  auto d = std::chrono::steady_clock::now() - start;
+  if (phase != Phase::Count) {
+    metrics->ObservePhase(phase, d);
+  } else {
+    metrics->ObserveMessageHandling(msgType, d);
+  }
+}
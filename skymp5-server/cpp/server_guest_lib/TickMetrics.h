@@ -0,0 +1,81 @@
+#pragma once
+#include "MsgType.h"
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+namespace prometheus {
+class Registry;
+}
+
+// Where the server tick goes. Phases of ScampServer::Tick are measured with
+// ScopedTimer and observed into Prometheus histograms, traffic is counted
+// per message type. Everything is a no-op until a registry is attached, so
+// unit tests and bots don't pay for it.
+// Phases nest: PacketReceive includes message handling, which may include
+// ChunkLoad and PapyrusEvent
+class TickMetrics
+{
+public:
+  enum class Phase
+  {
+    Tick,
+    PacketReceive,
+    PartOneTick,
+    PacketHistoryPlayback,
+    DeferredMessages,
+    WorldStateTick,
+    SaveStorage,
+    Timers,
+    ChunkStreaming,
+    ChunkLoad,
+    FlushBatches,
+    PapyrusEvent,
+
+    Count
+  };
+
+  TickMetrics();
+  ~TickMetrics();
+
+  void AttachRegistry(std::shared_ptr<prometheus::Registry> registry);
+  bool IsEnabled() const noexcept { return pImpl != nullptr; }
+
+  void ObservePhase(Phase phase, std::chrono::steady_clock::duration d);
+  void ObserveMessageHandling(MsgType msgType,
+                              std::chrono::steady_clock::duration d);
+  void CountReceived(MsgType msgType, size_t numBytes);
+  void CountSent(MsgType msgType, size_t numBytes);
+
+  // Message type of a serialized packet (MinPacketId + message). JSON
+  // packets aren't parsed and are reported as MsgType::Invalid
+  static MsgType GetMsgType(const uint8_t* packet, size_t length) noexcept;
+
+  static const char* GetPhaseName(Phase phase) noexcept;
+  static const char* GetMsgTypeName(MsgType msgType) noexcept;
+
+  class ScopedTimer
+  {
+  public:
+    ScopedTimer(TickMetrics& metrics, Phase phase);
+    ScopedTimer(TickMetrics& metrics, MsgType msgType);
+    ~ScopedTimer();
+
+  private:
+    ScopedTimer(const ScopedTimer&) = delete;
+    ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+    TickMetrics* const metrics; // nullptr if disabled
+    const Phase phase = Phase::Count;
+    const MsgType msgType = MsgType::Invalid;
+    std::chrono::steady_clock::time_point start;
+  };
+
+private:
+  TickMetrics(const TickMetrics&) = delete;
+  TickMetrics& operator=(const TickMetrics&) = delete;
+
+  struct Impl;
+  std::unique_ptr<Impl> pImpl;
+};
@@ -1,21 +1,28 @@
 #include "WorldState.h"
+#include "ChunkStreamer.h"
+#include "EspmRefFilter.h"
 #include "EvaluateTemplate.h"
 #include "FormCallbacks.h"
+#include "LeveledListCache.h"
 #include "LeveledListUtils.h"
 #include "LocationalDataUtils.h"
 #include "MpActor.h"
 #include "MpChangeForms.h"
 #include "MpObjectReference.h"
+#include "TemplateChainCache.h"
+#include "TickMetrics.h"
 #include "libespm/GroupUtils.h"
 #include "papyrus-vm/Reader.h"
 #include "papyrus-vm/Utils.h"
 #include "script_classes/PapyrusClassesFactory.h"
 #include "script_compatibility_policies/PapyrusCompatibilityPolicyFactory.h"
 #include "script_storages/IScriptStorage.h"
+#include "script_storages/PexScriptCache.h"
 #include <ScopedTask.h>
 #include <Timer.h>
 #include <algorithm>
 #include <antigo/Context.h>
+#include <cstdlib>
 #include <deque>
 #include <fmt/format.h>
 #include <fmt/ranges.h>
@@ -45,6 +52,8 @@ struct WorldState::Impl
     Viet::ISaveStorage<MpChangeForm, FormDesc, std::vector<FormDesc>>>
     saveStorage;
   std::shared_ptr<IScriptStorage> scriptStorage;
+  std::shared_ptr<PexScriptCache> pexScriptCache =
+    std::make_shared<PexScriptCache>();
   bool saveStorageBusy = false;
   std::shared_ptr<VirtualMachine> vm;
   uint32_t nextId = 0xff000000;
@@ -58,6 +67,17 @@ struct WorldState::Impl
   std::array<std::shared_ptr<std::vector<uint32_t>>, 0x100>
     allFormsByModIndexCache;
   std::vector<uint32_t> attachEspmRecordFailures;
+
+  std::unique_ptr<ChunkStreamer> chunkStreamer;
+  std::chrono::microseconds chunkStreamingTickBudget{ 0 };
+  std::deque<ChunkStreamer::PreparedChunk> chunksToAttach;
+  size_t nextCandidateToAttach = 0;
+
+  std::unique_ptr<TemplateChainCache> templateChainCache;
+  std::unique_ptr<LeveledListCache> leveledListCache;
+  std::mt19937 randomEngine{ std::random_device{}() };
+
+  TickMetrics tickMetrics;
 };
 
 WorldState::WorldState()
@@ -71,6 +91,8 @@ WorldState::WorldState()
 
 void WorldState::Clear()
 {
+  pImpl->chunkStreamer.reset();
+  pImpl->chunksToAttach.clear();
   forms.clear();
   grids.clear();
   formIdxManager.reset();
@@ -86,8 +108,10 @@ void WorldState::AttachEspm(espm::Loader* espm_,
 {
   espm = espm_;
   formCallbacksFactory = formCallbacksFactory_;
-  espmCache.reset(new espm::CompressedFieldsCache);
   espmFiles = espm->GetFileNames();
+  pImpl->templateChainCache = std::make_unique<TemplateChainCache>();
+  pImpl->leveledListCache =
+    std::make_unique<LeveledListCache>(espm->GetBrowser());
 }
 
 void WorldState::AttachSaveStorage(
@@ -150,9 +174,30 @@ void WorldState::AddForm(std::unique_ptr<MpForm> form, uint32_t formId,
 
 void WorldState::Tick()
 {
+  auto& metrics = pImpl->tickMetrics;
+  TickMetrics::ScopedTimer tickTimer(metrics,
+                                     TickMetrics::Phase::WorldStateTick);
+
   const auto now = std::chrono::system_clock::now();
-  TickSaveStorage(now);
-  TickTimers(now);
+  {
+    TickMetrics::ScopedTimer timer(metrics, TickMetrics::Phase::SaveStorage);
+    TickSaveStorage(now);
+  }
+  {
+    TickMetrics::ScopedTimer timer(metrics, TickMetrics::Phase::Timers);
+    TickTimers(now);
+  }
+  {
+    TickMetrics::ScopedTimer timer(metrics,
+                                   TickMetrics::Phase::ChunkStreaming);
+    TickChunkStreaming();
+  }
+
+  // Record data isn't kept between ticks, so least recently used
+  // decompressed fields can be evicted now (if a budget is set)
+  if (espm) {
+    espm->GetBrowser().GetCache().Trim();
+  }
 }
 
 void WorldState::LoadChangeForm(const MpChangeForm& changeForm,
@@ -287,7 +332,7 @@ void WorldState::RequestReloot(MpObjectReference& ref,
   });
 }
 
-void WorldState::RequestSave(MpObjectReference& ref)
+void WorldState::RequestSave(MpObjectReference& ref, uint32_t fieldGroups)
 {
   if (pImpl->formLoadingInProgress) {
     return;
@@ -303,7 +348,15 @@ void WorldState::RequestSave(MpObjectReference& ref)
     pImpl->changesByIdx.resize(idx + 1);
   }
 
-  pImpl->changesByIdx[idx] = ref.GetChangeForm();
+  // Groups of a request that hasn't reached the save storage yet still have
+  // to be saved
+  auto& pending = pImpl->changesByIdx[idx];
+  if (pending) {
+    fieldGroups |= pending->dirtyFieldGroups;
+  }
+
+  pending = ref.GetChangeForm();
+  pending->dirtyFieldGroups = fieldGroups;
   pImpl->changesByIdxEmpty = false;
 }
 
@@ -371,78 +424,52 @@ bool WorldState::AttachEspmRecord(const espm::CombineBrowser& br,
                                   std::stringstream* optionalOutTrace)
 {
   auto& cache = GetEspmCache();
-  // this place is a hotpath.
-  // we want to use reinterpret_cast<> instead of espm::Convert<>
-  // in order to reduce amount of generated assembly code
-  auto* refr = reinterpret_cast<const espm::REFR*>(record);
-  auto data = refr->GetData(cache);
-
-  uint32_t baseId = espm::utils::GetMappedId(data.baseId, mapping);
-  espm::LookupResult base = br.LookupById(baseId);
-  if (!base.rec) {
-    logger->info("baseId {} {}", baseId, static_cast<const void*>(base.rec));
-    if (optionalOutTrace) {
-      *optionalOutTrace << fmt::format(
-        "AttachEspmRecord - base record not found {:x} \n", baseId);
-    }
-    return false;
-  }
 
-  espm::Type t = base.rec->GetType();
-  bool isNpc = t == "NPC_";
-  bool isFurniture = t == "FURN";
-  bool isActivator = t == "ACTI";
-  bool isDoor = t == "DOOR";
-  bool isContainer = t == "CONT";
-  bool isFlor = t == "FLOR" &&
-    reinterpret_cast<const espm::FLOR*>(base.rec)->GetData(cache).resultItem;
-  bool isTree = t == "TREE" &&
-    reinterpret_cast<const espm::TREE*>(base.rec)->GetData(cache).resultItem;
-
-  if (!isNpc && !isFurniture && !isActivator && !espm::utils::IsItem(t) &&
-      !isDoor && !isContainer && !isFlor && !isTree) {
-    if (optionalOutTrace) {
-      *optionalOutTrace << fmt::format(
-        "AttachEspmRecord - the server skips base type {} \n", t.ToString());
-    }
-    return false;
-  }
+  auto filtered = EspmRefFilter::Check(br, record, mapping, cache);
+  auto& data = filtered.data;
+  uint32_t baseId = filtered.baseId;
+  espm::LookupResult base = filtered.base;
+  bool isNpc = filtered.isNpc;
 
-  bool startsDead = false;
-  if (isNpc) {
-    auto* achr = reinterpret_cast<const espm::ACHR*>(record);
-    startsDead = achr->StartsDead();
-    if (startsDead) {
+  const char* skipReason = nullptr;
+  switch (filtered.verdict) {
+    case EspmRefFilter::Verdict::Accepted:
+      break;
+    case EspmRefFilter::Verdict::BaseNotFound:
+      logger->info("baseId {} {}", baseId,
+                   static_cast<const void*>(base.rec));
       if (optionalOutTrace) {
         *optionalOutTrace << fmt::format(
-          "AttachEspmRecord - the server skips dead actors\n");
+          "AttachEspmRecord - base record not found {:x} \n", baseId);
       }
-      return false; // TODO: Load dead references
-    }
+      return false;
+    case EspmRefFilter::Verdict::SkippedBaseType:
+      if (optionalOutTrace) {
+        *optionalOutTrace << fmt::format(
+          "AttachEspmRecord - the server skips base type {} \n",
+          base.rec->GetType().ToString());
+      }
+      return false;
+    case EspmRefFilter::Verdict::StartsDead:
+      skipReason = "dead actors";
+      break;
+    case EspmRefFilter::Verdict::InitiallyDisabled:
+      skipReason = "initially disabled references";
+      break;
+    case EspmRefFilter::Verdict::Deleted:
+      skipReason = "deleted references";
+      break;
   }
 
-  // TODO: Load disabled references
-  enum
-  {
-    InitiallyDisabled = 0x800,
-    DeletedRecord = 0x20
-  };
-
-  if (refr->GetFlags() & InitiallyDisabled) {
+  if (skipReason) {
     if (optionalOutTrace) {
       *optionalOutTrace << fmt::format(
-        "AttachEspmRecord - the server skips initially disabled references\n");
+        "AttachEspmRecord - the server skips {}\n", skipReason);
     }
     return false;
   }
 
-  if (refr->GetFlags() & DeletedRecord) {
-    if (optionalOutTrace) {
-      *optionalOutTrace << fmt::format(
-        "AttachEspmRecord - the server skips deleted references\n");
-    }
-    return false;
-  }
+  espm::Type t = base.rec->GetType();
 
   if (!npcEnabled && isNpc) {
     if (optionalOutTrace) {
@@ -828,6 +855,9 @@ void WorldState::SendPapyrusEvent(MpForm* form, const char* eventName,
     }
   }
 
+  TickMetrics::ScopedTimer timer(pImpl->tickMetrics,
+                                 TickMetrics::Phase::PapyrusEvent);
+
   VirtualMachine::OnEnter onEnter = [&](const StackData& stackData) {
     pImpl->policy->BeforeSendPapyrusEvent(
       form, eventName, arguments, argumentsCount,
@@ -837,9 +867,26 @@ void WorldState::SendPapyrusEvent(MpForm* form, const char* eventName,
   return vm.SendEvent(form->ToGameObject(), eventName, args, onEnter);
 }
 
-const std::set<MpObjectReference*>& WorldState::GetNeighborsByPosition(
+std::set<MpObjectReference*> WorldState::GetNeighborsByPosition(
   uint32_t cellOrWorld, int16_t cellX, int16_t cellY)
 {
+  LoadChunksAround(cellOrWorld, cellX, cellY);
+
+  return grids[cellOrWorld].grid->GetNeighboursByPosition(cellX, cellY);
+}
+
+void WorldState::LoadChunksAround(uint32_t cellOrWorld, int16_t cellX,
+                                  int16_t cellY)
+{
+  if (espm && !pImpl->chunkLoadingInProgress && pImpl->chunkStreamer) {
+    for (int16_t x = cellX - 1; x <= cellX + 1; ++x) {
+      for (int16_t y = cellY - 1; y <= cellY + 1; ++y) {
+        RequestChunk(cellOrWorld, x, y);
+      }
+    }
+    return;
+  }
+
   if (espm && !pImpl->chunkLoadingInProgress) {
     Viet::ScopedTask<bool> task([](bool& st) { st = false; },
                                 pImpl->chunkLoadingInProgress);
@@ -850,6 +897,8 @@ const std::set<MpObjectReference*>& WorldState::GetNeighborsByPosition(
       for (int16_t y = cellY - 1; y <= cellY + 1; ++y) {
         const bool loaded = grids[cellOrWorld].loadedChunks[x][y];
         if (!loaded) {
+          TickMetrics::ScopedTimer timer(pImpl->tickMetrics,
+                                         TickMetrics::Phase::ChunkLoad);
           for (size_t i = 0; i < espmFiles.size(); ++i) {
             auto combMapping = br.GetCombMapping(i);
             auto rawMapping = br.GetRawMapping(i);
@@ -870,10 +919,116 @@ const std::set<MpObjectReference*>& WorldState::GetNeighborsByPosition(
       }
     }
   }
+}
+
+void WorldState::EnableChunkStreaming(std::chrono::microseconds tickBudget)
+{
+  if (!espm) {
+    throw std::runtime_error("EnableChunkStreaming requires espm attached");
+  }
+
+  pImpl->chunkStreamingTickBudget = tickBudget;
+  if (!pImpl->chunkStreamer) {
+    pImpl->chunkStreamer = std::make_unique<ChunkStreamer>(
+      espm->GetBrowser(), espmFiles.size());
+  }
+}
+
+void WorldState::PrefetchChunks(uint32_t cellOrWorld,
+                                std::pair<int16_t, int16_t> from,
+                                std::pair<int16_t, int16_t> to)
+{
+  if (!espm || !pImpl->chunkStreamer) {
+    return;
+  }
+
+  const int dx = to.first - from.first;
+  const int dy = to.second - from.second;
+
+  // Half of the ring at distance 2 that faces the direction of movement.
+  // The 3x3 area around `to` is already requested by LoadChunksAround
+  for (int i = -2; i <= 2; ++i) {
+    for (int j = -2; j <= 2; ++j) {
+      bool onRing = std::abs(i) == 2 || std::abs(j) == 2;
+      if (onRing && i * dx + j * dy > 0) {
+        RequestChunk(cellOrWorld, static_cast<int16_t>(to.first + i),
+                     static_cast<int16_t>(to.second + j));
+      }
+    }
+  }
+}
+
+size_t WorldState::GetNumPendingChunks() const
+{
+  if (!pImpl->chunkStreamer) {
+    return 0;
+  }
+  return pImpl->chunkStreamer->GetNumPending() + pImpl->chunksToAttach.size();
+}
 
-  auto& neighbours =
-    grids[cellOrWorld].grid->GetNeighboursByPosition(cellX, cellY);
-  return neighbours;
+void WorldState::RequestChunk(uint32_t cellOrWorld, int16_t cellX,
+                              int16_t cellY)
+{
+  auto& gridInfo = grids[cellOrWorld];
+  if (gridInfo.loadedChunks[cellX][cellY] ||
+      gridInfo.requestedChunks[cellX][cellY]) {
+    return;
+  }
+  gridInfo.requestedChunks[cellX][cellY] = true;
+  pImpl->chunkStreamer->Request({ cellOrWorld, cellX, cellY });
+}
+
+void WorldState::TickChunkStreaming()
+{
+  if (!pImpl->chunkStreamer) {
+    return;
+  }
+
+  // References attached here must not trigger loading of their own
+  // neighbourhood, same as in the synchronous LoadChunksAround
+  Viet::ScopedTask<bool> task([](bool& st) { st = false; },
+                              pImpl->chunkLoadingInProgress);
+  pImpl->chunkLoadingInProgress = true;
+
+  const auto deadline =
+    std::chrono::steady_clock::now() + pImpl->chunkStreamingTickBudget;
+
+  while (true) {
+    if (pImpl->chunksToAttach.empty()) {
+      ChunkStreamer::PreparedChunk chunk;
+      if (!pImpl->chunkStreamer->TryPop(chunk)) {
+        return;
+      }
+      pImpl->attachEspmRecordFailures.insert(
+        pImpl->attachEspmRecordFailures.end(), chunk.rejectedFormIds.begin(),
+        chunk.rejectedFormIds.end());
+      pImpl->chunksToAttach.push_back(std::move(chunk));
+      pImpl->nextCandidateToAttach = 0;
+    }
+
+    // Copy since LoadForm may insert into grids
+    const auto key = pImpl->chunksToAttach.front().key;
+    const auto& candidates = pImpl->chunksToAttach.front().candidateFormIds;
+
+    while (pImpl->nextCandidateToAttach < candidates.size()) {
+      auto formId = candidates[pImpl->nextCandidateToAttach++];
+      if (forms.find(formId) == forms.end()) {
+        LoadForm(formId);
+      }
+
+      // At least one reference per tick is attached even with zero budget
+      if (std::chrono::steady_clock::now() >= deadline) {
+        return;
+      }
+    }
+
+    grids[key.cellOrWorld].loadedChunks[key.x][key.y] = true;
+    pImpl->chunksToAttach.pop_front();
+
+    if (std::chrono::steady_clock::now() >= deadline) {
+      return;
+    }
+  }
 }
 
 std::shared_ptr<std::vector<uint32_t>> WorldState::GetAllForms(
@@ -941,10 +1096,40 @@ bool WorldState::HasEspm() const
 
 espm::CompressedFieldsCache& WorldState::GetEspmCache()
 {
-  if (!espmCache) {
-    throw std::runtime_error("No espm cache found");
+  return GetEspm().GetBrowser().GetCache();
+}
+
+TemplateChainCache& WorldState::GetTemplateChainCache()
+{
+  if (!pImpl->templateChainCache) {
+    // Created along with the espm
+    throw std::runtime_error("No espm attached");
   }
-  return *espmCache;
+  return *pImpl->templateChainCache;
+}
+
+LeveledListCache& WorldState::GetLeveledListCache()
+{
+  if (!pImpl->leveledListCache) {
+    // Created along with the espm
+    throw std::runtime_error("No espm attached");
+  }
+  return *pImpl->leveledListCache;
+}
+
+std::mt19937& WorldState::GetRandomEngine() noexcept
+{
+  return pImpl->randomEngine;
+}
+
+void WorldState::SeedRandomEngine(uint32_t seed)
+{
+  pImpl->randomEngine.seed(seed);
+}
+
+TickMetrics& WorldState::GetTickMetrics()
+{
+  return pImpl->tickMetrics;
 }
 
 IScriptStorage* WorldState::GetScriptStorage() const
@@ -955,43 +1140,79 @@ IScriptStorage* WorldState::GetScriptStorage() const
 struct LazyState
 {
   std::shared_ptr<PexScript> pex;
-  std::vector<uint8_t> pexBin;
+  IScriptStorage::PexBuffer pexBin;
 
   // With Papyrus hotreload enabled, this variable hold references to
   // previous versions of pex files. This prevents the invalidation of
-  // string/identifier types of VarValue
-  std::vector<std::shared_ptr<PexScript>> oldPexHolder;
+  // string/identifier types of VarValue and of latent calls still running
+  // old code. Only the last versions are kept so that reloading a script
+  // over and over doesn't grow memory. Values and calls from older versions
+  // are invalid, hot reload is meant for development anyway
+  struct OldPex
+  {
+    std::shared_ptr<PexScript> pex;
+    IScriptStorage::PexBuffer pexBin;
+  };
+  static constexpr size_t kMaxOldPexVersions = 8;
+  std::deque<OldPex> oldPexHolder;
+
+  void ReplacePex(std::shared_ptr<PexScript> newPex,
+                  PexScriptCache& pexScriptCache)
+  {
+    oldPexHolder.push_back({ std::move(pex), pexBin });
+    pex = std::move(newPex);
+
+    if (oldPexHolder.size() <= kMaxOldPexVersions) {
+      return;
+    }
+
+    auto released = std::move(oldPexHolder.front());
+    oldPexHolder.pop_front();
+
+    // The file may have been reverted to the released version
+    auto isInUse = released.pex == pex ||
+      std::any_of(oldPexHolder.begin(), oldPexHolder.end(),
+                  [&](const OldPex& old) { return old.pex == released.pex; });
+    if (!isInUse && released.pexBin) {
+      pexScriptCache.Forget(released.pexBin);
+    }
+  }
 };
 
 PexScript::Lazy CreatePexScriptLazy(
   const CIString& required, std::shared_ptr<IScriptStorage> scriptStorage,
+  std::shared_ptr<PexScriptCache> pexScriptCache,
   std::shared_ptr<spdlog::logger> logger, bool enableHotReload)
 {
   auto lazyState = std::make_shared<LazyState>();
 
   PexScript::Lazy lazy;
   lazy.source = required.data();
-  lazy.fn = [lazyState, scriptStorage, required, logger, enableHotReload]() {
-    if (enableHotReload) {
+  lazy.fn = [lazyState, scriptStorage, pexScriptCache, required, logger,
+             enableHotReload]() {
+    if (enableHotReload && lazyState->pex) {
+      // Storages return the same buffer until the file changes
       auto requiredPex = scriptStorage->GetScriptPex(required.data());
       if (requiredPex != lazyState->pexBin) {
-        lazyState->oldPexHolder.push_back(lazyState->pex);
-        lazyState->pex.reset();
+        auto pex = requiredPex ? pexScriptCache->Get(requiredPex) : nullptr;
+        if (pex != lazyState->pex) {
+          lazyState->ReplacePex(pex, *pexScriptCache);
+          logger->info("Papyrus script {} has been reloaded", required);
+        }
         lazyState->pexBin = requiredPex;
-        logger->info("Papyrus script {} has been reloaded", required);
       }
     }
 
     if (!lazyState->pex) {
       auto requiredPex = scriptStorage->GetScriptPex(required.data());
-      if (requiredPex.empty()) {
+      if (!requiredPex) {
         throw std::runtime_error(
           "'" + std::string({ required.begin(), required.end() }) +
           "' is listed but failed to "
           "load from the storage");
       }
-      auto pexStructure = Reader({ requiredPex }).GetSourceStructures();
-      lazyState->pex = pexStructure[0];
+      lazyState->pex = pexScriptCache->Get(requiredPex);
+      lazyState->pexBin = requiredPex;
     }
     return lazyState->pex;
   };
@@ -1013,10 +1234,21 @@ VirtualMachine& WorldState::GetPapyrusVm()
       return *pImpl->vm;
     }
 
+    auto pexScriptCache = pImpl->pexScriptCache;
     auto& scripts = scriptStorage->ListScripts(false);
+    if (isPapyrusPreloadEnabled) {
+      auto was = std::chrono::steady_clock::now();
+      pexScriptCache->Preload(*scriptStorage, scripts);
+      auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - was);
+      logger->info("Preloaded {} Papyrus scripts in {} ms",
+                   pexScriptCache->GetNumScripts(), ms.count());
+    }
+
     for (auto& required : scripts) {
-      auto lazy = CreatePexScriptLazy(required, scriptStorage, this->logger,
-                                      this->isPapyrusHotReloadEnabled);
+      auto lazy =
+        CreatePexScriptLazy(required, scriptStorage, pexScriptCache,
+                            this->logger, this->isPapyrusHotReloadEnabled);
       pexStructures.push_back(lazy);
     }
 
@@ -1024,14 +1256,14 @@ VirtualMachine& WorldState::GetPapyrusVm()
       pImpl->vm.reset(new VirtualMachine(pexStructures));
 
       pImpl->vm->SetMissingScriptHandler(
-        [scriptStorage, this](std::string className) {
+        [scriptStorage, pexScriptCache, this](std::string className) {
           std::optional<PexScript::Lazy> result;
 
           CIString classNameCi = { className.begin(), className.end() };
           if (scriptStorage->ListScripts(true).count(classNameCi)) {
-            result =
-              CreatePexScriptLazy(classNameCi, scriptStorage, this->logger,
-                                  this->isPapyrusHotReloadEnabled);
+            result = CreatePexScriptLazy(classNameCi, scriptStorage,
+                                         pexScriptCache, this->logger,
+                                         this->isPapyrusHotReloadEnabled);
           }
           return result;
         });
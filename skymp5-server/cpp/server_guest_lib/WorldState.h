@@ -1,13 +1,13 @@
 #pragma once
 #include "ConditionsEvaluator.h" // ConditionsEvaluatorSettings
 #include "FormIndex.h"
-#include "Grid.h"
 #include "GridElement.h"
 #include "MpChangeForms.h"
 #include "MpForm.h"
 #include "MpObjectReference.h"
 #include "NiPoint3.h"
 #include "PartOneListener.h"
+#include "SpatialHashGrid.h"
 #include "condition_functions/ConditionFunctionMap.h"
 #include "libespm/Loader.h"
 #include "papyrus-vm/VirtualMachine.h"
@@ -21,6 +21,7 @@
 #include <map>
 #include <memory>
 #include <optional>
+#include <random>
 #include <spdlog/spdlog.h>
 #include <sstream>
 #include <unordered_map>
@@ -38,6 +39,9 @@ class ISaveStorage;
 }
 class IScriptStorage;
 class GameModeEvent;
+class TemplateChainCache;
+class LeveledListCache;
+class TickMetrics;
 
 class WorldState
 {
@@ -83,7 +87,10 @@ public:
   void RequestReloot(MpObjectReference& ref,
                      std::chrono::system_clock::duration time);
 
-  void RequestSave(MpObjectReference& ref);
+  // fieldGroups are MpChangeFormField groups changed since the previous
+  // request. Pass MpChangeFormField::All when unsure
+  void RequestSave(MpObjectReference& ref,
+                   uint32_t fieldGroups = MpChangeFormField::All);
   bool HasEspmFile(std::string_view filename) const noexcept;
 
   template <typename T>
@@ -123,9 +130,37 @@ public:
   void SendPapyrusEvent(MpForm* form, const char* eventName,
                         const VarValue* arguments, size_t argumentsCount);
 
-  const std::set<MpObjectReference*>& GetNeighborsByPosition(
+  // Prefer ForEachNeighborByPosition, this builds a set on every call
+  std::set<MpObjectReference*> GetNeighborsByPosition(
     uint32_t cellOrWorld, int16_t cellX, int16_t cellY);
 
+  // Visits references in the 3x3 area around the cell without allocating.
+  // f must not move references or load chunks
+  template <class F>
+  void ForEachNeighborByPosition(uint32_t cellOrWorld, int16_t cellX,
+                                 int16_t cellY, const F& f)
+  {
+    LoadChunksAround(cellOrWorld, cellX, cellY);
+    grids[cellOrWorld].grid->ForEachNeighbour(cellX, cellY, f);
+  }
+
+  // Loads ESP references of the 3x3 area around the cell if not yet loaded.
+  // With chunk streaming enabled only requests them, references are then
+  // attached by Tick within the streaming budget
+  void LoadChunksAround(uint32_t cellOrWorld, int16_t cellX, int16_t cellY);
+
+  // Moves preparation of ESP references to a background thread and limits
+  // time spent on attaching them per Tick. Requires espm to be attached
+  void EnableChunkStreaming(std::chrono::microseconds tickBudget);
+
+  // Requests chunks an actor moving from one cell to an adjacent one is going
+  // to reach next. No-op if chunk streaming is disabled
+  void PrefetchChunks(uint32_t cellOrWorld, std::pair<int16_t, int16_t> from,
+                      std::pair<int16_t, int16_t> to);
+
+  // Number of requested chunks that aren't fully attached yet
+  size_t GetNumPendingChunks() const;
+
   std::shared_ptr<std::vector<uint32_t>> GetAllForms(uint32_t modIndex);
 
   // See LookupFormById comment
@@ -205,7 +240,17 @@ public:
 
   espm::Loader& GetEspm() const;
   bool HasEspm() const;
+  // Shared by everything using the attached espm, see
+  // espm::CompressedFieldsCache for when entries may be evicted
   espm::CompressedFieldsCache& GetEspmCache();
+  TemplateChainCache& GetTemplateChainCache();
+  LeveledListCache& GetLeveledListCache();
+
+  // Randomness of gameplay like loot. Seeded from std::random_device, tests
+  // may reseed it to get deterministic results
+  std::mt19937& GetRandomEngine() noexcept;
+  void SeedRandomEngine(uint32_t seed);
+  TickMetrics& GetTickMetrics();
   IScriptStorage* GetScriptStorage() const;
   VirtualMachine& GetPapyrusVm();
   const std::set<uint32_t>& GetActorsByProfileId(int32_t profileId) const;
@@ -246,6 +291,9 @@ public:
 
   bool isPapyrusHotReloadEnabled = false;
 
+  // Parse all scripts at startup instead of on first use
+  bool isPapyrusPreloadEnabled = false;
+
   bool npcEnabled = false;
   std::unordered_map<std::string, NpcSettingsEntry> npcSettings;
   NpcSettingsEntry defaultSetting;
@@ -280,6 +328,8 @@ private:
                 std::stringstream* optionalOutTrace = nullptr);
   void TickSaveStorage(const std::chrono::system_clock::time_point& now);
   void TickTimers(const std::chrono::system_clock::time_point& now);
+  void TickChunkStreaming();
+  void RequestChunk(uint32_t cellOrWorld, int16_t cellX, int16_t cellY);
   [[nodiscard]] bool NpcSourceFilesOverriden() const noexcept;
   [[nodiscard]] bool IsNpcAllowed(uint32_t refrId) const noexcept;
   [[nodiscard]] uint32_t GetFileIdx(uint32_t formId) const noexcept;
@@ -288,9 +338,10 @@ private:
 private:
   struct GridInfo
   {
-    std::shared_ptr<GridImpl<MpObjectReference*>> grid =
-      std::make_shared<GridImpl<MpObjectReference*>>();
+    std::shared_ptr<SpatialHashGrid<MpObjectReference*>> grid =
+      std::make_shared<SpatialHashGrid<MpObjectReference*>>();
     std::map<int16_t, std::map<int16_t, bool>> loadedChunks;
+    std::map<int16_t, std::map<int16_t, bool>> requestedChunks;
   };
 
   std::unordered_map<uint32_t, std::shared_ptr<MpForm>> forms;
@@ -300,7 +351,6 @@ private:
   std::vector<MpObjectReference*> refrByIdxUnreliable;
   espm::Loader* espm = nullptr;
   FormCallbacksFactory formCallbacksFactory;
-  std::unique_ptr<espm::CompressedFieldsCache> espmCache;
 
   struct Impl;
   std::shared_ptr<Impl> pImpl;
@@ -0,0 +1,157 @@
+#include "BinlogDatabase.h"
+#include "utils/ChangeFormLog.h"
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <save_storages/AsyncSaveStorage.h>
+#include <unordered_set>
+
+// Snapshot and log are both ChangeFormLog files. key is FormDesc::ToString(),
+// payload is compact MpChangeForm::ToJson
+
+namespace {
+// Compaction is triggered once the log outgrows both the snapshot and this
+constexpr uint64_t kMinLogSizeToCompact = 16 * 1024 * 1024;
+}
+
+struct BinlogDatabase::Impl
+{
+  std::filesystem::path snapshotPath;
+  std::shared_ptr<spdlog::logger> logger;
+
+  std::unique_ptr<ChangeFormLog> log;
+  uint64_t snapshotSize = 0;
+
+  void Compact();
+};
+
+void BinlogDatabase::Impl::Compact()
+{
+  auto tempPath = snapshotPath;
+  tempPath += ".tmp";
+
+  {
+    MergedChangeFormLogs merged({ snapshotPath, log->GetPath() });
+
+    std::string buffer;
+    ChangeFormLog::AppendHeader(buffer);
+    for (auto& record : merged.GetRecords()) {
+      ChangeFormLog::AppendRecord(buffer, record.key, record.payload);
+    }
+
+    std::ofstream f(tempPath, std::ios::binary | std::ios::trunc);
+    f.write(buffer.data(), buffer.size());
+    f.close();
+    if (!f) {
+      throw std::runtime_error(
+        fmt::format("Unable to write file {}", tempPath.string()));
+    }
+    logger->info("Compacted {} change forms into {}",
+                 merged.GetRecords().size(), snapshotPath.string());
+    snapshotSize = buffer.size();
+  }
+
+  // The log is truncated only after the snapshot is in place. A crash in
+  // between replays records that are already in the snapshot, which is
+  // harmless
+  std::filesystem::rename(tempPath, snapshotPath);
+  log->Truncate();
+}
+
+BinlogDatabase::BinlogDatabase(std::string directory_,
+                               std::shared_ptr<spdlog::logger> logger_)
+  : pImpl(std::make_shared<Impl>())
+{
+  std::filesystem::path p = directory_;
+  std::filesystem::create_directories(p);
+
+  pImpl->snapshotPath = p / "changeForms.snapshot";
+  pImpl->logger = std::move(logger_);
+
+  std::error_code ec;
+  pImpl->snapshotSize = std::filesystem::file_size(pImpl->snapshotPath, ec);
+  if (ec) {
+    pImpl->snapshotSize = 0;
+  }
+
+  pImpl->log =
+    std::make_unique<ChangeFormLog>(p / "changeForms.log", pImpl->logger);
+}
+
+BinlogDatabase::~BinlogDatabase() = default;
+
+std::vector<std::optional<MpChangeForm>>&& BinlogDatabase::UpsertImpl(
+  std::vector<std::optional<MpChangeForm>>&& changeForms,
+  size_t& outNumUpserted)
+{
+  try {
+    std::string buffer;
+    size_t nUpserted = 0;
+
+    for (auto& changeForm : changeForms) {
+      if (changeForm == std::nullopt) {
+        continue;
+      }
+
+      ChangeFormLog::AppendRecord(buffer, changeForm->formDesc.ToString(),
+                                  MpChangeForm::ToJson(*changeForm).dump());
+      ++nUpserted;
+    }
+
+    pImpl->log->Append(buffer);
+
+    if (pImpl->log->GetSize() >
+        std::max(pImpl->snapshotSize, kMinLogSizeToCompact)) {
+      pImpl->Compact();
+    }
+
+    outNumUpserted = nUpserted;
+    return std::move(changeForms);
+  } catch (std::exception& e) {
+    throw Viet::AsyncSaveStorage<
+      MpChangeForm, FormDesc,
+      std::vector<FormDesc>>::UpsertFailedException(std::move(changeForms),
+                                                    e.what());
+  }
+}
+
+void BinlogDatabase::Iterate(const IterateCallback& iterateCallback,
+                             std::optional<std::vector<FormDesc>> filter)
+{
+  try {
+    std::optional<std::unordered_set<std::string>> filterSet;
+    if (filter) {
+      std::unordered_set<std::string>& value = filterSet.emplace();
+      for (const auto& desc : *filter) {
+        value.insert(desc.ToString());
+      }
+    }
+
+    MergedChangeFormLogs merged(
+      { pImpl->snapshotPath, pImpl->log->GetPath() });
+
+    simdjson::dom::parser parser;
+
+    for (auto& record : merged.GetRecords()) {
+      if (filterSet && !filterSet->count(std::string(record.key))) {
+        continue;
+      }
+
+      try {
+        auto result =
+          parser.parse(record.payload.data(), record.payload.size()).value();
+        auto changeForm = MpChangeForm::JsonToChangeForm(result);
+        iterateCallback(changeForm);
+      } catch (std::exception& e) {
+        pImpl->logger->error("Parsing of {} failed with {}", record.key,
+                             e.what());
+      }
+    }
+
+  } catch (std::exception& e) {
+    throw Viet::AsyncSaveStorage<
+      MpChangeForm, FormDesc,
+      std::vector<FormDesc>>::IterateFailedException(std::move(filter),
+                                                     e.what());
+  }
+}
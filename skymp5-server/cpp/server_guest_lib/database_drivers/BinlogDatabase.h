@@ -0,0 +1,27 @@
+#pragma once
+#include "MpChangeForms.h"
+#include <database_drivers/IDatabase.h>
+#include <spdlog/spdlog.h>
+
+// Stores change forms in two files instead of a file per change form: a
+// compacted snapshot and an append-only log of records upserted since the
+// last compaction. Both are memory-mapped when iterating
+class BinlogDatabase
+  : public Viet::IDatabase<MpChangeForm, FormDesc, std::vector<FormDesc>>
+{
+public:
+  BinlogDatabase(std::string directory_,
+                 std::shared_ptr<spdlog::logger> logger_);
+  ~BinlogDatabase();
+
+  void Iterate(const IterateCallback& iterateCallback,
+               std::optional<std::vector<FormDesc>> filter) override;
+
+private:
+  std::vector<std::optional<MpChangeForm>>&& UpsertImpl(
+    std::vector<std::optional<MpChangeForm>>&& changeForms,
+    size_t& outNumUpserted) override;
+
+  struct Impl;
+  std::shared_ptr<Impl> pImpl;
+};
@@ -4,6 +4,7 @@
 #include <nlohmann/json.hpp>
 #include <spdlog/spdlog.h>
 
+#include "BinlogDatabase.h"
 #include "FileDatabase.h"
 #include "MigrationDatabase.h"
 #include "ZipDatabase.h"
@@ -53,5 +54,14 @@ DatabaseFactory::Create(nlohmann::json settings,
     return std::make_shared<ZipDatabase>(databaseName, logger);
   }
 
+  if (databaseDriver == "binlog") {
+    auto databaseName = settings.count("databaseName")
+      ? settings["databaseName"].get<std::string>()
+      : std::string("world");
+
+    logger->info("Using binlog with name '" + databaseName + "'");
+    return std::make_shared<BinlogDatabase>(databaseName, logger);
+  }
+
   throw std::runtime_error("Unrecognized databaseDriver: " + databaseDriver);
 }
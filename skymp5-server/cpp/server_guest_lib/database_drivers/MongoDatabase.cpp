@@ -90,13 +90,27 @@ std::vector<std::optional<MpChangeForm>>&& MongoDatabase::UpsertImpl(
         continue;
       }
 
-      auto jChangeForm = MpChangeForm::ToJson(*changeForm);
+      // Only fields changed since the previous save are written
+      auto fieldGroups = changeForm->dirtyFieldGroups;
+      auto jChangeForm = MpChangeForm::ToJson(*changeForm, fieldGroups);
+
+      // Keys omitted by ToJson belong to empty optional fields. $set alone
+      // would keep their previous values
+      auto jUnset = nlohmann::json::object();
+      for (auto key : MpChangeForm::GetJsonKeys(fieldGroups)) {
+        if (!jChangeForm.contains(key)) {
+          jUnset[key] = "";
+        }
+      }
 
       auto filter = nlohmann::json::object();
       filter["formDesc"] = changeForm->formDesc.ToString();
 
       auto upd = nlohmann::json::object();
       upd["$set"] = pImpl->jsonSanitizer->SanitizeJsonRecursive(jChangeForm);
+      if (!jUnset.empty()) {
+        upd["$unset"] = std::move(jUnset);
+      }
 
       bulk.append(mongocxx::model::update_one(
                     { std::move(bsoncxx::from_json(filter.dump())),
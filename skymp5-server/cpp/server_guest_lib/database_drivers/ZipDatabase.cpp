@@ -1,66 +1,188 @@
 #include "ZipDatabase.h"
 
 #include "libzippp/libzippp.h"
+#include "utils/ChangeFormLog.h"
 #include <FileUtils.h>
 #include <MappedBuffer.h>
+#include <atomic>
 #include <filesystem>
 #include <fstream>
 #include <nlohmann/json.hpp>
 #include <save_storages/AsyncSaveStorage.h>
+#include <system_error>
+#include <thread>
 #include <unordered_set>
 
 struct ZipDatabase::Impl
 {
-  Impl(std::string filePath_, std::shared_ptr<spdlog::logger> logger_)
+  Impl(std::string filePath_, std::shared_ptr<spdlog::logger> logger_,
+       uint64_t maxSegmentSize_)
     : filePath(std::move(filePath_))
     , logger(std::move(logger_))
+    , maxSegmentSize(maxSegmentSize_)
+    , mergingPath(filePath + ".segment.merging")
   {
+    segment =
+      std::make_unique<ChangeFormLog>(filePath + ".segment", logger);
   }
 
   std::string filePath;
   std::shared_ptr<spdlog::logger> logger;
+  uint64_t maxSegmentSize = 0;
+
+  // Change forms upserted since the last merge. Keys are archive entry names,
+  // payloads are entry contents
+  std::unique_ptr<ChangeFormLog> segment;
+
+  // A full segment is renamed to this path and merged into the archive by
+  // mergeThread while new upserts go to a fresh segment. A merge that failed
+  // or was interrupted by a crash leaves the file behind, it's retried
+  const std::filesystem::path mergingPath;
+  std::unique_ptr<std::thread> mergeThread;
+  std::atomic<bool> mergeRunning = false;
+
+  void StartMerge();
+  void WaitForMerge();
+
+  // Segments that have records not yet in the archive, older first
+  std::vector<std::filesystem::path> GetUnmergedPaths() const;
+
+  void MergeIntoArchive(const std::vector<std::filesystem::path>& paths);
 };
 
+void ZipDatabase::Impl::StartMerge()
+{
+  if (mergeRunning) {
+    // The segment keeps growing until the merge in progress finishes
+    return;
+  }
+  WaitForMerge();
+
+  if (!std::filesystem::exists(mergingPath)) {
+    auto segmentPath = segment->GetPath();
+    segment.reset();
+    std::error_code ec;
+    std::filesystem::rename(segmentPath, mergingPath, ec);
+    segment = std::make_unique<ChangeFormLog>(segmentPath, logger);
+    if (ec) {
+      return logger->error("Unable to rename {}: {}", segmentPath.string(),
+                           ec.message());
+    }
+  }
+
+  mergeRunning = true;
+  mergeThread = std::make_unique<std::thread>([this] {
+    try {
+      MergeIntoArchive({ mergingPath });
+      std::filesystem::remove(mergingPath);
+    } catch (std::exception& e) {
+      logger->error("Unable to merge {}: {}", mergingPath.string(), e.what());
+    }
+    mergeRunning = false;
+  });
+}
+
+void ZipDatabase::Impl::WaitForMerge()
+{
+  if (mergeThread) {
+    mergeThread->join();
+    mergeThread.reset();
+  }
+}
+
+std::vector<std::filesystem::path> ZipDatabase::Impl::GetUnmergedPaths()
+  const
+{
+  std::vector<std::filesystem::path> res;
+  if (std::filesystem::exists(mergingPath)) {
+    res.push_back(mergingPath);
+  }
+  res.push_back(segment->GetPath());
+  return res;
+}
+
+void ZipDatabase::Impl::MergeIntoArchive(
+  const std::vector<std::filesystem::path>& paths)
+{
+  auto filePathAbsolute = std::filesystem::absolute(filePath).string();
+
+  // Records point into the mapped segments, which must outlive
+  // archive.close()
+  MergedChangeFormLogs merged(paths);
+
+  libzippp::ZipArchive archive(filePathAbsolute.data());
+  archive.open(libzippp::ZipArchive::Write);
+
+  for (auto& record : merged.GetRecords()) {
+    // Add new file or replace existing one
+    archive.addData(std::string(record.key), record.payload.data(),
+                    record.payload.size());
+  }
+
+  if (archive.close() < 0) {
+    throw std::runtime_error(
+      fmt::format("Unable to write archive {}", filePathAbsolute));
+  }
+
+  logger->info("Merged {} change forms into {}", merged.GetRecords().size(),
+               filePathAbsolute);
+}
+
 ZipDatabase::ZipDatabase(std::string filePath_,
-                         std::shared_ptr<spdlog::logger> logger_)
-  : pImpl(std::make_shared<Impl>(std::move(filePath_), std::move(logger_)))
+                         std::shared_ptr<spdlog::logger> logger_,
+                         uint64_t maxSegmentSize)
+  : pImpl(std::make_shared<Impl>(std::move(filePath_), std::move(logger_),
+                                 maxSegmentSize))
 {
 }
 
-ZipDatabase::~ZipDatabase() = default;
+ZipDatabase::~ZipDatabase()
+{
+  // Leave a complete archive behind, so it can be backed up or moved alone
+  try {
+    pImpl->WaitForMerge();
+
+    auto paths = pImpl->GetUnmergedPaths();
+    if (paths.size() > 1 || !pImpl->segment->IsEmpty()) {
+      pImpl->MergeIntoArchive(paths);
+
+      // A crash before truncation replays records that are already in the
+      // archive, which is harmless
+      std::filesystem::remove(pImpl->mergingPath);
+      pImpl->segment->Truncate();
+    }
+  } catch (std::exception& e) {
+    pImpl->logger->error("Unable to merge {}: {}",
+                         pImpl->segment->GetPath().string(), e.what());
+  }
+}
 
 std::vector<std::optional<MpChangeForm>>&& ZipDatabase::UpsertImpl(
   std::vector<std::optional<MpChangeForm>>&& changeForms,
   size_t& outNumUpserted)
 {
   try {
-    auto filePathAbsolute =
-      std::filesystem::absolute(pImpl->filePath).string();
-
-    libzippp::ZipArchive archive(filePathAbsolute.data());
-
-    archive.open(libzippp::ZipArchive::Write);
-
-    std::vector<std::unique_ptr<std::string>> buffers;
+    std::string buffer;
 
     for (auto& changeForm : changeForms) {
       if (changeForm == std::nullopt) {
         continue;
       }
 
-      // Data to be added or updated
       std::string data = MpChangeForm::ToJson(*changeForm).dump(2);
       std::string fileName = changeForm->formDesc.ToString('_') + ".json";
-      std::string filePath = fileName;
 
-      buffers.push_back(std::make_unique<std::string>(data));
-
-      // Add new file or replace existing one
-      archive.addData(filePath, buffers.back()->data(),
-                      buffers.back()->size());
+      ChangeFormLog::AppendRecord(buffer, fileName, data);
     }
 
-    archive.close();
+    // Only the upserted change forms are written. The archive is rewritten
+    // in the background once per maxSegmentSize bytes of updates instead of
+    // on every save
+    pImpl->segment->Append(buffer);
+
+    if (pImpl->segment->GetSize() > pImpl->maxSegmentSize) {
+      pImpl->StartMerge();
+    }
 
     outNumUpserted = changeForms.size();
 
@@ -98,21 +220,22 @@ void ZipDatabase::Iterate(const IterateCallback& iterateCallback,
       }
     }
 
-    for (it = entries.begin(); it != entries.end(); ++it) {
-      libzippp::ZipEntry entry = *it;
-      std::string name = entry.getName();
-      int size = entry.getSize();
+    // The archive isn't read while it's being rewritten
+    pImpl->WaitForMerge();
 
-      std::string textData = entry.readAsText();
+    // Entries upserted since the last merge take precedence over the archive
+    MergedChangeFormLogs segment(pImpl->GetUnmergedPaths());
 
+    auto parseAndLoad = [&](const std::string& name, const char* data,
+                            size_t size) {
       try {
-        auto result = p.parse(textData).value();
+        auto result = p.parse(data, size).value();
         auto changeForm = MpChangeForm::JsonToChangeForm(result);
 
         if (filterSet) {
           if (filterSet->find(changeForm.formDesc.ToString()) ==
               filterSet->end()) {
-            continue;
+            return;
           }
         }
 
@@ -121,6 +244,23 @@ void ZipDatabase::Iterate(const IterateCallback& iterateCallback,
         pImpl->logger->error("Parsing or loading of {} failed with {}", name,
                              e.what());
       }
+    };
+
+    for (it = entries.begin(); it != entries.end(); ++it) {
+      libzippp::ZipEntry entry = *it;
+      std::string name = entry.getName();
+
+      if (segment.Find(name)) {
+        continue;
+      }
+
+      std::string textData = entry.readAsText();
+      parseAndLoad(name, textData.data(), textData.size());
+    }
+
+    for (auto& record : segment.GetRecords()) {
+      parseAndLoad(std::string(record.key), record.payload.data(),
+                   record.payload.size());
     }
 
   } catch (std::exception& e) {
@@ -7,7 +7,12 @@ class ZipDatabase
   : public Viet::IDatabase<MpChangeForm, FormDesc, std::vector<FormDesc>>
 {
 public:
-  ZipDatabase(std::string filePath_, std::shared_ptr<spdlog::logger> logger_);
+  // Upserts are appended to a segment file next to the archive. Once the
+  // segment grows larger than maxSegmentSize bytes, it's merged into the
+  // archive on a background thread. The destructor merges the rest
+  // synchronously, so shutdown may take as long as rewriting the archive
+  ZipDatabase(std::string filePath_, std::shared_ptr<spdlog::logger> logger_,
+              uint64_t maxSegmentSize = 16 * 1024 * 1024);
   ~ZipDatabase();
 
   void Iterate(const IterateCallback& iterateCallback,
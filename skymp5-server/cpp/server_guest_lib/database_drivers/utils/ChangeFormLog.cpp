@@ -0,0 +1,219 @@
+#include "ChangeFormLog.h"
+#include <MappedBuffer.h>
+#include <cstring>
+#include <fmt/format.h>
+
+namespace {
+constexpr char kMagic[8] = { 'S', 'K', 'M', 'P', 'C', 'F', 'L', '1' };
+constexpr size_t kRecordHeaderSize = 12;
+
+uint32_t Fnv1a(std::string_view a, std::string_view b)
+{
+  uint32_t hash = 2166136261u;
+  for (auto str : { a, b }) {
+    for (unsigned char c : str) {
+      hash ^= c;
+      hash *= 16777619u;
+    }
+  }
+  return hash;
+}
+
+void AppendU32(std::string& out, uint32_t value)
+{
+  for (int i = 0; i < 4; ++i) {
+    out.push_back(static_cast<char>((value >> (i * 8)) & 0xff));
+  }
+}
+
+uint32_t ReadU32(const char* data)
+{
+  uint32_t value = 0;
+  for (int i = 0; i < 4; ++i) {
+    value |= static_cast<uint32_t>(static_cast<unsigned char>(data[i]))
+      << (i * 8);
+  }
+  return value;
+}
+
+// Returns the number of bytes occupied by the magic and valid records. Stops
+// at the first truncated or corrupted record
+template <class F>
+size_t ParseRecords(const char* data, size_t size, const F& onRecord)
+{
+  if (size < sizeof(kMagic) || memcmp(data, kMagic, sizeof(kMagic)) != 0) {
+    return 0;
+  }
+
+  size_t pos = sizeof(kMagic);
+  while (size - pos >= kRecordHeaderSize) {
+    uint64_t keySize = ReadU32(data + pos);
+    uint64_t payloadSize = ReadU32(data + pos + 4);
+    uint32_t checksum = ReadU32(data + pos + 8);
+    if (size - pos - kRecordHeaderSize < keySize + payloadSize) {
+      break;
+    }
+
+    const char* keyData = data + pos + kRecordHeaderSize;
+    ChangeFormLog::Record record{ { keyData, keySize },
+                                  { keyData + keySize, payloadSize } };
+    if (Fnv1a(record.key, record.payload) != checksum) {
+      break;
+    }
+
+    onRecord(record);
+    pos += kRecordHeaderSize + keySize + payloadSize;
+  }
+  return pos;
+}
+
+std::unique_ptr<Viet::MappedBuffer> MapIfNotEmpty(
+  const std::filesystem::path& path)
+{
+  std::error_code ec;
+  auto size = std::filesystem::file_size(path, ec);
+  if (ec || size == 0) {
+    return nullptr;
+  }
+  return std::make_unique<Viet::MappedBuffer>(path);
+}
+}
+
+ChangeFormLog::ChangeFormLog(std::filesystem::path path_,
+                             std::shared_ptr<spdlog::logger> logger_)
+  : path(std::move(path_))
+  , logger(std::move(logger_))
+{
+  TrimAndOpen();
+}
+
+void ChangeFormLog::Append(const std::string& records)
+{
+  // A previous append failed midway. Drop what it has written
+  if (!stream) {
+    TrimAndOpen();
+  }
+
+  stream.write(records.data(), records.size());
+  stream.flush();
+  if (!stream) {
+    throw std::runtime_error(
+      fmt::format("Unable to write file {}", path.string()));
+  }
+  size += records.size();
+}
+
+void ChangeFormLog::Truncate()
+{
+  stream.close();
+  stream.clear();
+  stream.open(path, std::ios::binary | std::ios::out | std::ios::trunc);
+  stream.write(kMagic, sizeof(kMagic));
+  stream.flush();
+  if (!stream) {
+    throw std::runtime_error(
+      fmt::format("Unable to truncate file {}", path.string()));
+  }
+  size = sizeof(kMagic);
+}
+
+uint64_t ChangeFormLog::GetSize() const
+{
+  return size;
+}
+
+bool ChangeFormLog::IsEmpty() const
+{
+  return size <= sizeof(kMagic);
+}
+
+const std::filesystem::path& ChangeFormLog::GetPath() const
+{
+  return path;
+}
+
+void ChangeFormLog::AppendHeader(std::string& out)
+{
+  out.append(kMagic, sizeof(kMagic));
+}
+
+void ChangeFormLog::AppendRecord(std::string& out, std::string_view key,
+                                 std::string_view payload)
+{
+  AppendU32(out, static_cast<uint32_t>(key.size()));
+  AppendU32(out, static_cast<uint32_t>(payload.size()));
+  AppendU32(out, Fnv1a(key, payload));
+  out.append(key);
+  out.append(payload);
+}
+
+void ChangeFormLog::TrimAndOpen()
+{
+  stream.close();
+  stream.clear();
+
+  size = 0;
+  if (auto buf = MapIfNotEmpty(path)) {
+    size_t validSize =
+      ParseRecords(buf->GetData(), buf->GetLength(), [](const Record&) {});
+    size_t fullSize = buf->GetLength();
+    buf.reset();
+
+    if (validSize != fullSize) {
+      logger->warn("Dropping {} bytes of incomplete records from {}",
+                   fullSize - validSize, path.string());
+      std::filesystem::resize_file(path, validSize);
+    }
+    size = validSize;
+  }
+
+  stream.open(path, std::ios::binary | std::ios::out | std::ios::app);
+  if (!stream) {
+    throw std::runtime_error(
+      fmt::format("Unable to open file {}", path.string()));
+  }
+
+  if (size == 0) {
+    stream.write(kMagic, sizeof(kMagic));
+    stream.flush();
+    size = sizeof(kMagic);
+  }
+}
+
+MergedChangeFormLogs::MergedChangeFormLogs(
+  const std::vector<std::filesystem::path>& paths)
+{
+  for (auto& path : paths) {
+    auto buf = MapIfNotEmpty(path);
+    if (!buf) {
+      continue;
+    }
+
+    ParseRecords(buf->GetData(), buf->GetLength(),
+                 [&](const ChangeFormLog::Record& record) {
+                   auto [it, inserted] =
+                     indexByKey.emplace(record.key, records.size());
+                   if (inserted) {
+                     records.push_back(record);
+                   } else {
+                     records[it->second] = record;
+                   }
+                 });
+    buffers.push_back(std::move(buf));
+  }
+}
+
+MergedChangeFormLogs::~MergedChangeFormLogs() = default;
+
+const std::vector<ChangeFormLog::Record>& MergedChangeFormLogs::GetRecords()
+  const
+{
+  return records;
+}
+
+const ChangeFormLog::Record* MergedChangeFormLogs::Find(
+  std::string_view key) const
+{
+  auto it = indexByKey.find(key);
+  return it == indexByKey.end() ? nullptr : &records[it->second];
+}
@@ -0,0 +1,82 @@
+#pragma once
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <spdlog/spdlog.h>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace Viet {
+class MappedBuffer;
+}
+
+// Append-only file of checksummed key/payload records. Lets database drivers
+// persist an upsert by writing only the change forms in it.
+//
+// File layout: 8-byte magic, then records of u32 keySize, u32 payloadSize,
+// u32 checksum, key, payload. Integers are little-endian. The checksum covers
+// key and payload and lets us drop a record torn by a crash in the middle of
+// an append
+class ChangeFormLog
+{
+public:
+  struct Record
+  {
+    std::string_view key;
+    std::string_view payload;
+  };
+
+  // Drops incomplete records at the end of the file and opens it for
+  // appending. Creates the file if it doesn't exist
+  ChangeFormLog(std::filesystem::path path,
+                std::shared_ptr<spdlog::logger> logger);
+
+  // Appends records built with AppendRecord and flushes. Throws on failure
+  void Append(const std::string& records);
+
+  void Truncate();
+
+  // File size in bytes, including the magic
+  uint64_t GetSize() const;
+  bool IsEmpty() const;
+
+  const std::filesystem::path& GetPath() const;
+
+  // Appends the magic. Use to write a file of records from scratch
+  static void AppendHeader(std::string& out);
+
+  static void AppendRecord(std::string& out, std::string_view key,
+                           std::string_view payload);
+
+private:
+  void TrimAndOpen();
+
+  const std::filesystem::path path;
+  const std::shared_ptr<spdlog::logger> logger;
+  std::ofstream stream;
+  uint64_t size = 0;
+};
+
+// Memory-maps files of records and keeps the latest record of every key.
+// Records of later files win. Keys are listed in order of first appearance.
+// Records point into the mapped files and are valid while this object lives
+class MergedChangeFormLogs
+{
+public:
+  explicit MergedChangeFormLogs(
+    const std::vector<std::filesystem::path>& paths);
+  ~MergedChangeFormLogs();
+
+  const std::vector<ChangeFormLog::Record>& GetRecords() const;
+
+  // Returns nullptr if there is no such key
+  const ChangeFormLog::Record* Find(std::string_view key) const;
+
+private:
+  std::vector<std::unique_ptr<Viet::MappedBuffer>> buffers;
+  std::vector<ChangeFormLog::Record> records;
+  std::unordered_map<std::string_view, size_t> indexByKey;
+};
@@ -12,10 +12,9 @@ VarValue PapyrusCell::IsInterior(VarValue self,
                                  const std::vector<VarValue>& arguments)
 {
   if (auto lookupRes = GetRecordPtr(self); lookupRes.rec) {
-    espm::CompressedFieldsCache cache;
-
     auto cell = espm::Convert<espm::CELL>(lookupRes.rec);
     if (cell) {
+      auto& cache = lookupRes.parent->GetCache();
       bool isInterior = cell->GetData(cache).flags & espm::CELL::Interior;
       return VarValue(isInterior);
     } else {
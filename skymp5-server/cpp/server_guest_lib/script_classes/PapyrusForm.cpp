@@ -75,8 +75,6 @@ VarValue PapyrusForm::GetType(VarValue self, const std::vector<VarValue>&)
 VarValue PapyrusForm::HasKeyword(VarValue self,
                                  const std::vector<VarValue>& args)
 {
-  static espm::CompressedFieldsCache g_dummyCache;
-
   if (args.empty()) {
     spdlog::error("Form.HasKeyword - at least one argument expected");
     return VarValue(false);
@@ -92,7 +90,7 @@ VarValue PapyrusForm::HasKeyword(VarValue self,
 
   const auto& selfRec = GetRecordPtr(self);
   if (selfRec.rec) {
-    auto keywordIds = selfRec.rec->GetKeywordIds(g_dummyCache);
+    auto keywordIds = selfRec.rec->GetKeywordIds(selfRec.parent->GetCache());
     for (auto rawId : keywordIds) {
       auto globalId = selfRec.ToGlobalId(rawId);
       if (globalId == keywordRec.ToGlobalId(keywordRec.rec->GetId())) {
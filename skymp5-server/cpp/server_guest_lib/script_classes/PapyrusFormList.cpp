@@ -5,11 +5,10 @@
 VarValue PapyrusFormList::GetSize(VarValue self,
                                   const std::vector<VarValue>& arguments)
 {
-  espm::CompressedFieldsCache dummyCache;
-
   const auto& res = GetRecordPtr(self);
   if (auto formlist = espm::Convert<espm::FLST>(res.rec)) {
-    int size = static_cast<int>(formlist->GetData(dummyCache).formIds.size());
+    auto& cache = res.parent->GetCache();
+    int size = static_cast<int>(formlist->GetData(cache).formIds.size());
     return VarValue(size);
   }
   return VarValue(0);
@@ -18,13 +17,11 @@ VarValue PapyrusFormList::GetSize(VarValue self,
 VarValue PapyrusFormList::GetAt(VarValue self,
                                 const std::vector<VarValue>& arguments)
 {
-  espm::CompressedFieldsCache dummyCache;
-
   if (arguments.size() >= 1) {
     int idx = static_cast<int>(arguments[0]);
     const auto& res = GetRecordPtr(self);
     if (auto formlist = espm::Convert<espm::FLST>(res.rec)) {
-      auto formIds = formlist->GetData(dummyCache).formIds;
+      auto formIds = formlist->GetData(res.parent->GetCache()).formIds;
       if (idx >= 0 && static_cast<int>(formIds.size()) > idx) {
         auto formId = res.ToGlobalId(formIds[idx]);
         auto record = res.parent->LookupById(formId);
@@ -38,15 +35,13 @@ VarValue PapyrusFormList::GetAt(VarValue self,
 VarValue PapyrusFormList::Find(VarValue self,
                                const std::vector<VarValue>& arguments) const
 {
-  espm::CompressedFieldsCache dummyCache;
-
   if (arguments.size() >= 1) {
     const auto& res = GetRecordPtr(self);
     if (auto formlist = espm::Convert<espm::FLST>(res.rec)) {
       const auto& arg = GetRecordPtr(arguments[0]);
       if (arg.rec != nullptr) {
         auto formId = arg.ToGlobalId(arg.rec->GetId());
-        auto data = formlist->GetData(dummyCache).formIds;
+        auto data = formlist->GetData(res.parent->GetCache()).formIds;
         for (int i = 0; i < data.size(); i++) {
           if (data[i] == formId) {
             return VarValue(i);
@@ -1,7 +1,7 @@
 #include "PapyrusObjectReference.h"
 
 #include "FormCallbacks.h"
-#include "LeveledListUtils.h"
+#include "LeveledListCache.h"
 #include "LocationalData.h"
 #include "MpActor.h"
 #include "MpObjectReference.h"
@@ -152,8 +152,8 @@ VarValue PapyrusObjectReference::AddItem(
     auto leveledItem = espm::Convert<espm::LVLI>(resultItemLookupRes.rec);
     if (leveledItem) {
       const auto kCountMult = 1;
-      auto map = LeveledListUtils::EvaluateListRecurse(
-        worldState->GetEspm().GetBrowser(), resultItemLookupRes, kCountMult,
+      auto map = worldState->GetLeveledListCache().EvaluateListRecurse(
+        resultItemLookupRes, worldState->GetRandomEngine(), kCountMult,
         kPlayerCharacterLevel);
       for (auto& p : map) {
         selfRefr->AddItem(p.first, p.second);
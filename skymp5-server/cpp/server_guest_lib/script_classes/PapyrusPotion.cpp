@@ -16,8 +16,7 @@ VarValue PapyrusPotion::IsFood(VarValue self,
     return VarValue(false);
   }
 
-  espm::CompressedFieldsCache cache;
-  espm::ALCH::Data data = alch->GetData(cache);
+  espm::ALCH::Data data = alch->GetData(item.parent->GetCache());
   return VarValue(data.isFood);
 }
 
@@ -16,7 +16,7 @@ AssetsScriptStorage::AssetsScriptStorage()
         fileSystem.open("standard_scripts/" + entry.filename());
       const uint8_t* begin = reinterpret_cast<const uint8_t*>(file.begin());
       const uint8_t* end = begin + file.size();
-      std::vector<uint8_t> pex(begin, end);
+      auto pex = std::make_shared<std::vector<uint8_t>>(begin, end);
 
       auto nameWithoutExtension =
         std::filesystem::path(entry.filename()).stem().string();
@@ -38,13 +38,14 @@ AssetsScriptStorage::AssetsScriptStorage()
   }
 }
 
-std::vector<uint8_t> AssetsScriptStorage::GetScriptPex(const char* scriptName)
+IScriptStorage::PexBuffer AssetsScriptStorage::GetScriptPex(
+  const char* scriptName)
 {
   auto it = scriptPex.find(scriptName);
   if (it == scriptPex.end()) {
     spdlog::trace("AssetsScriptStorage::GetScriptPex - Not found {}",
                   scriptName);
-    return {};
+    return nullptr;
   }
   spdlog::trace("AssetsScriptStorage::GetScriptPex - Found {}", scriptName);
   return it->second;
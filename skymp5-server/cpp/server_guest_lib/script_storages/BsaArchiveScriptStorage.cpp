@@ -17,14 +17,14 @@ BsaArchiveScriptStorage::BsaArchiveScriptStorage(const char* bsaPath_)
   }
 }
 
-std::vector<uint8_t> BsaArchiveScriptStorage::GetScriptPex(
+IScriptStorage::PexBuffer BsaArchiveScriptStorage::GetScriptPex(
   const char* scriptName)
 {
   auto it = scriptPex.find(scriptName);
   if (it == scriptPex.end()) {
     spdlog::trace("BsaArchiveScriptStorage::GetScriptPex - Not found {}",
                   scriptName);
-    return {};
+    return nullptr;
   }
   spdlog::trace("BsaArchiveScriptStorage::GetScriptPex - Found {}",
                 scriptName);
@@ -35,8 +35,13 @@ const std::set<CIString>& BsaArchiveScriptStorage::ListScripts(
   bool forceReloadScripts)
 {
 #ifndef NO_BSA
-  if (scripts.empty() || forceReloadScripts) {
+  std::error_code ec;
+  auto writeTime = std::filesystem::last_write_time(bsaPath, ec);
+  if (scripts.empty() ||
+      (forceReloadScripts && (ec || writeTime != lastWriteTime))) {
     scripts.clear();
+    scriptPex.clear();
+    lastWriteTime = writeTime;
     bsa::tes4::archive bsa;
     bsa.read(bsaPath);
     auto bsaScripts = *bsa["scripts"];
@@ -45,9 +50,9 @@ const std::set<CIString>& BsaArchiveScriptStorage::ListScripts(
 
       const std::byte* data = it->second.data();
       size_t size = it->second.size();
-      auto pex =
-        std::vector<uint8_t>(reinterpret_cast<const uint8_t*>(data),
-                             reinterpret_cast<const uint8_t*>(data) + size);
+      auto pex = std::make_shared<std::vector<uint8_t>>(
+        reinterpret_cast<const uint8_t*>(data),
+        reinterpret_cast<const uint8_t*>(data) + size);
 
       auto nameWithoutExtension =
         std::filesystem::path(fileName).stem().string();
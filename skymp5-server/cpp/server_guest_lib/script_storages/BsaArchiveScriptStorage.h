@@ -1,17 +1,21 @@
 #pragma once
 #include "IScriptStorage.h"
+#include <filesystem>
 
 class BsaArchiveScriptStorage : public IScriptStorage
 {
 public:
   BsaArchiveScriptStorage(const char* pathToBsa);
 
-  std::vector<uint8_t> GetScriptPex(const char* scriptName) override;
+  PexBuffer GetScriptPex(const char* scriptName) override;
 
   const std::set<CIString>& ListScripts(bool forceReloadScripts) override;
 
 private:
   std::set<CIString> scripts;
-  CIMap<std::vector<uint8_t>> scriptPex;
+  CIMap<PexBuffer> scriptPex;
   std::string bsaPath;
+
+  // The archive is read again only if it has changed since the last read
+  std::filesystem::file_time_type lastWriteTime;
 };
@@ -6,16 +6,16 @@ CombinedScriptStorage::CombinedScriptStorage(
   this->scriptStorages = std::move(scriptStorages);
 }
 
-std::vector<uint8_t> CombinedScriptStorage::GetScriptPex(
+IScriptStorage::PexBuffer CombinedScriptStorage::GetScriptPex(
   const char* scriptName)
 {
   for (auto& storage : scriptStorages) {
     auto result = storage->GetScriptPex(scriptName);
-    if (!result.empty()) {
+    if (result) {
       return result;
     }
   }
-  return {};
+  return nullptr;
 }
 
 const std::set<CIString>& CombinedScriptStorage::ListScripts(
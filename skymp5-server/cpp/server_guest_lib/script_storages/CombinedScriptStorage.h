@@ -11,7 +11,7 @@ public:
   CombinedScriptStorage(
     std::vector<std::shared_ptr<IScriptStorage>> scriptStorages);
 
-  std::vector<uint8_t> GetScriptPex(const char* scriptName) override;
+  PexBuffer GetScriptPex(const char* scriptName) override;
 
   const std::set<CIString>& ListScripts(bool forceReloadScripts) override;
 
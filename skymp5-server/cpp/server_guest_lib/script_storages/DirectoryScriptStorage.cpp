@@ -3,7 +3,6 @@
 
 #include <filesystem>
 #include <fstream>
-#include <iterator>
 #include <spdlog/spdlog.h>
 
 DirectoryScriptStorage::DirectoryScriptStorage(const std::string& pexDirPath_)
@@ -12,33 +11,49 @@ DirectoryScriptStorage::DirectoryScriptStorage(const std::string& pexDirPath_)
   scripts = ScriptStorageUtils::GetScriptsInDirectory(pexDir);
 }
 
-std::vector<uint8_t> DirectoryScriptStorage::GetScriptPex(
+IScriptStorage::PexBuffer DirectoryScriptStorage::GetScriptPex(
   const char* scriptName)
 {
   const auto path =
     std::filesystem::path(pexDir) / (scriptName + std::string(".pex"));
 
-  if (!std::filesystem::exists(path)) {
+  std::error_code ec;
+  const auto lastWriteTime = std::filesystem::last_write_time(path, ec);
+  const auto size = ec ? 0 : std::filesystem::file_size(path, ec);
+  if (ec) {
     spdlog::trace("DirectoryScriptStorage::GetScriptPex - Not found {} (file "
                   "doesn't exist)",
                   scriptName);
-    return {};
+    cache.erase(scriptName);
+    return nullptr;
+  }
+
+  auto& cached = cache[scriptName];
+  if (cached.pex && cached.lastWriteTime == lastWriteTime &&
+      cached.size == size) {
+    spdlog::trace("DirectoryScriptStorage::GetScriptPex - Found {} (cached)",
+                  scriptName);
+    return cached.pex;
   }
 
   std::ifstream f(path, std::ios::binary);
   if (!f.is_open()) {
     throw std::runtime_error(path.string() + " is failed to open");
   }
-  std::vector<uint8_t> buffer(std::istreambuf_iterator<char>(f), {});
+  auto buffer = std::make_shared<std::vector<uint8_t>>(size);
+  f.read(reinterpret_cast<char*>(buffer->data()), buffer->size());
+  buffer->resize(static_cast<size_t>(f.gcount()));
 
-  if (buffer.empty()) {
+  if (buffer->empty()) {
     spdlog::trace(
       "DirectoryScriptStorage::GetScriptPex - Not found {} (file is empty)",
       scriptName);
-    return {};
+    cache.erase(scriptName);
+    return nullptr;
   }
 
   spdlog::trace("DirectoryScriptStorage::GetScriptPex - Found {}", scriptName);
+  cached = { lastWriteTime, size, buffer };
   return buffer;
 }
 
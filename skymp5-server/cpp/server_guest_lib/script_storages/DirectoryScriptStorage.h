@@ -1,16 +1,27 @@
 #pragma once
 #include "IScriptStorage.h"
+#include <filesystem>
 
 class DirectoryScriptStorage : public IScriptStorage
 {
 public:
   DirectoryScriptStorage(const std::string& pexDir_);
 
-  std::vector<uint8_t> GetScriptPex(const char* scriptName) override;
+  PexBuffer GetScriptPex(const char* scriptName) override;
 
   const std::set<CIString>& ListScripts(bool forceReloadScripts) override;
 
 private:
+  struct CachedPex
+  {
+    std::filesystem::file_time_type lastWriteTime;
+    uintmax_t size = 0;
+    PexBuffer pex;
+  };
+
   const std::string pexDir;
   std::set<CIString> scripts;
+
+  // Files are re-read only after their modification time or size changes
+  CIMap<CachedPex> cache;
 };
@@ -1,15 +1,22 @@
 #pragma once
 #include "papyrus-vm/CIString.h"
 #include <cstdint>
+#include <memory>
 #include <set>
 #include <vector>
 
 class IScriptStorage
 {
 public:
+  // Shared between callers and never modified. Storages return the same
+  // buffer for a script until it changes, so that callers can detect changes
+  // by comparing pointers
+  using PexBuffer = std::shared_ptr<const std::vector<uint8_t>>;
+
   virtual ~IScriptStorage() = default;
 
-  virtual std::vector<uint8_t> GetScriptPex(const char* scriptName) = 0;
+  // nullptr if not found
+  virtual PexBuffer GetScriptPex(const char* scriptName) = 0;
 
   virtual const std::set<CIString>& ListScripts(bool forceReloadScripts) = 0;
 };
@@ -0,0 +1,157 @@
+#include "PexScriptCache.h"
+#include "papyrus-vm/Reader.h"
+#include <ParallelFor.h>
+#include <spdlog/spdlog.h>
+#include <stdexcept>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+// FNV-1a
+uint64_t HashPex(const std::vector<uint8_t>& pex) noexcept
+{
+  uint64_t hash = 14695981039346656037ull;
+  for (uint8_t byte : pex) {
+    hash ^= byte;
+    hash *= 1099511628211ull;
+  }
+  return hash;
+}
+
+std::shared_ptr<PexScript> Parse(const std::vector<uint8_t>& pex)
+{
+  return Reader(pex.data(), pex.size()).GetSourceStructures().front();
+}
+
+struct Entry
+{
+  IScriptStorage::PexBuffer pex;
+  std::shared_ptr<PexScript> script;
+};
+}
+
+struct PexScriptCache::Impl
+{
+  // Collisions are resolved by comparing contents
+  std::unordered_map<uint64_t, std::vector<Entry>> entries;
+  size_t numScripts = 0;
+
+  Entry* Find(const IScriptStorage::PexBuffer& pex, uint64_t hash)
+  {
+    auto it = entries.find(hash);
+    if (it == entries.end()) {
+      return nullptr;
+    }
+    for (auto& entry : it->second) {
+      if (entry.pex == pex || *entry.pex == *pex) {
+        return &entry;
+      }
+    }
+    return nullptr;
+  }
+
+  void Insert(const IScriptStorage::PexBuffer& pex, uint64_t hash,
+              std::shared_ptr<PexScript> script)
+  {
+    entries[hash].push_back({ pex, std::move(script) });
+    ++numScripts;
+  }
+
+  void Erase(const IScriptStorage::PexBuffer& pex, uint64_t hash)
+  {
+    auto it = entries.find(hash);
+    if (it == entries.end()) {
+      return;
+    }
+    auto& bucket = it->second;
+    auto n = std::erase_if(bucket, [&](const Entry& entry) {
+      return entry.pex == pex || *entry.pex == *pex;
+    });
+    numScripts -= n;
+    if (bucket.empty()) {
+      entries.erase(it);
+    }
+  }
+};
+
+PexScriptCache::PexScriptCache()
+  : pImpl(std::make_unique<Impl>())
+{
+}
+
+PexScriptCache::~PexScriptCache() = default;
+
+std::shared_ptr<PexScript> PexScriptCache::Get(
+  const IScriptStorage::PexBuffer& pex)
+{
+  if (!pex) {
+    throw std::runtime_error("PexScriptCache::Get - pex is null");
+  }
+
+  const auto hash = HashPex(*pex);
+  if (auto entry = pImpl->Find(pex, hash)) {
+    return entry->script;
+  }
+
+  auto script = Parse(*pex);
+  pImpl->Insert(pex, hash, script);
+  return script;
+}
+
+void PexScriptCache::Forget(const IScriptStorage::PexBuffer& pex)
+{
+  if (pex) {
+    pImpl->Erase(pex, HashPex(*pex));
+  }
+}
+
+void PexScriptCache::Preload(IScriptStorage& storage,
+                             const std::set<CIString>& scripts,
+                             size_t numThreads)
+{
+  struct Job
+  {
+    const CIString* name = nullptr;
+    IScriptStorage::PexBuffer pex;
+    uint64_t hash = 0;
+    std::shared_ptr<PexScript> script;
+  };
+
+  // Storages aren't thread-safe, so only parsing is parallel
+  std::vector<Job> jobs;
+  jobs.reserve(scripts.size());
+  for (auto& name : scripts) {
+    auto pex = storage.GetScriptPex(name.data());
+    if (!pex) {
+      continue;
+    }
+    auto hash = HashPex(*pex);
+    if (!pImpl->Find(pex, hash)) {
+      jobs.push_back({ &name, std::move(pex), hash });
+    }
+  }
+
+  if (numThreads == 0) {
+    numThreads = Viet::GetDefaultNumThreads();
+  }
+  Viet::ParallelFor(jobs.size(), numThreads, [&](size_t i) {
+    try {
+      jobs[i].script = Parse(*jobs[i].pex);
+    } catch (std::exception& e) {
+      spdlog::warn("PexScriptCache::Preload - Failed to parse {}: {}",
+                   jobs[i].name->data(), e.what());
+    }
+  });
+
+  for (auto& job : jobs) {
+    // Duplicates within the batch are possible, the first one wins
+    if (job.script && !pImpl->Find(job.pex, job.hash)) {
+      pImpl->Insert(job.pex, job.hash, std::move(job.script));
+    }
+  }
+}
+
+size_t PexScriptCache::GetNumScripts() const
+{
+  return pImpl->numScripts;
+}
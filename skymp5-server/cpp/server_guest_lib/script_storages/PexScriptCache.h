@@ -0,0 +1,37 @@
+#pragma once
+#include "IScriptStorage.h"
+#include <memory>
+
+struct PexScript;
+
+// Parsed scripts by pex contents. A script is parsed once per distinct
+// contents, so hot reload re-parses only the scripts that have actually
+// changed. Versions stay cached until forgotten
+class PexScriptCache
+{
+public:
+  PexScriptCache();
+  ~PexScriptCache();
+
+  // Parses the pex unless there is a script with the same contents
+  std::shared_ptr<PexScript> Get(const IScriptStorage::PexBuffer& pex);
+
+  // Drops the cached script with these contents. Holders of the script keep
+  // it alive, Get parses the contents again
+  void Forget(const IScriptStorage::PexBuffer& pex);
+
+  // Fetches the listed scripts from the storage and parses them on up to
+  // numThreads threads (0 is for the number of cores). Scripts that fail to
+  // parse are skipped with a warning, Get will throw for them later
+  void Preload(IScriptStorage& storage, const std::set<CIString>& scripts,
+               size_t numThreads = 0);
+
+  size_t GetNumScripts() const;
+
+private:
+  PexScriptCache(const PexScriptCache&) = delete;
+  PexScriptCache& operator=(const PexScriptCache&) = delete;
+
+  struct Impl;
+  std::unique_ptr<Impl> pImpl;
+};
@@ -1,8 +1,14 @@
+#include "Grid.h"
 #include "PartOne.h"
+#include "SpatialHashGrid.h"
 #include "TestUtils.hpp"
+#include "Timer.h"
+#include <algorithm>
 #include <catch2/catch_all.hpp>
 #include <chrono>
+#include <cmath>
 #include <iostream>
+#include <random>
 
 class EmptySendTarget : public Networking::ISendTarget
 {
@@ -59,3 +65,212 @@ TEST_CASE("SendToNeighbours", "[Benchmarks]")
   // ExecuteBenchmark(1000);
 #endif
 }
+
+namespace {
+template <class T>
+size_t VisitNeighbours(const GridImpl<T>& grid, int16_t x, int16_t y)
+{
+  size_t n = 0;
+  for ([[maybe_unused]] auto& id : grid.GetNeighboursByPosition(x, y)) {
+    ++n;
+  }
+  return n;
+}
+
+template <class T>
+size_t VisitNeighbours(const SpatialHashGrid<T>& grid, int16_t x, int16_t y)
+{
+  size_t n = 0;
+  grid.ForEachNeighbour(x, y, [&](const T&) { ++n; });
+  return n;
+}
+
+// Random walk of numRefs objects, each step moves every object to a random
+// adjacent cell and visits its 3x3 neighbourhood
+template <class GridT>
+std::chrono::microseconds BenchmarkGridMoves(int numRefs, int numSteps)
+{
+  // ~8 refs per cell on average regardless of numRefs
+  const int side = std::max(1, static_cast<int>(std::sqrt(numRefs / 8)));
+
+  std::mt19937 rng(numRefs);
+  std::uniform_int_distribution<int> start(0, side - 1);
+  std::uniform_int_distribution<int> step(-1, 1);
+
+  GridT grid;
+  std::vector<std::pair<int16_t, int16_t>> positions(numRefs);
+  for (int i = 0; i < numRefs; ++i) {
+    positions[i] = { static_cast<int16_t>(start(rng)),
+                     static_cast<int16_t>(start(rng)) };
+    grid.Move(i, positions[i].first, positions[i].second);
+  }
+
+  size_t totalNeighbours = 0;
+  auto was = std::chrono::steady_clock::now();
+
+  for (int s = 0; s < numSteps; ++s) {
+    for (int i = 0; i < numRefs; ++i) {
+      auto& [x, y] = positions[i];
+      x = static_cast<int16_t>(std::clamp(x + step(rng), 0, side - 1));
+      y = static_cast<int16_t>(std::clamp(y + step(rng), 0, side - 1));
+      grid.Move(i, x, y);
+      totalNeighbours += VisitNeighbours(grid, x, y);
+    }
+  }
+
+  auto res = std::chrono::duration_cast<std::chrono::microseconds>(
+    std::chrono::steady_clock::now() - was);
+  REQUIRE(totalNeighbours >= static_cast<size_t>(numRefs) * numSteps);
+  return res;
+}
+
+void ExecuteGridBenchmark(int numRefs)
+{
+  constexpr int kNumSteps = 10;
+  auto gridImpl = BenchmarkGridMoves<Grid>(numRefs, kNumSteps);
+  auto spatialHashGrid =
+    BenchmarkGridMoves<SpatialHashGrid<uint64_t>>(numRefs, kNumSteps);
+
+  std::cout << "Grid moves for " << numRefs << " refs: GridImpl took "
+            << gridImpl.count() / kNumSteps
+            << " microseconds per step, SpatialHashGrid took "
+            << spatialHashGrid.count() / kNumSteps
+            << " microseconds per step" << std::endl;
+}
+}
+
+TEST_CASE("Grid moves", "[Benchmarks]")
+{
+  ExecuteGridBenchmark(1000);
+}
+
+TEST_CASE("Grid moves (large)", "[.][Benchmarks]")
+{
+  ExecuteGridBenchmark(10000);
+  ExecuteGridBenchmark(100000);
+}
+
+namespace {
+// The path the server takes: actors crossing cell borders via SetPos, which
+// updates subscriptions, and WorldState::ForEachNeighborByPosition via
+// VisitNeighbours, as used by FindClosestReference
+void ExecuteNeighboursBenchmark(int numActors)
+{
+  constexpr int kNumSteps = 10;
+  constexpr float kCellSize = 4096.f;
+
+  // ~8 actors per cell on average regardless of numActors
+  const int side = std::max(1, static_cast<int>(std::sqrt(numActors / 8)));
+
+  std::mt19937 rng(numActors);
+  std::uniform_int_distribution<int> start(0, side - 1);
+  std::uniform_int_distribution<int> step(-1, 1);
+
+  auto toPos = [&](const std::pair<int, int>& cell) {
+    return NiPoint3{ (cell.first + 0.5f) * kCellSize,
+                     (cell.second + 0.5f) * kCellSize, 0.f };
+  };
+
+  PartOne p;
+  std::vector<MpActor*> actors;
+  std::vector<std::pair<int, int>> cells(numActors);
+  for (int i = 0; i < numActors; ++i) {
+    cells[i] = { start(rng), start(rng) };
+    auto formId = p.CreateActor(0, toPos(cells[i]), 0, 0x3c);
+    actors.push_back(&p.worldState.GetFormAt<MpActor>(formId));
+  }
+
+  std::chrono::microseconds setPosTime{ 0 }, visitTime{ 0 };
+  size_t totalNeighbours = 0;
+
+  for (int s = 0; s < kNumSteps; ++s) {
+    for (int i = 0; i < numActors; ++i) {
+      auto& [x, y] = cells[i];
+      x = std::clamp(x + step(rng), 0, side - 1);
+      y = std::clamp(y + step(rng), 0, side - 1);
+
+      auto was = std::chrono::steady_clock::now();
+      actors[i]->SetPos(toPos(cells[i]));
+      auto setPosDone = std::chrono::steady_clock::now();
+      actors[i]->VisitNeighbours([&](MpObjectReference*) {
+        ++totalNeighbours;
+      });
+      auto visitDone = std::chrono::steady_clock::now();
+
+      setPosTime += std::chrono::duration_cast<std::chrono::microseconds>(
+        setPosDone - was);
+      visitTime += std::chrono::duration_cast<std::chrono::microseconds>(
+        visitDone - setPosDone);
+    }
+  }
+
+  REQUIRE(totalNeighbours >= static_cast<size_t>(numActors) * kNumSteps);
+  std::cout << "Neighbours of " << numActors << " moving actors: SetPos took "
+            << setPosTime.count() / kNumSteps
+            << " microseconds per step, VisitNeighbours took "
+            << visitTime.count() / kNumSteps << " microseconds per step"
+            << std::endl;
+}
+}
+
+TEST_CASE("Actor moves and neighbour visits", "[Benchmarks]")
+{
+  ExecuteNeighboursBenchmark(1000);
+}
+
+TEST_CASE("Actor moves and neighbour visits (large)", "[.][Benchmarks]")
+{
+  ExecuteNeighboursBenchmark(10000);
+}
+
+namespace {
+// Models magic effects: every timer is set with a random duration, a quarter
+// of them gets dispelled (removed) before expiry, the rest resolve on tick
+void ExecuteTimerBenchmark(int numTimers)
+{
+  std::mt19937 rng(numTimers);
+  std::uniform_int_distribution<int> durationMs(-1000, 1000);
+
+  Viet::Timer timer;
+  std::vector<uint32_t> ids(numTimers);
+  int numResolved = 0;
+
+  auto was = std::chrono::steady_clock::now();
+
+  for (int i = 0; i < numTimers; ++i) {
+    timer.SetTimer(std::chrono::milliseconds(durationMs(rng)), &ids[i])
+      .Then([&](const Viet::Void&) { ++numResolved; });
+  }
+  auto setDone = std::chrono::steady_clock::now();
+
+  for (int i = 0; i < numTimers; i += 4) {
+    REQUIRE(timer.RemoveTimer(ids[i]));
+  }
+  auto removeDone = std::chrono::steady_clock::now();
+
+  timer.TickTimers();
+  auto tickDone = std::chrono::steady_clock::now();
+
+  REQUIRE(numResolved > 0);
+  REQUIRE(numResolved + timer.GetNumTimers() + (numTimers + 3) / 4 ==
+          static_cast<size_t>(numTimers));
+
+  auto us = [](auto d) {
+    return std::chrono::duration_cast<std::chrono::microseconds>(d).count();
+  };
+  std::cout << "Timers for " << numTimers << " effects: SetTimer took "
+            << us(setDone - was) << " microseconds, RemoveTimer took "
+            << us(removeDone - setDone) << " microseconds, TickTimers took "
+            << us(tickDone - removeDone) << " microseconds" << std::endl;
+}
+}
+
+TEST_CASE("Effect timers", "[Benchmarks]")
+{
+  ExecuteTimerBenchmark(10000);
+}
+
+TEST_CASE("Effect timers (large)", "[.][Benchmarks]")
+{
+  ExecuteTimerBenchmark(100000);
+}
@@ -0,0 +1,168 @@
+#include "ChunkStreamer.h"
+#include "TestUtils.hpp"
+#include "libespm/Loader.h"
+#include <catch2/catch_all.hpp>
+#include <chrono>
+#include <thread>
+
+extern espm::Loader& GetEspmLoader();
+PartOne& GetPartOne();
+
+namespace {
+constexpr uint32_t kTamriel = 0x3c;
+
+// Exterior cell just outside Whiterun
+constexpr int16_t kCellX = 5;
+constexpr int16_t kCellY = -2;
+
+template <class F>
+bool WaitUntil(F f)
+{
+  auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(30);
+  while (!f()) {
+    if (std::chrono::steady_clock::now() >= deadline) {
+      return false;
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  return true;
+}
+
+// Candidates of the 3x3 area requested by WorldState::LoadChunksAround
+std::vector<uint32_t> GetCandidatesAround(int16_t cellX, int16_t cellY)
+{
+  auto& loader = GetEspmLoader();
+  ChunkStreamer streamer(loader.GetBrowser(), loader.GetFileNames().size());
+  for (int16_t x = cellX - 1; x <= cellX + 1; ++x) {
+    for (int16_t y = cellY - 1; y <= cellY + 1; ++y) {
+      streamer.Request({ kTamriel, x, y });
+    }
+  }
+
+  std::vector<uint32_t> res;
+  REQUIRE(WaitUntil([&] {
+    ChunkStreamer::PreparedChunk chunk;
+    while (streamer.TryPop(chunk)) {
+      res.insert(res.end(), chunk.candidateFormIds.begin(),
+                 chunk.candidateFormIds.end());
+    }
+    return streamer.GetNumPending() == 0;
+  }));
+  return res;
+}
+}
+
+TEST_CASE("ChunkStreamer prepares a requested chunk once",
+          "[ChunkStreamer][espm]")
+{
+  auto& loader = GetEspmLoader();
+  ChunkStreamer streamer(loader.GetBrowser(), loader.GetFileNames().size());
+
+  streamer.Request({ kTamriel, kCellX, kCellY });
+  REQUIRE(streamer.GetNumPending() == 1);
+
+  ChunkStreamer::PreparedChunk chunk;
+  REQUIRE(WaitUntil([&] { return streamer.TryPop(chunk); }));
+  REQUIRE(chunk.key.cellOrWorld == kTamriel);
+  REQUIRE(chunk.key.x == kCellX);
+  REQUIRE(chunk.key.y == kCellY);
+  REQUIRE(!chunk.candidateFormIds.empty());
+  REQUIRE(streamer.GetNumPending() == 0);
+
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  REQUIRE(!streamer.TryPop(chunk));
+}
+
+TEST_CASE("ChunkStreamer can be destroyed with requests pending",
+          "[ChunkStreamer][espm]")
+{
+  auto& loader = GetEspmLoader();
+  auto streamer = std::make_unique<ChunkStreamer>(
+    loader.GetBrowser(), loader.GetFileNames().size());
+  for (int16_t x = -10; x < 10; ++x) {
+    streamer->Request({ kTamriel, x, 0 });
+  }
+  streamer.reset();
+}
+
+TEST_CASE("Chunk streaming attaches requested chunks once within budget",
+          "[ChunkStreamer][espm]")
+{
+  const auto candidates = GetCandidatesAround(kCellX, kCellY);
+  REQUIRE(!candidates.empty());
+
+  PartOne& p = GetPartOne();
+  auto& worldState = p.worldState;
+  worldState.EnableChunkStreaming(std::chrono::microseconds(0));
+
+  worldState.LoadChunksAround(kTamriel, kCellX, kCellY);
+  REQUIRE(worldState.GetNumPendingChunks() == 9);
+
+  // Requested chunks aren't requested again
+  worldState.LoadChunksAround(kTamriel, kCellX, kCellY);
+  REQUIRE(worldState.GetNumPendingChunks() == 9);
+
+  // Zero budget still attaches one reference per tick, but not more
+  size_t numTicks = 0;
+  REQUIRE(WaitUntil([&] {
+    worldState.Tick();
+    ++numTicks;
+    return worldState.GetNumPendingChunks() == 0;
+  }));
+  REQUIRE(numTicks >= candidates.size());
+
+  size_t numAttached = 0;
+  for (auto formId : candidates) {
+    if (worldState.LookupFormByIdNoLoad(formId)) {
+      ++numAttached;
+    }
+  }
+  REQUIRE(numAttached > 0);
+
+  // Loaded chunks aren't requested again
+  worldState.LoadChunksAround(kTamriel, kCellX, kCellY);
+  REQUIRE(worldState.GetNumPendingChunks() == 0);
+}
+
+TEST_CASE("Chunk streaming prefetches chunks in the direction of movement",
+          "[ChunkStreamer][espm]")
+{
+  PartOne& p = GetPartOne();
+  auto& worldState = p.worldState;
+  worldState.EnableChunkStreaming(std::chrono::microseconds(0));
+
+  worldState.LoadChunksAround(kTamriel, kCellX, kCellY);
+  worldState.PrefetchChunks(kTamriel, { kCellX - 1, kCellY },
+                            { kCellX, kCellY });
+
+  // 3x3 area plus 5 chunks of the ring at distance 2 facing +x
+  REQUIRE(worldState.GetNumPendingChunks() == 14);
+
+  // No prefetching when standing still
+  worldState.PrefetchChunks(kTamriel, { kCellX, kCellY }, { kCellX, kCellY });
+  REQUIRE(worldState.GetNumPendingChunks() == 14);
+}
+
+TEST_CASE("WorldState::Clear drops pending chunk requests",
+          "[ChunkStreamer][espm]")
+{
+  PartOne& p = GetPartOne();
+  auto& worldState = p.worldState;
+  worldState.EnableChunkStreaming(std::chrono::microseconds(0));
+
+  worldState.LoadChunksAround(kTamriel, kCellX, kCellY);
+  REQUIRE(worldState.GetNumPendingChunks() == 9);
+
+  worldState.Clear();
+  REQUIRE(worldState.GetNumPendingChunks() == 0);
+  worldState.Tick();
+
+  // Requests are made again once streaming is re-enabled
+  worldState.EnableChunkStreaming(std::chrono::microseconds(0));
+  worldState.LoadChunksAround(kTamriel, kCellX, kCellY);
+  REQUIRE(worldState.GetNumPendingChunks() == 9);
+  REQUIRE(WaitUntil([&] {
+    worldState.Tick();
+    return worldState.GetNumPendingChunks() == 0;
+  }));
+}
@@ -187,3 +187,48 @@ TEST_CASE("DLC Hearthfires recipes are working", "[Craft][espm]")
   REQUIRE(form.size() > 0);
   REQUIRE(form[0].rec->GetId() == 0x0200306d);
 }
+
+TEST_CASE("Duplicate recipe inputs are aggregated", "[Craft]")
+{
+  auto aggregated = CraftService::AggregateInputObjects(
+    { { 0x0005ACE4, 1 }, { 0x00034CDD, 3 }, { 0x0005ACE4, 2 } });
+
+  REQUIRE(aggregated.size() == 2);
+  REQUIRE(aggregated[0].formId == 0x00034CDD);
+  REQUIRE(aggregated[0].count == 3);
+  REQUIRE(aggregated[1].formId == 0x0005ACE4);
+  REQUIRE(aggregated[1].count == 3);
+}
+
+TEST_CASE("FindRecipe looks up recipes indexed on AttachEspm",
+          "[Craft][espm]")
+{
+  PartOne& p = GetPartOne();
+  auto craftService = p.GetActionListener().GetCraftService();
+  auto& br = p.GetEspm().GetBrowser();
+
+  auto found = craftService->FindRecipe(
+    std::nullopt, std::nullopt, br, Inventory().AddItem(0x0005ACE4, 1),
+    0x300300F);
+  REQUIRE(found.size() > 0);
+
+  // No recipe produces this object
+  REQUIRE(craftService
+            ->FindRecipe(std::nullopt, std::nullopt, br,
+                         Inventory().AddItem(0x0005ACE4, 1), 0xdeadbeef)
+            .empty());
+
+  // Separate entries of the same item are summed up, so this is 2 items
+  Inventory duplicates;
+  duplicates.entries = { { 0x0005ACE4, 1 }, { 0x0005ACE4, 1 } };
+  REQUIRE(craftService
+            ->FindRecipe(std::nullopt, std::nullopt, br, duplicates,
+                         0x300300F)
+            .empty());
+
+  duplicates.entries[1].count = 0;
+  REQUIRE(craftService
+            ->FindRecipe(std::nullopt, std::nullopt, br, duplicates,
+                         0x300300F)
+            .size() == found.size());
+}
@@ -1,6 +1,7 @@
 #include "TestUtils.hpp"
 #include "libespm/GroupUtils.h"
 #include "libespm/Loader.h"
+#include "libespm/ZlibUtils.h"
 #include <catch2/catch_all.hpp>
 
 extern espm::Loader& GetEspmLoader();
@@ -516,6 +517,56 @@ TEST_CASE("espm::GetData wrapper is able to get record data", "[espm]")
   REQUIRE(abs(data.healRegen - 0.7f) < std::numeric_limits<float>::epsilon());
 }
 
+TEST_CASE("espm::GetData decodes each record once", "[espm]")
+{
+  MyEspmProvider provider;
+
+  constexpr uint32_t kArgonianRace = 0x00013740;
+  constexpr uint32_t kPlayerNpc = 0x7;
+
+  const auto& race = espm::GetData<espm::RACE>(kArgonianRace, &provider);
+  REQUIRE(&race == &espm::GetData<espm::RACE>(kArgonianRace, &provider));
+
+  const auto& npc = espm::GetData<espm::NPC_>(kPlayerNpc, &provider);
+  REQUIRE(&npc == &espm::GetData<espm::NPC_>(kPlayerNpc, &provider));
+
+  espm::CompressedFieldsCache compressedFieldsCache;
+  auto npcRecord = espm::Convert<espm::NPC_>(
+    GetEspmLoader().GetBrowser().LookupById(kPlayerNpc).rec);
+  auto expected = npcRecord->GetData(compressedFieldsCache);
+  REQUIRE(npc.defaultOutfitId == expected.defaultOutfitId);
+  REQUIRE(npc.objects.size() == expected.objects.size());
+  REQUIRE(npc.spells == expected.spells);
+  REQUIRE(npc.race == expected.race);
+}
+
+TEST_CASE("PrewarmDecodedRecords decodes all NPC_ and RACE records",
+          "[espm]")
+{
+  auto& loader = GetEspmLoader();
+  auto& br = loader.GetBrowser();
+
+  REQUIRE_NOTHROW(espm::PrewarmDecodedRecords<espm::NPC_>(loader));
+  REQUIRE_NOTHROW(espm::PrewarmDecodedRecords<espm::RACE>(loader));
+
+  auto npcs = br.GetDistinctRecordsByType(espm::NPC_::kType);
+  auto races = br.GetDistinctRecordsByType(espm::RACE::kType);
+  REQUIRE(npcs.size() > 1000);
+  REQUIRE(races.size() > 10);
+
+  auto& cache = loader.GetDecodedRecordCache();
+  auto size = cache.GetSize();
+  REQUIRE(size >= npcs.size() + races.size());
+
+  // Already decoded
+  MyEspmProvider provider;
+  constexpr uint32_t kArgonianRace = 0x00013740;
+  constexpr uint32_t kPlayerNpc = 0x7;
+  espm::GetData<espm::RACE>(kArgonianRace, &provider);
+  espm::GetData<espm::NPC_>(kPlayerNpc, &provider);
+  REQUIRE(cache.GetSize() == size);
+}
+
 TEST_CASE("GMST parsing", "[espm]")
 {
   MyEspmProvider provider;
@@ -630,3 +681,174 @@ TEST_CASE("isFood flag is set for sweet roll", "[espm]")
   REQUIRE(data.isFood == true);
   REQUIRE(data.isPoison == false);
 }
+
+namespace {
+void AppendUint32(std::vector<uint8_t>& buf, uint32_t value)
+{
+  for (int i = 0; i < 4; ++i) {
+    buf.push_back(static_cast<uint8_t>(value >> (8 * i)));
+  }
+}
+
+// Appends a 24-byte record or group header
+void AppendHeader(std::vector<uint8_t>& buf, const char* type,
+                  uint32_t dataSize, const char* labelOrFlags, uint32_t id)
+{
+  buf.insert(buf.end(), type, type + 4);
+  AppendUint32(buf, dataSize);
+  buf.insert(buf.end(), labelOrFlags, labelOrFlags + 4);
+  AppendUint32(buf, id);
+  buf.resize(buf.size() + 8);
+}
+
+constexpr uint32_t kHeaderSize = 24;
+
+// Two top-level groups, the second one overrides a record of the first one
+std::vector<uint8_t> MakeTestPlugin()
+{
+  const char kNoFlags[4] = {};
+
+  std::vector<uint8_t> buf;
+  AppendHeader(buf, "TES4", 0, kNoFlags, 0);
+  AppendHeader(buf, "GRUP", kHeaderSize * 3, "KYWD", 0);
+  AppendHeader(buf, "KYWD", 0, kNoFlags, 0x100);
+  AppendHeader(buf, "KYWD", 0, kNoFlags, 0x101);
+  AppendHeader(buf, "GRUP", kHeaderSize * 3, "FACT", 0);
+  AppendHeader(buf, "FACT", 0, kNoFlags, 0x200);
+  AppendHeader(buf, "KYWD", 0, kNoFlags, 0x100);
+  return buf;
+}
+}
+
+TEST_CASE("Browser indexes top-level groups in parallel the same way",
+          "[espm]")
+{
+  auto buf = MakeTestPlugin();
+
+  espm::Browser sequential(buf.data(), buf.size());
+  espm::Browser parallel(buf.data(), buf.size(), 4);
+
+  for (uint32_t id : { 0x0, 0x100, 0x101, 0x200, 0x300 }) {
+    REQUIRE(sequential.LookupById(id) == parallel.LookupById(id));
+  }
+  REQUIRE(parallel.LookupById(0x100) ==
+          reinterpret_cast<const espm::RecordHeader*>(buf.data() +
+                                                      kHeaderSize * 6 + 8));
+
+  for (const char* type : { "KYWD", "FACT" }) {
+    REQUIRE(sequential.GetRecordsByType(type) ==
+            parallel.GetRecordsByType(type));
+  }
+  REQUIRE(parallel.GetRecordsByType("KYWD").size() == 3);
+
+  auto rec = parallel.LookupById(0x200);
+  REQUIRE(parallel.GetParentGroupsEnsured(rec) ==
+          sequential.GetParentGroupsEnsured(rec));
+  REQUIRE(parallel.GetParentGroupsEnsured(rec).size() == 1);
+}
+
+TEST_CASE("Browser restores lookup tables from a serialized index", "[espm]")
+{
+  auto buf = MakeTestPlugin();
+
+  espm::Browser parsed(buf.data(), buf.size());
+  auto index = parsed.SerializeIndex();
+  espm::Browser restored(buf.data(), buf.size(), index.data(), index.size());
+
+  for (uint32_t id : { 0x0, 0x100, 0x101, 0x200, 0x300 }) {
+    REQUIRE(parsed.LookupById(id) == restored.LookupById(id));
+  }
+  for (const char* type : { "KYWD", "FACT" }) {
+    REQUIRE(parsed.GetRecordsByType(type) == restored.GetRecordsByType(type));
+  }
+
+  auto rec = restored.LookupById(0x200);
+  REQUIRE(restored.GetParentGroupsEnsured(rec) ==
+          parsed.GetParentGroupsEnsured(rec));
+  auto group = restored.GetParentGroupsEnsured(rec).back();
+  REQUIRE(restored.GetSubsEnsured(group) == parsed.GetSubsEnsured(group));
+  REQUIRE(restored.GetParentGroupsOptional(restored.LookupById(0)) == nullptr);
+
+  // A file with different length or a damaged index is never trusted
+  auto longerBuf = buf;
+  longerBuf.resize(buf.size() + kHeaderSize);
+  REQUIRE_THROWS(espm::Browser(longerBuf.data(), longerBuf.size(),
+                               index.data(), index.size()));
+  REQUIRE_THROWS(
+    espm::Browser(buf.data(), buf.size(), index.data(), index.size() - 1));
+  auto badOffset = index;
+  std::fill(badOffset.end() - 4, badOffset.end(), 0xff);
+  REQUIRE_THROWS(espm::Browser(buf.data(), buf.size(), badOffset.data(),
+                               badOffset.size()));
+
+  // Even if the damage leaves the index well-formed
+  auto flipped = index;
+  flipped[flipped.size() / 2] ^= 1;
+  REQUIRE_THROWS_WITH(
+    espm::Browser(buf.data(), buf.size(), flipped.data(), flipped.size()),
+    Catch::Matchers::ContainsSubstring("checksum"));
+}
+
+namespace {
+// A compressed record with a single EDID field
+std::vector<uint8_t> MakeCompressedRecord(uint32_t id, const char* editorId)
+{
+  std::vector<uint8_t> fields = { 'E', 'D', 'I', 'D' };
+  auto size = static_cast<uint16_t>(strlen(editorId) + 1);
+  fields.push_back(static_cast<uint8_t>(size));
+  fields.push_back(static_cast<uint8_t>(size >> 8));
+  fields.insert(fields.end(), editorId, editorId + size);
+
+  std::vector<uint8_t> compressed(fields.size() + 64);
+  compressed.resize(ZlibCompress(fields.data(), fields.size(),
+                                 compressed.data(), compressed.size()));
+
+  const char kCompressedFlag[4] = { 0, 0, 0x04, 0 };
+  std::vector<uint8_t> buf;
+  AppendHeader(buf, "KYWD", static_cast<uint32_t>(4 + compressed.size()),
+               kCompressedFlag, id);
+  AppendUint32(buf, static_cast<uint32_t>(fields.size()));
+  buf.insert(buf.end(), compressed.begin(), compressed.end());
+  return buf;
+}
+
+const espm::RecordHeader* AsRecord(const std::vector<uint8_t>& buf)
+{
+  return reinterpret_cast<const espm::RecordHeader*>(buf.data() + 8);
+}
+}
+
+TEST_CASE("CompressedFieldsCache evicts least recently used fields on Trim",
+          "[espm]")
+{
+  auto a = MakeCompressedRecord(0x100, "RecordA");
+  auto b = MakeCompressedRecord(0x101, "RecordB");
+
+  espm::CompressedFieldsCache cache;
+  REQUIRE(std::string(AsRecord(a)->GetEditorId(cache)) == "RecordA");
+  REQUIRE(std::string(AsRecord(b)->GetEditorId(cache)) == "RecordB");
+  REQUIRE(std::string(AsRecord(a)->GetEditorId(cache)) == "RecordA");
+
+  auto stats = cache.GetStats();
+  REQUIRE(stats.misses == 2);
+  REQUIRE(stats.hits == 1);
+  REQUIRE(stats.numEntries == 2);
+
+  // Unbounded by default
+  cache.Trim();
+  REQUIRE(cache.GetStats().numEntries == 2);
+
+  // Room for one record only, B was used least recently
+  cache.SetMaxBytes(stats.numBytes / 2);
+  REQUIRE(!cache.IsWithinBudget());
+  cache.Trim();
+  stats = cache.GetStats();
+  REQUIRE(stats.numEntries == 1);
+  REQUIRE(stats.evictions == 1);
+  REQUIRE(cache.IsWithinBudget());
+
+  REQUIRE(std::string(AsRecord(a)->GetEditorId(cache)) == "RecordA");
+  REQUIRE(cache.GetStats().hits == 2);
+  REQUIRE(std::string(AsRecord(b)->GetEditorId(cache)) == "RecordB");
+  REQUIRE(cache.GetStats().misses == 3);
+}
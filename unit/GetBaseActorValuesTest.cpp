@@ -3,7 +3,9 @@
 #include "libespm/Loader.h"
 #include <catch2/catch_all.hpp>
 
+#include "EvaluateTemplate.h"
 #include "GetBaseActorValues.h"
+#include "TemplateChainCache.h"
 
 extern espm::Loader l;
 PartOne& GetPartOne();
@@ -32,3 +34,42 @@ TEST_CASE("GetBaseActorValues works correctly", "[GetBaseActorValues]")
   REQUIRE(baseValues.staminaRate == 5.f);
   REQUIRE(baseValues.magickaRate == 3.f);
 }
+
+TEST_CASE("GetBaseActorValues and EvaluateTemplate share one memoized chain "
+          "walk",
+          "[GetBaseActorValues]")
+{
+  const uint32_t kRisaadFormId = 0x0001B1DB;
+  const uint32_t kKhajiitRaceId = 0x00013745;
+
+  PartOne& p = GetPartOne();
+  auto& cache = p.worldState.GetTemplateChainCache();
+
+  auto& resolution = cache.Resolve(&p.worldState, kRisaadFormId, {});
+  REQUIRE(resolution.elements.size() >= 1);
+  REQUIRE(resolution.elements[0].formId == kRisaadFormId);
+  REQUIRE(resolution.FindSource(espm::NPC_::UseTraits) != nullptr);
+
+  auto sizeBefore = cache.GetSize();
+
+  uint32_t raceId = EvaluateTemplate<espm::NPC_::UseTraits>(
+    &p.worldState, kRisaadFormId, {},
+    [](const auto& npcLookupResult, const auto& npcData) {
+      return npcLookupResult.ToGlobalId(npcData.race);
+    });
+  REQUIRE(raceId == kKhajiitRaceId);
+
+  auto first = GetBaseActorValues(&p.worldState, kRisaadFormId, 0, {});
+  auto second = GetBaseActorValues(&p.worldState, kRisaadFormId, 0, {});
+  REQUIRE(first.health == second.health);
+  REQUIRE(first.healRate == second.healRate);
+  REQUIRE(resolution.baseActorValues.count(0) == 1);
+  REQUIRE(cache.GetSize() == sizeBefore);
+
+  // Not an NPC_, every flag fails and the error is still detailed
+  REQUIRE_THROWS_WITH(
+    (EvaluateTemplate<espm::NPC_::UseStats>(
+      &p.worldState, 0x3c, {}, [](const auto&, const auto&) { return 0; })),
+    Catch::Matchers::ContainsSubstring("EvaluateTemplate failed"));
+  REQUIRE(!cache.Resolve(&p.worldState, 0x3c, {}).IsFullyResolved());
+}
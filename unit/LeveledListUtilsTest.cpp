@@ -1,3 +1,4 @@
+#include "LeveledListCache.h"
 #include "LeveledListUtils.h"
 #include "libespm/Loader.h"
 #include "libespm/espm.h"
@@ -162,6 +163,27 @@ TEST_CASE("Evaluate LItemWeaponDaggerTown", "[espm]")
   REQUIRE(res[0x1397e] == 1000);
 }
 
+TEST_CASE("LeveledListCache gives the same loot for the same seed", "[espm]")
+{
+  auto LItemWeaponDaggerTown = 0x17177;
+  auto& br = GetEspmLoader().GetBrowser();
+  auto leveledList = br.LookupById(LItemWeaponDaggerTown);
+
+  LeveledListCache cache(br);
+  std::mt19937 a(123), b(123);
+  for (int i = 0; i < 100; ++i) {
+    auto resA = cache.EvaluateListRecurse(leveledList, a, 10);
+    auto resB = cache.EvaluateListRecurse(leveledList, b, 10);
+    REQUIRE(resA == resB);
+  }
+
+  // Nested lists are compiled once
+  auto size = cache.GetSize();
+  REQUIRE(size >= 1);
+  cache.EvaluateListRecurse(leveledList, a, 1000);
+  REQUIRE(cache.GetSize() == size);
+}
+
 TEST_CASE("Evaluate LCharHorse", "[espm]")
 {
   auto LCharHorse = 0x68d6f;
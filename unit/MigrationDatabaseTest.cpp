@@ -1,6 +1,7 @@
 #include "database_drivers/MigrationDatabase.h"
 #include "MpChangeForms.h"
 #include "TestUtils.hpp"
+#include "database_drivers/BinlogDatabase.h"
 #include "database_drivers/FileDatabase.h"
 #include <catch2/catch_all.hpp>
 
@@ -94,3 +95,29 @@ TEST_CASE("Migration Termination on Empty Old Database", "[MigrationDatabase]")
   REQUIRE(GetAllChangeForms(newDatabase) == std::set<MpChangeForm>{});
   REQUIRE(exited == true); // Check if the custom terminate was called
 }
+
+TEST_CASE("Migration from file to binlog database", "[MigrationDatabase]")
+{
+  std::atomic<bool> exited{ false };
+  auto customExit = [&exited]() { exited = true; };
+
+  auto oldDatabase = MakeDatabase("unit/data/old");
+  oldDatabase->Upsert({ CreateChangeForm_("1", { 1, 2, 3 }),
+                        CreateChangeForm_("2") });
+
+  if (std::filesystem::exists("unit/data/new_binlog")) {
+    std::filesystem::remove_all("unit/data/new_binlog");
+  }
+  auto newDatabase = std::make_shared<BinlogDatabase>(
+    "unit/data/new_binlog", spdlog::default_logger());
+
+  auto db =
+    std::make_shared<MigrationDatabase>(newDatabase, oldDatabase, customExit);
+  REQUIRE(GetAllChangeForms(newDatabase) == GetAllChangeForms(oldDatabase));
+  REQUIRE(exited == true);
+
+  // Reopening reads the same change forms back from disk
+  auto reopened = std::make_shared<BinlogDatabase>("unit/data/new_binlog",
+                                                   spdlog::default_logger());
+  REQUIRE(GetAllChangeForms(reopened) == GetAllChangeForms(oldDatabase));
+}
@@ -0,0 +1,110 @@
+#include "MovementRelayLod.h"
+#include <catch2/catch_all.hpp>
+
+using namespace std::chrono_literals;
+
+TEST_CASE("MovementRelayLod picks the update rate tier", "[MovementRelayLod]")
+{
+  MovementRelayLod lod;
+  const NiPoint3 listenerPos = { 0, 0, 0 };
+  const NiPoint3 viewNorth = { 0, 1, 0 };
+
+  // Near: full rate, whatever the direction
+  REQUIRE(lod.GetMinInterval(listenerPos, viewNorth, { 0, -1000, 0 },
+                             true) == 0ms);
+
+  // Far player: reduced rate
+  REQUIRE(lod.GetMinInterval(listenerPos, viewNorth, { 0, -6000, 0 },
+                             false) == 250ms);
+
+  // Far NPC in front of the listener: reduced rate
+  REQUIRE(lod.GetMinInterval(listenerPos, viewNorth, { 1000, 6000, 0 },
+                             true) == 250ms);
+
+  // Far NPC behind the listener: heartbeat only
+  REQUIRE(lod.GetMinInterval(listenerPos, viewNorth, { 1000, -6000, 0 },
+                             true) == 1000ms);
+}
+
+TEST_CASE("MovementRelayLod relays discrete state changes at once",
+          "[MovementRelayLod]")
+{
+  MovementRelayLod lod;
+  MovementRelayLod::RelayState state;
+
+  UpdateMovementMessage::Data data;
+  data.runMode = "Running";
+  auto running = MovementRelayLod::GetDiscreteState(data);
+
+  auto t0 = MovementRelayLod::Clock::now();
+  REQUIRE(lod.ShouldRelay(state, running, 250ms, t0));
+  REQUIRE(!lod.ShouldRelay(state, running, 250ms, t0 + 100ms));
+  REQUIRE(lod.ShouldRelay(state, running, 250ms, t0 + 250ms));
+
+  data.isWeapDrawn = true;
+  auto weapDrawn = MovementRelayLod::GetDiscreteState(data);
+  REQUIRE(weapDrawn != running);
+  REQUIRE(lod.ShouldRelay(state, weapDrawn, 250ms, t0 + 260ms));
+  REQUIRE(!lod.ShouldRelay(state, weapDrawn, 250ms, t0 + 270ms));
+
+  auto settings = lod.GetSettings();
+  settings.enabled = false;
+  lod.SetSettings(settings);
+  REQUIRE(lod.ShouldRelay(state, weapDrawn, 250ms, t0 + 280ms));
+}
+
+TEST_CASE("MovementRelayLod relays the last position of an actor that stops "
+          "while throttled",
+          "[MovementRelayLod]")
+{
+  MovementRelayLod lod;
+  MovementRelayLod::RelayState state;
+
+  UpdateMovementMessage msg;
+  msg.idx = 1;
+  msg.data.runMode = "Walking";
+  auto walking = MovementRelayLod::GetDiscreteState(msg.data);
+
+  auto t0 = MovementRelayLod::Clock::now();
+  REQUIRE(lod.ShouldRelay(state, walking, 250ms, t0));
+
+  // The actor takes a few more steps and stops within the interval
+  msg.data.pos = { 100, 0, 0 };
+  REQUIRE(!lod.ShouldRelay(state, walking, 250ms, t0 + 50ms));
+  REQUIRE(MovementRelayLod::HoldBack(state, msg, 250ms));
+  REQUIRE(state.heldBackDue == t0 + 250ms);
+
+  msg.data.pos = { 150, 0, 0 };
+  REQUIRE(!lod.ShouldRelay(state, walking, 250ms, t0 + 100ms));
+  REQUIRE(!MovementRelayLod::HoldBack(state, msg, 250ms));
+
+  REQUIRE(!MovementRelayLod::TakeHeldBack(state, t0 + 200ms));
+
+  auto heldBack = MovementRelayLod::TakeHeldBack(state, t0 + 250ms);
+  REQUIRE(heldBack);
+  REQUIRE(heldBack->data.pos == std::array<float, 3>{ 150, 0, 0 });
+  REQUIRE(!MovementRelayLod::TakeHeldBack(state, t0 + 300ms));
+
+  // The interval restarts from the time the held back movement was sent
+  REQUIRE(!lod.ShouldRelay(state, walking, 250ms, t0 + 400ms));
+  REQUIRE(lod.ShouldRelay(state, walking, 250ms, t0 + 500ms));
+}
+
+TEST_CASE("MovementRelayLod drops held back movement once newer is relayed",
+          "[MovementRelayLod]")
+{
+  MovementRelayLod lod;
+  MovementRelayLod::RelayState state;
+
+  UpdateMovementMessage msg;
+  auto standing = MovementRelayLod::GetDiscreteState(msg.data);
+
+  auto t0 = MovementRelayLod::Clock::now();
+  REQUIRE(lod.ShouldRelay(state, standing, 250ms, t0));
+  REQUIRE(!lod.ShouldRelay(state, standing, 250ms, t0 + 50ms));
+  REQUIRE(MovementRelayLod::HoldBack(state, msg, 250ms));
+
+  // A teleport is relayed regardless of the interval
+  REQUIRE(lod.ShouldRelay(state, standing, 0ms, t0 + 100ms));
+  REQUIRE(!MovementRelayLod::TakeHeldBack(state, t0 + 250ms));
+}
@@ -4,8 +4,11 @@
 #include <simdjson.h>
 #include <slikenet/BitStream.h>
 
+#include "MessageSerializerFactory.h"
+#include "UpdateMovementCompactMessage.h"
 #include "UpdateMovementMessage.h"
 
+#include <cmath>
 #include <fmt/ranges.h>
 
 namespace {
@@ -111,3 +114,116 @@ TEST_CASE("MovementMessage correctly encoded and decoded to BitStream",
     }
   }
 }
+
+namespace {
+float AngleDiff(float a, float b)
+{
+  float d = std::fmod(std::fabs(a - b), 360.f);
+  return std::min(d, 360.f - d);
+}
+}
+
+TEST_CASE("MovementMessage correctly encoded and decoded to compact BitStream",
+          "[Serialization]")
+{
+  using Compact = UpdateMovementCompactMessage;
+
+  for (const auto& [name, movData] : MakeTestMovementMessageCases()) {
+    SECTION(name)
+    {
+      REQUIRE(Compact::IsEncodable(movData.data));
+
+      SLNet::BitStream stream;
+      Compact(movData).WriteBinary(stream);
+
+      SLNet::BitStream legacyStream;
+      movData.WriteBinary(legacyStream);
+      REQUIRE(stream.GetNumberOfBytesUsed() <
+              legacyStream.GetNumberOfBytesUsed());
+
+      Compact movData2;
+      movData2.ReadBinary(stream);
+
+      auto &a = movData.data, &b = movData2.data;
+      REQUIRE(movData2.idx == movData.idx);
+      REQUIRE(b.worldOrCell == a.worldOrCell);
+      for (int i = 0; i < 3; ++i) {
+        REQUIRE(std::fabs(b.pos[i] - a.pos[i]) <= Compact::kPosError);
+        REQUIRE(AngleDiff(b.rot[i], a.rot[i]) <= Compact::kAngleError);
+      }
+      REQUIRE(AngleDiff(b.direction, a.direction) <= Compact::kAngleError);
+      REQUIRE(std::fabs(b.healthPercentage - a.healthPercentage) <=
+              Compact::kHealthPercentageError);
+      REQUIRE(std::fabs(b.speed - a.speed) <= Compact::kSpeedError);
+      REQUIRE(b.runMode == a.runMode);
+      REQUIRE(b.isInJumpState == a.isInJumpState);
+      REQUIRE(b.isSneaking == a.isSneaking);
+      REQUIRE(b.isBlocking == a.isBlocking);
+      REQUIRE(b.isWeapDrawn == a.isWeapDrawn);
+      REQUIRE(b.isDead == a.isDead);
+      REQUIRE(b.lookAt.has_value() == a.lookAt.has_value());
+
+      // Decoded values are exactly representable, so re-encoding is lossless
+      SLNet::BitStream stream2;
+      movData2.WriteBinary(stream2);
+      REQUIRE(stream.GetNumberOfBytesUsed() == stream2.GetNumberOfBytesUsed());
+      REQUIRE(memcmp(stream.GetData(), stream2.GetData(),
+                     stream.GetNumberOfBytesUsed()) == 0);
+    }
+  }
+}
+
+TEST_CASE("Compact movement rejects values it can't represent",
+          "[Serialization]")
+{
+  auto movData = MakeTestMovementMessage("Running", true);
+  REQUIRE(UpdateMovementCompactMessage::IsEncodable(movData.data));
+
+  auto unknownRunMode = movData;
+  unknownRunMode.data.runMode = "Flying";
+  REQUIRE(!UpdateMovementCompactMessage::IsEncodable(unknownRunMode.data));
+
+  auto nanPos = movData;
+  nanPos.data.pos[1] = std::nanf("");
+  REQUIRE(!UpdateMovementCompactMessage::IsEncodable(nanPos.data));
+
+  auto farPos = movData;
+  farPos.data.pos[0] = 1e7;
+  REQUIRE(!UpdateMovementCompactMessage::IsEncodable(farPos.data));
+}
+
+TEST_CASE("MessageSerializer sends movement compact when enabled",
+          "[Serialization]")
+{
+  auto movData = MakeTestMovementMessage("Walking", false);
+  nlohmann::json json;
+  movData.WriteJson(json);
+  auto jsonDump = json.dump();
+
+  auto serializer = MessageSerializerFactory::CreateMessageSerializer();
+
+  // Disabled by default: old servers can't parse compact movement
+  SLNet::BitStream plainStream;
+  serializer->Serialize(jsonDump.data(), plainStream);
+  REQUIRE(plainStream.GetNumberOfBytesUsed() >= 2);
+  REQUIRE(plainStream.GetData()[1] ==
+          static_cast<uint8_t>(MsgType::UpdateMovement));
+
+  serializer->SetCompactMovementEnabled(true);
+
+  SLNet::BitStream stream;
+  serializer->Serialize(jsonDump.data(), stream);
+  REQUIRE(stream.GetNumberOfBytesUsed() >= 2);
+  REQUIRE(stream.GetData()[1] ==
+          static_cast<uint8_t>(MsgType::UpdateMovementCompact));
+
+  auto result =
+    serializer->Deserialize(stream.GetData(), stream.GetNumberOfBytesUsed());
+  REQUIRE(result.has_value());
+  REQUIRE(result->msgType == MsgType::UpdateMovementCompact);
+
+  nlohmann::json json2;
+  result->message->WriteJson(json2);
+  REQUIRE(json2["t"].get<int>() ==
+          static_cast<int>(UpdateMovementMessage::kMsgType.value));
+}
@@ -39,3 +39,120 @@ TEST_CASE("Disable makes ref invisible", "[ObjectReference]")
   ref.Enable();
   REQUIRE(ref.GetListeners() == std::set<MpObjectReference*>{ &ac });
 }
+
+TEST_CASE("Property broadcast is serialized once for all listeners",
+          "[ObjectReference]")
+{
+  class RecordingSendTarget : public Networking::ISendTarget
+  {
+  public:
+    void Send(Networking::UserId targetUserId, Networking::PacketData data,
+              size_t length, bool reliable) override
+    {
+      sends.push_back({ targetUserId, data, length });
+    }
+
+    std::vector<std::tuple<Networking::UserId, Networking::PacketData, size_t>>
+      sends;
+  };
+
+  RecordingSendTarget sendTarget;
+  PartOne p(&sendTarget);
+
+  auto& ref = CreateMpObjectReference_(p.worldState, 0xff000000);
+  ref.SetCellOrWorld(FormDesc::Tamriel());
+
+  for (Networking::UserId userId = 0; userId < 2; ++userId) {
+    p.CreateActor(0xff000001 + userId, { 0, 0, 0 }, 0, 0x3c);
+    DoConnect(p, userId);
+    p.SetUserActor(userId, 0xff000001 + userId);
+    DoUpdateMovement(p, 0xff000001 + userId, userId);
+  }
+
+  sendTarget.sends.clear();
+  ref.SetPropertyValueDump("myProp", "1", false, true);
+
+  REQUIRE(sendTarget.sends.size() == 2);
+  auto [userA, dataA, lengthA] = sendTarget.sends[0];
+  auto [userB, dataB, lengthB] = sendTarget.sends[1];
+  REQUIRE(userA != userB);
+  REQUIRE(dataA == dataB);
+  REQUIRE(lengthA == lengthB);
+}
+
+TEST_CASE("Subscriptions follow the grid when moving across cells",
+          "[ObjectReference]")
+{
+  PartOne p;
+
+  // One actor per cell in a 7x7 block around the origin
+  std::vector<MpActor*> actors;
+  for (int x = -3; x <= 3; ++x) {
+    for (int y = -3; y <= 3; ++y) {
+      auto formId = p.CreateActor(
+        0, { x * 4096.f + 100.f, y * 4096.f + 100.f, 0 }, 0, 0x3c);
+      actors.push_back(&p.worldState.GetFormAt<MpActor>(formId));
+      actors.back()->SetPos(actors.back()->GetPos());
+    }
+  }
+
+  auto formId = p.CreateActor(0, { 100.f, 100.f, 0 }, 0, 0x3c);
+  auto& mover = p.worldState.GetFormAt<MpActor>(formId);
+  mover.SetPos(mover.GetPos());
+
+  auto requireConsistent = [&] {
+    auto moverCell = std::make_pair(int(mover.GetPos().x / 4096),
+                                    int(mover.GetPos().y / 4096));
+    std::set<MpObjectReference*> expected = { &mover };
+    for (auto actor : actors) {
+      auto cell = std::make_pair(int(actor->GetPos().x / 4096),
+                                 int(actor->GetPos().y / 4096));
+      bool adjacent = std::abs(cell.first - moverCell.first) <= 1 &&
+        std::abs(cell.second - moverCell.second) <= 1;
+      if (adjacent) {
+        expected.insert(actor);
+      }
+      REQUIRE(actor->GetListeners().count(&mover) == (adjacent ? 1 : 0));
+    }
+    REQUIRE(mover.GetListeners() == expected);
+  };
+
+  requireConsistent();
+
+  // Orthogonal, diagonal and non-adjacent moves
+  std::vector<std::pair<float, float>> path = {
+    { 1, 0 }, { 1, 1 }, { 0, 1 }, { -1, 1 }, { -2, 0 }, { -1, -1 },
+    { 3, 3 }, { 2, 2 }, { -3, -3 }, { 0, 0 }
+  };
+  for (auto [x, y] : path) {
+    mover.SetPos({ x * 4096.f + 100.f, y * 4096.f + 100.f, 0 });
+    requireConsistent();
+  }
+}
+
+TEST_CASE("Moving across cells unsubscribes disabled listeners",
+          "[ObjectReference]")
+{
+  PartOne p;
+
+  auto moverId = p.CreateActor(0, { 100.f, 100.f, 0 }, 0, 0x3c);
+  auto& mover = p.worldState.GetFormAt<MpActor>(moverId);
+  mover.SetPos(mover.GetPos());
+
+  auto disabledId = p.CreateActor(0, { 200.f, 200.f, 0 }, 0, 0x3c);
+  auto& disabled = p.worldState.GetFormAt<MpActor>(disabledId);
+  disabled.SetPos(disabled.GetPos());
+  REQUIRE(mover.GetListeners().count(&disabled) == 1);
+  REQUIRE(disabled.GetListeners().count(&mover) == 1);
+
+  // Leaves the grid, but keeps listening to the mover
+  disabled.Disable();
+  REQUIRE(disabled.GetListeners().count(&mover) == 0);
+  REQUIRE(mover.GetListeners().count(&disabled) == 1);
+
+  // An adjacent move goes through CollectSubscriptionsDelta
+  mover.SetPos({ 4096.f + 100.f, 100.f, 0 });
+  REQUIRE(mover.GetListeners().count(&disabled) == 0);
+  REQUIRE(mover.GetListeners().count(&mover) == 1);
+  REQUIRE(disabled.GetEmitters().count(&mover) == 0);
+}
@@ -0,0 +1,169 @@
+#include "MessageBundle.h"
+#include "OutboundBatcher.h"
+#include <catch2/catch_all.hpp>
+#include <string>
+#include <vector>
+
+namespace {
+class RecordingSendTarget : public Networking::ISendTarget
+{
+public:
+  struct Packet
+  {
+    Networking::UserId userId = Networking::InvalidUserId;
+    std::vector<uint8_t> data;
+    bool reliable = false;
+  };
+
+  void Send(Networking::UserId targetUserId, Networking::PacketData data,
+            size_t length, bool reliable) override
+  {
+    packets.push_back({ targetUserId, { data, data + length }, reliable });
+  }
+
+  std::vector<Packet> packets;
+};
+
+std::vector<uint8_t> MakeMessage(const std::string& s)
+{
+  std::vector<uint8_t> res = { Networking::MinPacketId };
+  res.insert(res.end(), s.begin(), s.end());
+  return res;
+}
+
+std::vector<std::string> Unbundle(const std::vector<uint8_t>& packet)
+{
+  std::vector<std::string> res;
+  auto add = [&](const uint8_t* data, size_t length) {
+    REQUIRE(data[0] == Networking::MinPacketId);
+    res.emplace_back(reinterpret_cast<const char*>(data) + 1, length - 1);
+  };
+
+  if (!MessageBundle::IsBundle(packet.data(), packet.size())) {
+    add(packet.data(), packet.size());
+  } else {
+    REQUIRE(MessageBundle::ForEach(packet.data(), packet.size(), add));
+  }
+  return res;
+}
+}
+
+TEST_CASE("OutboundBatcher sends one bundle per user and reliability",
+          "[OutboundBatcher]")
+{
+  RecordingSendTarget target;
+  OutboundBatcher batcher(target);
+
+  for (auto s : { "{a}", "{b}", "{c}" }) {
+    auto msg = MakeMessage(s);
+    batcher.Enqueue(1, msg.data(), msg.size(), true);
+  }
+  auto unreliable = MakeMessage("{d}");
+  batcher.Enqueue(1, unreliable.data(), unreliable.size(), false);
+  batcher.Enqueue(2, unreliable.data(), unreliable.size(), false);
+
+  REQUIRE(target.packets.empty());
+  batcher.Flush();
+
+  REQUIRE(target.packets.size() == 3);
+  REQUIRE(target.packets[0].userId == 1);
+  REQUIRE(target.packets[0].reliable);
+  REQUIRE(Unbundle(target.packets[0].data) ==
+          std::vector<std::string>{ "{a}", "{b}", "{c}" });
+
+  // A single message is sent as is, without the bundle header
+  REQUIRE(target.packets[1].userId == 1);
+  REQUIRE(!target.packets[1].reliable);
+  REQUIRE(target.packets[1].data == unreliable);
+  REQUIRE(target.packets[2].userId == 2);
+  REQUIRE(target.packets[2].data == unreliable);
+
+  target.packets.clear();
+  batcher.Flush();
+  REQUIRE(target.packets.empty());
+}
+
+TEST_CASE("OutboundBatcher keeps the latest coalesced message",
+          "[OutboundBatcher]")
+{
+  RecordingSendTarget target;
+  OutboundBatcher batcher(target);
+
+  auto enqueue = [&](const std::string& s, uint64_t key) {
+    auto msg = MakeMessage(s);
+    batcher.EnqueueCoalesced(1, msg.data(), msg.size(), key);
+  };
+  enqueue("{mov1 old}", 1);
+  enqueue("{mov2}", 2);
+  enqueue("{mov1 new}", 1);
+
+  auto anim = MakeMessage("{anim}");
+  batcher.Enqueue(1, anim.data(), anim.size(), false);
+
+  batcher.Flush();
+  REQUIRE(target.packets.size() == 1);
+  REQUIRE(Unbundle(target.packets[0].data) ==
+          std::vector<std::string>{ "{mov2}", "{mov1 new}", "{anim}" });
+}
+
+TEST_CASE("OutboundBatcher splits bundles at kMaxBundleSize",
+          "[OutboundBatcher]")
+{
+  RecordingSendTarget target;
+  OutboundBatcher batcher(target);
+
+  std::string payload(100, 'x');
+  auto msg = MakeMessage(payload);
+  for (int i = 0; i < 50; ++i) {
+    batcher.Enqueue(1, msg.data(), msg.size(), false);
+  }
+  auto huge = MakeMessage(std::string(OutboundBatcher::kMaxBundleSize, 'y'));
+  batcher.Enqueue(1, huge.data(), huge.size(), false);
+
+  batcher.Flush();
+
+  size_t numMessages = 0;
+  for (auto& packet : target.packets) {
+    REQUIRE((packet.data.size() <= OutboundBatcher::kMaxBundleSize ||
+             packet.data == huge));
+    numMessages += Unbundle(packet.data).size();
+  }
+  REQUIRE(numMessages == 51);
+  REQUIRE(target.packets.back().data == huge);
+}
+
+TEST_CASE("OutboundBatcher drops messages of forgotten users",
+          "[OutboundBatcher]")
+{
+  RecordingSendTarget target;
+  OutboundBatcher batcher(target);
+
+  auto msg = MakeMessage("{a}");
+  batcher.Enqueue(1, msg.data(), msg.size(), true);
+  batcher.EnqueueCoalesced(1, msg.data(), msg.size(), 1);
+  batcher.Forget(1);
+  batcher.Flush();
+  REQUIRE(target.packets.empty());
+}
+
+TEST_CASE("MessageBundle rejects truncated bundles", "[OutboundBatcher]")
+{
+  std::vector<uint8_t> bundle;
+  auto msg = MakeMessage("{a}");
+  MessageBundle::Append(bundle, msg.data(), msg.size());
+  MessageBundle::Append(bundle, msg.data(), msg.size());
+
+  for (size_t n = MessageBundle::kHeaderSize + 1; n < bundle.size(); ++n) {
+    int visited = 0;
+    bool valid = MessageBundle::ForEach(
+      bundle.data(), n, [&](const uint8_t*, size_t) { ++visited; });
+    if (n == MessageBundle::kHeaderSize + MessageBundle::kLengthPrefixSize +
+          msg.size()) {
+      REQUIRE(valid);
+      REQUIRE(visited == 1);
+    } else {
+      REQUIRE(!valid);
+      REQUIRE(visited == 0);
+    }
+  }
+}
@@ -136,6 +136,25 @@ TEST_CASE("Disconnect event sent before user actually disconnects",
   partOne.reset();
 }
 
+TEST_CASE("Server advertises compact movement on connect only if enabled",
+          "[PartOne]")
+{
+  PartOne partOne;
+
+  DoConnect(partOne, 0);
+  REQUIRE(partOne.Messages().empty());
+
+  partOne.EnableCompactMovement(true);
+  DoConnect(partOne, 1);
+
+  REQUIRE(partOne.Messages().size() == 1);
+  REQUIRE(partOne.Messages()[0].j ==
+          nlohmann::json{ { "t", static_cast<int>(MsgType::ServerFeatures) },
+                          { "compactMovement", true } });
+  REQUIRE(partOne.Messages()[0].userId == 1);
+  REQUIRE(partOne.Messages()[0].reliable);
+}
+
 TEST_CASE("Server custom packet", "[PartOne]")
 {
 
@@ -1,45 +1,11 @@
 #include "TestUtils.hpp"
-#include "script_storages/DirectoryScriptStorage.h"
 
 #include "Messages.h"
 
 using Catch::Matchers::ContainsSubstring;
 
-extern espm::Loader& GetEspmLoader();
-
-class FakeDamageFormula : public IDamageFormula
-{
-public:
-  [[nodiscard]] float CalculateDamage(const MpActor&, const MpActor&,
-                                      const HitData&) const override
-  {
-    return 25.f;
-  }
-
-  [[nodiscard]] float CalculateDamage(const MpActor&, const MpActor&,
-                                      const SpellCastData&) const override
-  {
-    return 25.f;
-  }
-};
-
 // Actually, there are a few utils
 espm::CompressedFieldsCache g_dummyCache;
-PartOne& GetPartOne()
-{
-  auto instance = std::make_shared<PartOne>();
-  instance->SetDamageFormula(std::make_unique<FakeDamageFormula>());
-
-  instance->worldState.AttachScriptStorage(
-    std::make_shared<DirectoryScriptStorage>(TEST_PEX_DIR));
-  instance->AttachEspm(&GetEspmLoader());
-
-  instance->worldState.bannedEspmCharacterRaceIds.clear();
-
-  static std::vector<std::shared_ptr<PartOne>> g_partOneInstances;
-  g_partOneInstances.push_back(instance);
-  return *g_partOneInstances.back();
-}
 
 constexpr auto barrelInWhiterun = 0x4cc2d;
 
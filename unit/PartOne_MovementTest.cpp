@@ -1,4 +1,5 @@
 #include "TestUtils.hpp"
+#include <algorithm>
 
 TEST_CASE("Hypothesis: UpdateMovement may send nothing when actor without "
           "user present",
@@ -133,3 +134,39 @@ TEST_CASE("UpdateMovement", "[PartOne]")
                            m.j["idx"] == 0 && m.reliable && m.userId == 1;
                        }) != partOne.Messages().end());
 }
+
+TEST_CASE("UpdateMovement is throttled for distant listeners", "[PartOne]")
+{
+  PartOne partOne;
+
+  for (int i = 0; i < 2; ++i) {
+    DoConnect(partOne, i);
+    partOne.CreateActor(i + 0xff000ABC, { i * 6000.f, 0.f, 0.f }, 180.f,
+                        0x3c);
+    partOne.SetUserActor(i, i + 0xff000ABC);
+  }
+
+  auto countMessagesFor = [&](Networking::UserId userId) {
+    return std::count_if(
+      partOne.Messages().begin(), partOne.Messages().end(),
+      [&](auto& m) { return m.userId == userId; });
+  };
+
+  partOne.Messages().clear();
+  DoMessage(partOne, 0, jMovement);
+  REQUIRE(countMessagesFor(0) == 1);
+  REQUIRE(countMessagesFor(1) == 1);
+
+  // Too soon for a listener one cell away, the sender still gets its own
+  partOne.Messages().clear();
+  DoMessage(partOne, 0, jMovement);
+  REQUIRE(countMessagesFor(0) == 1);
+  REQUIRE(countMessagesFor(1) == 0);
+
+  // Run mode changes are relayed at once
+  auto m = jMovement;
+  m["data"]["runMode"] = "Running";
+  partOne.Messages().clear();
+  DoMessage(partOne, 0, m);
+  REQUIRE(countMessagesFor(1) == 1);
+}
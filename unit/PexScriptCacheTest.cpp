@@ -0,0 +1,75 @@
+#include "TestUtils.hpp"
+#include <catch2/catch_all.hpp>
+
+#include "papyrus-vm/Reader.h"
+#include "script_storages/DirectoryScriptStorage.h"
+#include "script_storages/PexScriptCache.h"
+
+TEST_CASE("DirectoryScriptStorage returns the same buffer until the file "
+          "changes",
+          "[PexScriptCache]")
+{
+  DirectoryScriptStorage storage(BUILT_PEX_DIR);
+  REQUIRE(storage.ListScripts(false).count("OpcodesTest"));
+
+  auto pex = storage.GetScriptPex("OpcodesTest");
+  REQUIRE(pex);
+  REQUIRE(!pex->empty());
+  REQUIRE(storage.GetScriptPex("OpcodesTest") == pex);
+  REQUIRE(storage.GetScriptPex("NonExistentScript") == nullptr);
+}
+
+TEST_CASE("PexScriptCache parses each distinct pex once", "[PexScriptCache]")
+{
+  DirectoryScriptStorage storage(BUILT_PEX_DIR);
+  auto pex = storage.GetScriptPex("OpcodesTest");
+  REQUIRE(pex);
+
+  PexScriptCache cache;
+  auto script = cache.Get(pex);
+  REQUIRE(script);
+  REQUIRE(cache.Get(pex) == script);
+
+  // Same contents in another buffer
+  auto copy = std::make_shared<const std::vector<uint8_t>>(*pex);
+  REQUIRE(cache.Get(copy) == script);
+  REQUIRE(cache.GetNumScripts() == 1);
+
+  auto& scripts = storage.ListScripts(false);
+  cache.Preload(storage, scripts, 4);
+  REQUIRE(cache.GetNumScripts() == scripts.size());
+  REQUIRE(cache.Get(pex) == script);
+  REQUIRE(cache.Get(storage.GetScriptPex("LatentTest")) != script);
+  REQUIRE(cache.GetNumScripts() == scripts.size());
+}
+
+TEST_CASE("PexScriptCache drops forgotten scripts", "[PexScriptCache]")
+{
+  DirectoryScriptStorage storage(BUILT_PEX_DIR);
+  auto pex = storage.GetScriptPex("OpcodesTest");
+  REQUIRE(pex);
+
+  PexScriptCache cache;
+  std::weak_ptr<PexScript> weak = cache.Get(pex);
+  cache.Get(storage.GetScriptPex("LatentTest"));
+  REQUIRE(cache.GetNumScripts() == 2);
+
+  cache.Forget(std::make_shared<const std::vector<uint8_t>>(*pex));
+  REQUIRE(cache.GetNumScripts() == 1);
+  REQUIRE(weak.expired());
+
+  cache.Forget(pex);
+  REQUIRE(cache.GetNumScripts() == 1);
+  REQUIRE(cache.Get(pex));
+  REQUIRE(cache.GetNumScripts() == 2);
+}
+
+TEST_CASE("Reader throws on truncated pex", "[PexScriptCache]")
+{
+  DirectoryScriptStorage storage(BUILT_PEX_DIR);
+  auto pex = storage.GetScriptPex("OpcodesTest");
+  REQUIRE(pex);
+
+  REQUIRE_THROWS_WITH(Reader(pex->data(), pex->size() / 2),
+                      "Unexpected end of pex");
+}
@@ -20,7 +20,7 @@ TEST_CASE("GetPrimitiveVertices", "[primitive][espm]")
   auto refr = espm::Convert<espm::REFR>(br.LookupById(0xeeb).rec);
   REQUIRE(refr);
 
-  auto vertices = Primitive::GetVertices(refr);
+  auto vertices = Primitive::GetVertices(refr, br.GetCache());
   REQUIRE(Str(vertices[0]) == Str(NiPoint3(24057, -10083, -3450)));
   REQUIRE(Str(vertices[1]) == Str(NiPoint3(24267, -10300, -3450)));
   REQUIRE(Str(vertices[2]) == Str(NiPoint3(23888, -10666, -3450)));
@@ -39,8 +39,10 @@ TEST_CASE("IsInsidePrimitive", "[primitive][espm]")
 
   REQUIRE(Primitive::IsInside({ 24000.0000f, -10176.0000f, -3392.0000f },
                               Primitive::CreateGeoPolygonProc(
-                                Primitive::GetVertices(refr))) == true);
+                                Primitive::GetVertices(
+                                  refr, br.GetCache()))) == true);
   REQUIRE(Primitive::IsInside({ 23872.0000f, -10176.0000f, -3392.0000f },
                               Primitive::CreateGeoPolygonProc(
-                                Primitive::GetVertices(refr))) == false);
+                                Primitive::GetVertices(
+                                  refr, br.GetCache()))) == false);
 }
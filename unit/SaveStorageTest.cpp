@@ -2,6 +2,7 @@
 
 #include "FormDesc.h"
 #include "MpChangeForms.h"
+#include "database_drivers/BinlogDatabase.h"
 #include "database_drivers/FileDatabase.h"
 #include "database_drivers/ZipDatabase.h"
 #include "save_storages/AsyncSaveStorage.h"
@@ -29,8 +30,10 @@ MakeSaveStorageZip()
 {
   auto archivePath = "world.zip";
 
-  if (std::filesystem::exists(archivePath)) {
-    std::filesystem::remove(archivePath);
+  for (auto path : { "world.zip", "world.zip.segment" }) {
+    if (std::filesystem::exists(path)) {
+      std::filesystem::remove(path);
+    }
   }
 
   return std::make_shared<
@@ -39,11 +42,28 @@ MakeSaveStorageZip()
     spdlog::default_logger(), "zip");
 }
 
+std::shared_ptr<
+  Viet::ISaveStorage<MpChangeForm, FormDesc, std::vector<FormDesc>>>
+MakeSaveStorageBinlog()
+{
+  auto directory = "unit/data_binlog";
+
+  if (std::filesystem::exists(directory)) {
+    std::filesystem::remove_all(directory);
+  }
+
+  return std::make_shared<
+    Viet::AsyncSaveStorage<MpChangeForm, FormDesc, std::vector<FormDesc>>>(
+    std::make_shared<BinlogDatabase>(directory, spdlog::default_logger()),
+    spdlog::default_logger(), "binlog");
+}
+
 std::vector<std::shared_ptr<
   Viet::ISaveStorage<MpChangeForm, FormDesc, std::vector<FormDesc>>>>
 MakeSaveStorages()
 {
-  return { MakeSaveStorageFile(), MakeSaveStorageZip() };
+  return { MakeSaveStorageFile(), MakeSaveStorageZip(),
+           MakeSaveStorageBinlog() };
 }
 
 MpChangeForm CreateChangeForm(const char* descStr)
@@ -242,3 +262,165 @@ TEST_CASE("Changes are transferred to SaveStorage", "[save]")
     }
   }
 }
+
+TEST_CASE("ZipDatabase merges upserted change forms into the archive",
+          "[save]")
+{
+  auto archivePath = "world_merge.zip";
+  auto segmentPath = "world_merge.zip.segment";
+
+  for (auto path : { archivePath, segmentPath }) {
+    if (std::filesystem::exists(path)) {
+      std::filesystem::remove(path);
+    }
+  }
+
+  auto findAll = [&](ZipDatabase& db) {
+    std::map<FormDesc, MpChangeForm> res;
+    db.Iterate([&](const MpChangeForm& f) { res[f.formDesc] = f; },
+               std::nullopt);
+    return res;
+  };
+
+  {
+    ZipDatabase db(archivePath, spdlog::default_logger());
+
+    auto f1 = CreateChangeForm("1");
+    f1.position = { 1, 1, 1 };
+    db.Upsert({ f1, CreateChangeForm("2") });
+
+    f1.position = { 2, 2, 2 };
+    db.Upsert({ f1 });
+
+    auto res = findAll(db);
+    REQUIRE(res.size() == 2);
+    REQUIRE(res[FormDesc::FromString("1")].position == NiPoint3(2, 2, 2));
+  }
+
+  // Destruction merges the segment, so the archive alone is enough
+  std::filesystem::remove(segmentPath);
+
+  ZipDatabase db(archivePath, spdlog::default_logger());
+  auto res = findAll(db);
+  REQUIRE(res.size() == 2);
+  REQUIRE(res[FormDesc::FromString("1")].position == NiPoint3(2, 2, 2));
+}
+
+TEST_CASE("ZipDatabase merges full segments in the background", "[save]")
+{
+  auto archivePath = "world_bg_merge.zip";
+  auto segmentPath = "world_bg_merge.zip.segment";
+  auto mergingPath = "world_bg_merge.zip.segment.merging";
+
+  for (auto path : { archivePath, segmentPath, mergingPath }) {
+    if (std::filesystem::exists(path)) {
+      std::filesystem::remove(path);
+    }
+  }
+
+  auto findAll = [&](ZipDatabase& db) {
+    std::map<FormDesc, MpChangeForm> res;
+    db.Iterate([&](const MpChangeForm& f) { res[f.formDesc] = f; },
+               std::nullopt);
+    return res;
+  };
+
+  {
+    // Every upsert overflows the segment
+    ZipDatabase db(archivePath, spdlog::default_logger(), 1);
+
+    auto f1 = CreateChangeForm("1");
+    for (int i = 0; i < 10; ++i) {
+      f1.position = { float(i), 0, 0 };
+      db.Upsert({ f1, CreateChangeForm(std::to_string(i + 2).data()) });
+    }
+
+    auto res = findAll(db);
+    REQUIRE(res.size() == 11);
+    REQUIRE(res[FormDesc::FromString("1")].position == NiPoint3(9, 0, 0));
+    REQUIRE(std::filesystem::exists(archivePath));
+  }
+
+  REQUIRE(!std::filesystem::exists(mergingPath));
+  std::filesystem::remove(segmentPath);
+
+  ZipDatabase db(archivePath, spdlog::default_logger());
+  auto res = findAll(db);
+  REQUIRE(res.size() == 11);
+  REQUIRE(res[FormDesc::FromString("1")].position == NiPoint3(9, 0, 0));
+}
+
+TEST_CASE("MpChangeForm::ToJson writes only requested field groups", "[save]")
+{
+  MpChangeForm f = CreateChangeForm("1");
+  f.templateChain = { FormDesc::FromString("2") };
+  f.setNodeTextureSet = std::map<std::string, std::string>();
+  f.setNodeScale = std::map<std::string, float>();
+  f.displayName = "name";
+  f.factions = { Faction() };
+
+  std::set<std::string> keys;
+  for (auto& [key, value] : MpChangeForm::ToJson(f).items()) {
+    keys.insert(key);
+  }
+  auto allKeys = MpChangeForm::GetJsonKeys(MpChangeFormField::All);
+  REQUIRE(keys == std::set<std::string>(allKeys.begin(), allKeys.end()));
+
+  auto j = MpChangeForm::ToJson(f, MpChangeFormField::Position);
+  REQUIRE(j.size() == 4);
+  REQUIRE(j["formDesc"] == "1");
+  REQUIRE(j.contains("position"));
+  REQUIRE(j.contains("angle"));
+  REQUIRE(j.contains("worldOrCellDesc"));
+}
+
+namespace {
+class DirtyFieldGroupsRecorder
+  : public Viet::IDatabase<MpChangeForm, FormDesc, std::vector<FormDesc>>
+{
+public:
+  void Iterate(const IterateCallback&,
+               std::optional<std::vector<FormDesc>>) override
+  {
+  }
+
+  std::vector<uint32_t> dirtyFieldGroups;
+
+private:
+  std::vector<std::optional<MpChangeForm>>&& UpsertImpl(
+    std::vector<std::optional<MpChangeForm>>&& changeForms,
+    size_t& outNumUpserted) override
+  {
+    for (auto& changeForm : changeForms) {
+      if (changeForm) {
+        dirtyFieldGroups.push_back(changeForm->dirtyFieldGroups);
+      }
+    }
+    outNumUpserted = changeForms.size();
+    return std::move(changeForms);
+  }
+};
+}
+
+TEST_CASE("Only changed field groups are marked dirty after the first save",
+          "[save]")
+{
+  auto db = std::make_shared<DirtyFieldGroupsRecorder>();
+  auto st = std::make_shared<
+    Viet::AsyncSaveStorage<MpChangeForm, FormDesc, std::vector<FormDesc>>>(
+    db, spdlog::default_logger(), "recorder");
+
+  PartOne p;
+  p.AttachSaveStorage(st);
+
+  p.CreateActor(0xffaaaeee, { 1, 1, 1 }, 1, 0x3c);
+  WaitForNextUpsert(*st, p.worldState);
+  REQUIRE(db->dirtyFieldGroups.front() == MpChangeFormField::All);
+
+  auto& ac = p.worldState.GetFormAt<MpActor>(0xffaaaeee);
+  ac.SetPos({ 2, 2, 2 });
+  ac.SetEquipment(Equipment());
+  WaitForNextUpsert(*st, p.worldState);
+  REQUIRE(db->dirtyFieldGroups.back() ==
+          (MpChangeFormField::Position | MpChangeFormField::Equipment));
+}
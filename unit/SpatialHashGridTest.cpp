@@ -0,0 +1,82 @@
+#include "Grid.h"
+#include "SpatialHashGrid.h"
+#include <catch2/catch_all.hpp>
+#include <random>
+
+using formid = uint64_t;
+
+TEST_CASE("SpatialHashGrid Move/GetPos/Forget", "[SpatialHashGrid]")
+{
+  SpatialHashGrid<formid> gr;
+  gr.Move(0xABCD, 125, -40);
+  REQUIRE(gr.GetPos(0xABCD) == std::pair<int16_t, int16_t>(125, -40));
+  gr.Move(0xABCD, -111, -111);
+  REQUIRE(gr.GetPos(0xABCD) == std::pair<int16_t, int16_t>(-111, -111));
+  gr.Forget(0xABCD);
+  REQUIRE_THROWS(gr.GetPos(0xABCD));
+  REQUIRE(gr.GetNeighboursByPosition(-111, -111).empty());
+}
+
+TEST_CASE("SpatialHashGrid GetNeighbours", "[SpatialHashGrid]")
+{
+  SpatialHashGrid<formid> gr;
+  gr.Move(0xA200, 0, 0);
+  gr.Move(0xA111, -1, 0);
+  gr.Move(0xA101, 0, -1);
+  gr.Move(0xA100, -1, -1);
+
+  REQUIRE(gr.GetNeighbours(0xA200) ==
+          std::set<formid>({ 0xA100, 0xA101, 0xA111 }));
+
+  REQUIRE(gr.GetNeighboursByPosition(0, 0) ==
+          std::set<formid>({ 0xA100, 0xA101, 0xA111, 0xA200 }));
+
+  gr.Forget(0xA100);
+  gr.Move(0xA111, 5, 5);
+
+  REQUIRE(gr.GetNeighboursByPosition(0, 0) ==
+          std::set<formid>({ 0xA101, 0xA200 }));
+  REQUIRE(gr.GetNeighbours(0xA111) == std::set<formid>({}));
+}
+
+TEST_CASE("SpatialHashGrid matches GridImpl on random moves",
+          "[SpatialHashGrid]")
+{
+  Grid reference;
+  SpatialHashGrid<formid> gr;
+
+  std::mt19937 rng(1234);
+  std::uniform_int_distribution<int> coord(-4, 4);
+  std::uniform_int_distribution<int> id(0, 63);
+
+  for (int i = 0; i < 5000; ++i) {
+    formid obj = id(rng);
+    if (i % 7 == 0) {
+      reference.Forget(obj);
+      gr.Forget(obj);
+    } else {
+      auto x = static_cast<int16_t>(coord(rng));
+      auto y = static_cast<int16_t>(coord(rng));
+      reference.Move(obj, x, y);
+      gr.Move(obj, x, y);
+    }
+
+    auto x = static_cast<int16_t>(coord(rng));
+    auto y = static_cast<int16_t>(coord(rng));
+    REQUIRE(gr.GetNeighboursByPosition(x, y) ==
+            reference.GetNeighboursByPosition(x, y));
+  }
+}
+
+TEST_CASE("SpatialHashGrid ForEachNeighbour visits the 3x3 area",
+          "[SpatialHashGrid]")
+{
+  SpatialHashGrid<formid> gr;
+  gr.Move(0xA200, 0, 0);
+  gr.Move(0xA111, -1, 1);
+  gr.Move(0xA300, 2, 0);
+
+  std::set<formid> visited;
+  gr.ForEachNeighbour(0, 0, [&](formid id) { visited.insert(id); });
+  REQUIRE(visited == std::set<formid>({ 0xA111, 0xA200 }));
+}
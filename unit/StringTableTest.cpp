@@ -0,0 +1,24 @@
+#include "papyrus-vm/StringTable.h"
+#include <catch2/catch_all.hpp>
+
+TEST_CASE("StringTable copies and moves keep FindIndex working",
+          "[StringTable]")
+{
+  auto original = std::make_unique<StringTable>();
+  original->SetStorage({ "a", "OnInit", "a string too long to be inline" });
+
+  StringTable copy(*original);
+  StringTable assigned;
+  assigned = *original;
+  original.reset();
+
+  for (auto* table : { &copy, &assigned }) {
+    REQUIRE(table->FindIndex("a") == 0);
+    REQUIRE(table->FindIndex("OnInit") == 1);
+    REQUIRE(table->FindIndex("a string too long to be inline") == 2);
+    REQUIRE(table->FindIndex("b") == std::nullopt);
+  }
+
+  StringTable moved(std::move(copy));
+  REQUIRE(moved.FindIndex("OnInit") == 1);
+}
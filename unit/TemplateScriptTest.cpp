@@ -10,12 +10,12 @@ PartOne& GetPartOne();
 namespace {
 class MyScriptStorage : public IScriptStorage
 {
-  std::vector<uint8_t> GetScriptPex(const char* scriptName) override
+  PexBuffer GetScriptPex(const char* scriptName) override
   {
     if (scriptName == std::string("masterambushscript")) {
       throw std::runtime_error("OK");
     }
-    return {};
+    return nullptr;
   }
 
   const std::set<CIString>& ListScripts(bool forceReloadScripts) override
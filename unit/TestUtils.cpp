@@ -3,6 +3,7 @@
 #include "MpActor.h"
 #include "MsgType.h"
 #include "PartOne.h"
+#include "script_storages/DirectoryScriptStorage.h"
 #include <catch2/catch_all.hpp>
 
 // Utilities for testing
@@ -101,3 +102,40 @@ void FakeListener::clear()
 {
   ss = std::stringstream();
 }
+
+extern espm::Loader& GetEspmLoader();
+
+namespace {
+class FakeDamageFormula : public IDamageFormula
+{
+public:
+  [[nodiscard]] float CalculateDamage(const MpActor&, const MpActor&,
+                                      const HitData&) const override
+  {
+    return 25.f;
+  }
+
+  [[nodiscard]] float CalculateDamage(const MpActor&, const MpActor&,
+                                      const SpellCastData&) const override
+  {
+    return 25.f;
+  }
+};
+}
+
+// Creates a PartOne with Skyrim.esm attached. Instances live until exit
+PartOne& GetPartOne()
+{
+  auto instance = std::make_shared<PartOne>();
+  instance->SetDamageFormula(std::make_unique<FakeDamageFormula>());
+
+  instance->worldState.AttachScriptStorage(
+    std::make_shared<DirectoryScriptStorage>(TEST_PEX_DIR));
+  instance->AttachEspm(&GetEspmLoader());
+
+  instance->worldState.bannedEspmCharacterRaceIds.clear();
+
+  static std::vector<std::shared_ptr<PartOne>> g_partOneInstances;
+  g_partOneInstances.push_back(instance);
+  return *g_partOneInstances.back();
+}
@@ -0,0 +1,64 @@
+#include "TestUtils.hpp"
+#include <catch2/catch_all.hpp>
+
+#include "MinPacketId.h"
+#include "TickMetrics.h"
+#include <prometheus/core.h>
+
+using Catch::Matchers::ContainsSubstring;
+
+TEST_CASE("TickMetrics reads message type from binary packets",
+          "[TickMetrics]")
+{
+  uint8_t binary[] = { Networking::MinPacketId,
+                       static_cast<uint8_t>(MsgType::OnHit), 0 };
+  REQUIRE(TickMetrics::GetMsgType(binary, std::size(binary)) ==
+          MsgType::OnHit);
+  REQUIRE(TickMetrics::GetMsgType(binary, 1) == MsgType::Invalid);
+
+  uint8_t json[] = { Networking::MinPacketId, '{', '}' };
+  REQUIRE(TickMetrics::GetMsgType(json, std::size(json)) == MsgType::Invalid);
+
+  REQUIRE(std::string(TickMetrics::GetMsgTypeName(MsgType::OnHit)) ==
+          "OnHit");
+  REQUIRE(std::string(TickMetrics::GetMsgTypeName(MsgType::Bundle)) ==
+          "Bundle");
+}
+
+TEST_CASE("TickMetrics exports phases and traffic once a registry is "
+          "attached",
+          "[TickMetrics]")
+{
+  TickMetrics metrics;
+  REQUIRE(!metrics.IsEnabled());
+
+  // No-op without a registry
+  metrics.CountReceived(MsgType::Activate, 10);
+  {
+    TickMetrics::ScopedTimer timer(metrics, TickMetrics::Phase::Tick);
+  }
+
+  auto registry = std::make_shared<prometheus::Registry>();
+  metrics.AttachRegistry(registry);
+  REQUIRE(metrics.IsEnabled());
+
+  {
+    TickMetrics::ScopedTimer timer(metrics, TickMetrics::Phase::SaveStorage);
+  }
+  {
+    TickMetrics::ScopedTimer timer(metrics, MsgType::UpdateMovement);
+  }
+  metrics.CountReceived(MsgType::Activate, 10);
+  metrics.CountSent(MsgType::CreateActor, 100);
+
+  auto text = registry->serialize();
+  REQUIRE_THAT(text, ContainsSubstring("skymp_server_tick_phase_seconds"));
+  REQUIRE_THAT(text, ContainsSubstring("save_storage"));
+  REQUIRE_THAT(text,
+               ContainsSubstring("skymp_server_message_handling_seconds"));
+  REQUIRE_THAT(text, ContainsSubstring("UpdateMovement"));
+  REQUIRE_THAT(text, ContainsSubstring("skymp_server_received_bytes_total"));
+  REQUIRE_THAT(text, ContainsSubstring("Activate"));
+  REQUIRE_THAT(text, ContainsSubstring("skymp_server_sent_messages_total"));
+  REQUIRE_THAT(text, ContainsSubstring("CreateActor"));
+}
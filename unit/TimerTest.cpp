@@ -0,0 +1,90 @@
+#include "Timer.h"
+#include <catch2/catch_all.hpp>
+#include <chrono>
+#include <vector>
+
+TEST_CASE("Timers resolve in order of their finish time", "[Timer]")
+{
+  Viet::Timer timer;
+  std::vector<int> resolved;
+
+  timer.SetTimer(std::chrono::milliseconds(-1), nullptr).Then([&](auto&) {
+    resolved.push_back(1);
+  });
+  timer.SetTimer(std::chrono::milliseconds(-3), nullptr).Then([&](auto&) {
+    resolved.push_back(3);
+  });
+  timer.SetTimer(std::chrono::milliseconds(-2), nullptr).Then([&](auto&) {
+    resolved.push_back(2);
+  });
+  timer.SetTimer(std::chrono::hours(1), nullptr).Then([&](auto&) {
+    resolved.push_back(4);
+  });
+
+  timer.TickTimers();
+
+  REQUIRE(resolved == std::vector<int>{ 3, 2, 1 });
+  REQUIRE(timer.GetNumTimers() == 1);
+}
+
+TEST_CASE("Timers with equal finish time resolve in order they were set",
+          "[Timer]")
+{
+  Viet::Timer timer;
+  std::vector<int> resolved;
+
+  for (int i = 0; i < 10; ++i) {
+    timer.SetTimer(std::chrono::seconds(0), nullptr).Then([&, i](auto&) {
+      resolved.push_back(i);
+    });
+  }
+
+  timer.TickTimers();
+
+  REQUIRE(resolved == std::vector<int>{ 0, 1, 2, 3, 4, 5, 6, 7, 8, 9 });
+}
+
+TEST_CASE("RemoveTimer cancels a pending timer", "[Timer]")
+{
+  Viet::Timer timer;
+  std::vector<uint32_t> ids(5);
+  std::vector<int> resolved;
+
+  for (int i = 0; i < 5; ++i) {
+    timer.SetTimer(std::chrono::milliseconds(-i), &ids[i])
+      .Then([&, i](auto&) { resolved.push_back(i); });
+  }
+
+  REQUIRE(timer.RemoveTimer(ids[2]));
+  REQUIRE(timer.RemoveTimer(ids[4]));
+  REQUIRE_FALSE(timer.RemoveTimer(ids[4]));
+  REQUIRE(timer.GetNumTimers() == 3);
+
+  timer.TickTimers();
+
+  REQUIRE(resolved == std::vector<int>{ 3, 1, 0 });
+  REQUIRE_FALSE(timer.RemoveTimer(ids[0]));
+  REQUIRE(timer.GetNumTimers() == 0);
+}
+
+TEST_CASE("Timers can be set and removed from a resolving timer", "[Timer]")
+{
+  Viet::Timer timer;
+  std::vector<int> resolved;
+
+  uint32_t toRemove = 0;
+  timer.SetTimer(std::chrono::milliseconds(-2), nullptr).Then([&](auto&) {
+    resolved.push_back(1);
+    timer.RemoveTimer(toRemove);
+    timer.SetTimer(std::chrono::hours(1), nullptr).Then([&](auto&) {
+      resolved.push_back(3);
+    });
+  });
+  timer.SetTimer(std::chrono::milliseconds(-1), &toRemove)
+    .Then([&](auto&) { resolved.push_back(2); });
+
+  timer.TickTimers();
+
+  REQUIRE(resolved == std::vector<int>{ 1 });
+  REQUIRE(timer.GetNumTimers() == 1);
+}
@@ -107,8 +107,91 @@ TEST_CASE("String assign", "[VarValue]")
   VarValue x(std::string("123"));
   VarValue y;
   y = x;
-  *x.stringHolder = "456";
+  x = VarValue(std::string("456"));
   REQUIRE(static_cast<const char*>(y) == std::string("123"));
+
+}
+
+TEST_CASE("String pointers survive moves", "[VarValue]")
+{
+  std::vector<VarValue> values;
+  values.push_back(VarValue(std::string("abc")));
+  auto str = static_cast<const char*>(values[0]);
+
+  // Reallocation moves the value
+  for (int i = 0; i < 100; ++i) {
+    values.push_back(VarValue(i));
+  }
+  REQUIRE(static_cast<const char*>(values[0]) == str);
+  REQUIRE(std::string(str) == "abc");
+
+  VarValue moved = std::move(values[0]);
+  values.clear();
+  REQUIRE(static_cast<const char*>(moved) == str);
+  REQUIRE(std::string(str) == "abc");
+}
+
+TEST_CASE("Copies share arrays, but not SetArray", "[VarValue]")
+{
+  VarValue x((uint8_t)VarValue::kType_IntArray);
+  x.SetArray(std::make_shared<std::vector<VarValue>>());
+
+  VarValue y = x;
+  x.GetArray()->push_back(VarValue(1));
+  REQUIRE(y.GetArray()->size() == 1);
+
+  x.SetArray(std::make_shared<std::vector<VarValue>>());
+  REQUIRE(x.GetArray()->size() == 0);
+  REQUIRE(y.GetArray()->size() == 1);
+}
+
+TEST_CASE("operator= doesn't copy object type", "[VarValue]")
+{
+  VarValue x;
+  x.SetObjectType("Actor");
+
+  VarValue y = x;
+  REQUIRE(y.GetObjectType() == "Actor");
+
+  VarValue z;
+  z.SetObjectType("ObjectReference");
+  z = x;
+  REQUIRE(z.GetObjectType() == "ObjectReference");
+}
+
+TEST_CASE("Former public members still work", "[VarValue]")
+{
+  VarValue x((uint8_t)VarValue::kType_IntArray);
+  REQUIRE(x.pArray == nullptr);
+  x.pArray = std::make_shared<std::vector<VarValue>>();
+  x.pArray->push_back(VarValue(1));
+  REQUIRE((*x.pArray).size() == 1);
+
+  VarValue y((uint8_t)VarValue::kType_IntArray);
+  y.pArray = x.pArray;
+  REQUIRE(y.pArray.get() == x.pArray.get());
+  REQUIRE(y.GetArray() == x.GetArray());
+
+  y.pArray.reset(new std::vector<VarValue>);
+  REQUIRE(y.pArray->empty());
+  REQUIRE(x.pArray->size() == 1);
+
+  VarValue p = VarValue::None();
+  REQUIRE(!p.promise);
+  p.promise = std::make_shared<Viet::Promise<VarValue>>();
+  VarValue resolved;
+  p.promise->Then([&](VarValue v) { resolved = v; });
+  VarValue pCopy = p;
+  pCopy.promise->Resolve(VarValue(5));
+  REQUIRE(resolved == VarValue(5));
+
+  VarValue o;
+  REQUIRE(o.objectType.empty());
+  o.objectType = "Actor";
+  REQUIRE(o.objectType == "Actor");
+  const std::string& objectType = o.objectType;
+  REQUIRE(objectType == "Actor");
+  REQUIRE(o.GetObjectType() == "Actor");
 }
 
 TEST_CASE("Mixed arithmetics", "[VarValue]")
@@ -4,6 +4,7 @@
 #include "ScriptVariablesHolder.h"
 #include "papyrus-vm/Reader.h"
 #include "papyrus-vm/VirtualMachine.h"
+#include <algorithm>
 #include <cstdint>
 #include <ctime>
 #include <filesystem>
@@ -246,3 +247,102 @@ TEST_CASE("Test nested latent calls", "[VirtualMachine]")
 
   REQUIRE(result == VarValue(6));
 }
+
+TEST_CASE("SendEvent calls handlers of the current state",
+          "[VirtualMachine]")
+{
+  auto vm = CreateVirtualMachine();
+
+  std::vector<std::string> printed;
+  vm->RegisterFunction("", "Print", FunctionType::GlobalFunction,
+                       [&](VarValue self, std::vector<VarValue> args) {
+                         printed.push_back(static_cast<const char*>(args[0]));
+                         return VarValue::None();
+                       });
+
+  auto holder = std::make_shared<MyScriptVariablesHolder>("OpcodesTest");
+  vm->AddObject(holder->testObject, { { "OpcodesTest", holder } });
+
+  vm->SendEvent(holder->testObject, "OnUnknownEvent", {});
+  REQUIRE(printed.empty());
+
+  vm->SendEvent(holder->testObject, "OnEndState", {});
+  vm->SendEvent(holder->testObject, "onendstate", {});
+  REQUIRE(printed ==
+          std::vector<std::string>{ " End Default State!",
+                                    " End Default State!" });
+
+  // Goes through FirstState and SecondState back to the default state
+  printed.clear();
+  vm->SendEvent(holder->testObject, "StateTest", {});
+  REQUIRE(std::count(printed.begin(), printed.end(), " End First State!") ==
+          1);
+  REQUIRE(std::count(printed.begin(), printed.end(), " End Second State!") ==
+          1);
+
+  printed.clear();
+  vm->SendEvent(holder->testObject, "OnEndState", {});
+  REQUIRE(printed == std::vector<std::string>{ " End Default State!" });
+}
+
+TEST_CASE("CompiledFunctionCode resolves locals ahead of time",
+          "[VirtualMachine]")
+{
+  using Operand = CompiledFunctionCode::Operand;
+
+  FunctionInfo function;
+  function.locals = { { "::temp0", "int" } };
+  function.params = { { "arg", "int" } };
+
+  auto identifier = [](const char* name) {
+    return VarValue(VarValue::kType_Identifier, name);
+  };
+
+  function.code.instructions = {
+    { FunctionCode::kOp_IAdd,
+      { identifier("::temp0"), identifier("arg"), VarValue(1) } },
+    { FunctionCode::kOp_CallMethod,
+      { identifier("Foo"), identifier("self"), identifier("::NoneVar"),
+        VarValue(1), identifier("::temp0") } },
+    { FunctionCode::kOp_Assign, { VarValue(2), identifier("::myVar_var") } },
+    { FunctionCode::kOp_Return, { identifier("::temp0") } }
+  };
+
+  auto code = CompiledFunctionCode::Compile(function);
+
+  REQUIRE(code->instructions.size() == 4);
+  REQUIRE(code->operands.size() == 11);
+  REQUIRE(code->maxOperands == 5);
+
+  auto kinds = [&](size_t instructionIdx) {
+    auto& instruction = code->instructions[instructionIdx];
+    std::vector<Operand::Kind> res;
+    for (uint32_t i = 0; i < instruction.numOperands; ++i) {
+      res.push_back(code->operands[instruction.firstOperand + i].kind);
+    }
+    return res;
+  };
+
+  REQUIRE(kinds(0) ==
+          std::vector<Operand::Kind>{ Operand::kKind_Local,
+                                      Operand::kKind_Local,
+                                      Operand::kKind_Constant });
+  REQUIRE(code->operands[0].index == 0);
+  REQUIRE(code->operands[1].index == 1);
+
+  // Function name is not dereferenced, 'self' and unknown names are resolved
+  // against the script instance
+  REQUIRE(kinds(1) ==
+          std::vector<Operand::Kind>{
+            Operand::kKind_Constant, Operand::kKind_Identifier,
+            Operand::kKind_Identifier, Operand::kKind_Constant,
+            Operand::kKind_Local });
+
+  // A constant in a written position must not be shared between calls
+  REQUIRE(kinds(2) ==
+          std::vector<Operand::Kind>{ Operand::kKind_WritableConstant,
+                                      Operand::kKind_Identifier });
+  REQUIRE(code->writableConstants.size() == 1);
+
+  REQUIRE(kinds(3) == std::vector<Operand::Kind>{ Operand::kKind_Local });
+}
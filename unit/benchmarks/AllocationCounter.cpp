@@ -0,0 +1,160 @@
+#include "AllocationCounter.h"
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+// Replacing the global operators affects the whole executable and conflicts
+// with sanitizers, so it's done in the benchmarks executable only
+
+namespace {
+std::atomic<uint64_t> g_numAllocations{ 0 };
+
+void* Allocate(size_t size, size_t alignment = 0)
+{
+  g_numAllocations.fetch_add(1, std::memory_order_relaxed);
+  if (size == 0) {
+    size = 1;
+  }
+  if (alignment == 0) {
+    return std::malloc(size);
+  }
+#ifdef _WIN32
+  return _aligned_malloc(size, alignment);
+#else
+  // aligned_alloc requires size to be a multiple of alignment
+  return std::aligned_alloc(alignment,
+                            (size + alignment - 1) / alignment * alignment);
+#endif
+}
+
+void* AllocateOrThrow(size_t size, size_t alignment = 0)
+{
+  if (void* p = Allocate(size, alignment)) {
+    return p;
+  }
+  throw std::bad_alloc();
+}
+
+void Free(void* p) noexcept
+{
+  std::free(p);
+}
+
+void FreeAligned(void* p) noexcept
+{
+#ifdef _WIN32
+  _aligned_free(p);
+#else
+  std::free(p);
+#endif
+}
+}
+
+uint64_t GetNumAllocations()
+{
+  return g_numAllocations.load();
+}
+
+void* operator new(size_t size)
+{
+  return AllocateOrThrow(size);
+}
+
+void* operator new[](size_t size)
+{
+  return AllocateOrThrow(size);
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept
+{
+  return Allocate(size);
+}
+
+void* operator new[](size_t size, const std::nothrow_t&) noexcept
+{
+  return Allocate(size);
+}
+
+void* operator new(size_t size, std::align_val_t alignment)
+{
+  return AllocateOrThrow(size, static_cast<size_t>(alignment));
+}
+
+void* operator new[](size_t size, std::align_val_t alignment)
+{
+  return AllocateOrThrow(size, static_cast<size_t>(alignment));
+}
+
+void* operator new(size_t size, std::align_val_t alignment,
+                   const std::nothrow_t&) noexcept
+{
+  return Allocate(size, static_cast<size_t>(alignment));
+}
+
+void* operator new[](size_t size, std::align_val_t alignment,
+                     const std::nothrow_t&) noexcept
+{
+  return Allocate(size, static_cast<size_t>(alignment));
+}
+
+void operator delete(void* p) noexcept
+{
+  Free(p);
+}
+
+void operator delete[](void* p) noexcept
+{
+  Free(p);
+}
+
+void operator delete(void* p, size_t) noexcept
+{
+  Free(p);
+}
+
+void operator delete[](void* p, size_t) noexcept
+{
+  Free(p);
+}
+
+void operator delete(void* p, const std::nothrow_t&) noexcept
+{
+  Free(p);
+}
+
+void operator delete[](void* p, const std::nothrow_t&) noexcept
+{
+  Free(p);
+}
+
+void operator delete(void* p, std::align_val_t) noexcept
+{
+  FreeAligned(p);
+}
+
+void operator delete[](void* p, std::align_val_t) noexcept
+{
+  FreeAligned(p);
+}
+
+void operator delete(void* p, size_t, std::align_val_t) noexcept
+{
+  FreeAligned(p);
+}
+
+void operator delete[](void* p, size_t, std::align_val_t) noexcept
+{
+  FreeAligned(p);
+}
+
+void operator delete(void* p, std::align_val_t,
+                     const std::nothrow_t&) noexcept
+{
+  FreeAligned(p);
+}
+
+void operator delete[](void* p, std::align_val_t,
+                       const std::nothrow_t&) noexcept
+{
+  FreeAligned(p);
+}
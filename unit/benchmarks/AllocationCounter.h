@@ -0,0 +1,6 @@
+#pragma once
+#include <cstdint>
+
+// Number of heap allocations made through operator new by this executable.
+// Benchmarks report the difference around the code they measure
+uint64_t GetNumAllocations();
@@ -0,0 +1,98 @@
+#include "AllocationCounter.h"
+#include "ScriptVariablesHolder.h"
+#include "papyrus-vm/Reader.h"
+#include "papyrus-vm/VirtualMachine.h"
+#include <catch2/catch_all.hpp>
+#include <chrono>
+#include <filesystem>
+#include <iostream>
+
+namespace {
+class BenchmarkGameObject : public IGameObject
+{
+public:
+  const char* GetStringID() override { return "BenchmarkGameObject"; }
+
+  const std::vector<std::shared_ptr<ActivePexInstance>>&
+  ListActivePexInstances() const override
+  {
+    return scripts;
+  }
+
+  void AddScript(std::shared_ptr<ActivePexInstance> script) noexcept override
+  {
+    scripts.push_back(script);
+  }
+
+  std::vector<std::shared_ptr<ActivePexInstance>> scripts;
+};
+
+// Sends an OpcodesTest event, e.g. PropertyTest that reads and writes a
+// property with get/set functions, numCalls times
+void ExecutePapyrusBenchmark(const char* eventName, int numCalls)
+{
+  std::vector<std::string> pexPaths;
+  for (auto& entry : std::filesystem::directory_iterator(BUILT_PEX_DIR)) {
+    if (entry.path().extension() == ".pex") {
+      pexPaths.push_back(entry.path().generic_string());
+    }
+  }
+  REQUIRE(!pexPaths.empty());
+
+  auto vm =
+    std::make_shared<VirtualMachine>(Reader(pexPaths).GetSourceStructures());
+
+  auto doNothing = [](VarValue, std::vector<VarValue>) {
+    return VarValue::None();
+  };
+  vm->RegisterFunction("", "Print", FunctionType::GlobalFunction, doNothing);
+  vm->RegisterFunction("", "Assert", FunctionType::GlobalFunction, doNothing);
+
+  auto object = std::make_shared<BenchmarkGameObject>();
+  std::vector<VirtualMachine::ScriptInfo> scripts;
+  for (const char* scriptName : { "AAATestObject", "OpcodesTest" }) {
+    scripts.push_back({ scriptName,
+                        std::make_shared<ScriptVariablesHolder>(
+                          scriptName, espm::LookupResult(),
+                          espm::LookupResult(), nullptr, nullptr, nullptr) });
+  }
+  vm->AddObject(object, scripts);
+
+  const auto numOpcodesWas = vm->GetNumExecutedOpcodes();
+  const auto numAllocationsWas = GetNumAllocations();
+  auto was = std::chrono::steady_clock::now();
+
+  for (int i = 0; i < numCalls; ++i) {
+    vm->SendEvent(object, eventName, {});
+  }
+
+  auto us = std::chrono::duration_cast<std::chrono::microseconds>(
+              std::chrono::steady_clock::now() - was)
+              .count();
+  const auto numAllocations = GetNumAllocations() - numAllocationsWas;
+  const auto numOpcodes = vm->GetNumExecutedOpcodes() - numOpcodesWas;
+  REQUIRE(numOpcodes > 0);
+
+  std::cout << "Papyrus " << eventName << " x" << numCalls << " took " << us
+            << " microseconds, " << numOpcodes << " opcodes, "
+            << static_cast<double>(numAllocations) / numOpcodes
+            << " allocations per opcode" << std::endl;
+}
+}
+
+TEST_CASE("Papyrus property get/set", "[Benchmarks]")
+{
+  ExecutePapyrusBenchmark("PropertyTest", 1000);
+}
+
+TEST_CASE("Papyrus property get/set (large)", "[.][Benchmarks]")
+{
+  ExecutePapyrusBenchmark("PropertyTest", 100000);
+}
+
+TEST_CASE("Papyrus opcodes", "[Benchmarks]")
+{
+  for (auto eventName : { "FactorialTest", "StringTest", "ArrayTest" }) {
+    ExecutePapyrusBenchmark(eventName, 1000);
+  }
+}
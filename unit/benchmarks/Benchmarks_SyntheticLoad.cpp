@@ -0,0 +1,312 @@
+#include "AllocationCounter.h"
+#include "Bot.h"
+#include "NetworkingCombined.h"
+#include "NetworkingMock.h"
+#include "PartOne.h"
+#include "TestUtils.hpp"
+#include <algorithm>
+#include <catch2/catch_all.hpp>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <slikenet/BitStream.h>
+
+PartOne& GetPartOne();
+
+namespace {
+constexpr uint32_t kWhiterun = 0x1a26f;
+constexpr uint32_t kBarrelFood01 = 0x20570;
+constexpr uint32_t kIronDagger = 0x1397e;
+constexpr uint32_t kGold = 0xf;
+const NiPoint3 kSpawnPoint = { 21272.f, -7816.f, -3608.f };
+
+constexpr int kWarmupTicks = 10;
+constexpr int kHitPeriodTicks = 10;
+constexpr float kWalkRadius = 512.f;
+
+struct SyntheticLoadResult
+{
+  int numBots = 0;
+  int numTicks = 0;
+  std::vector<double> tickMicroseconds;
+  uint64_t numAllocations = 0;
+  uint64_t numBytesReceived = 0;
+  uint64_t numMessagesReceived = 0;
+  uint64_t numErrors = 0;
+
+  double GetPercentile(double p) const
+  {
+    auto sorted = tickMicroseconds;
+    std::sort(sorted.begin(), sorted.end());
+    auto i = static_cast<size_t>(p * (sorted.size() - 1) + 0.5);
+    return sorted[i];
+  }
+
+  nlohmann::json ToJson() const
+  {
+    const double perClientPerTick = 1.0 / (numBots * numTicks);
+    return nlohmann::json{
+      { "benchmark", "SyntheticLoad" },
+      { "numBots", numBots },
+      { "numTicks", numTicks },
+      { "tickMicrosecondsP50", GetPercentile(0.5) },
+      { "tickMicrosecondsP99", GetPercentile(0.99) },
+      { "tickMicrosecondsMax", GetPercentile(1) },
+      { "bytesPerClientPerTick", numBytesReceived * perClientPerTick },
+      { "messagesPerClientPerTick", numMessagesReceived * perClientPerTick },
+      { "allocationsPerTick", static_cast<double>(numAllocations) / numTicks },
+      { "errors", numErrors },
+    };
+  }
+};
+
+// A client walking around BarrelFood01 in Whiterun. Every kHitPeriodTicks it
+// hits another bot. Bots take turns in using the barrel: open it, take the
+// gold left by the previous bot, leave their own and close it
+class ScriptedBot
+{
+public:
+  ScriptedBot(std::shared_ptr<Networking::IClient> client, uint32_t seed)
+    : bot(client)
+    , rng(seed)
+  {
+  }
+
+  void Spawn(PartOne& partOne, Networking::UserId userId)
+  {
+    pos = kSpawnPoint;
+    actorId = partOne.CreateActor(0, pos, 0, kWhiterun);
+    partOne.SetUserActor(userId, actorId);
+
+    auto& actor = partOne.worldState.GetFormAt<MpActor>(actorId);
+    actor.AddItem(kGold, 100);
+    actor.AddItem(kIronDagger, 1);
+
+    Inventory::ExtraData worn;
+    worn.worn_ = true;
+    Equipment eq;
+    eq.inv.entries.push_back(Inventory::Entry(kIronDagger, 1, worn));
+    actor.SetEquipment(eq);
+
+    idx = actor.GetIdx();
+  }
+
+  void Walk()
+  {
+    std::uniform_real_distribution<float> step(-20.f, 20.f);
+    pos.x = std::clamp(pos.x + step(rng), kSpawnPoint.x - kWalkRadius,
+                       kSpawnPoint.x + kWalkRadius);
+    pos.y = std::clamp(pos.y + step(rng), kSpawnPoint.y - kWalkRadius,
+                       kSpawnPoint.y + kWalkRadius);
+
+    auto j = jMovement;
+    j["idx"] = idx;
+    j["data"]["worldOrCell"] = kWhiterun;
+    j["data"]["pos"] = { pos.x, pos.y, pos.z };
+    j["data"]["runMode"] = "Walking";
+    j["data"]["speed"] = 80.f;
+    Send(j);
+  }
+
+  void Hit(uint32_t targetActorId)
+  {
+    Send({ { "t", MsgType::OnHit },
+           { "data",
+             { { "aggressor", 0x14 },
+               { "isBashAttack", false },
+               { "isHitBlocked", false },
+               { "isPowerAttack", false },
+               { "isSneakAttack", false },
+               { "projectile", 0 },
+               { "source", kIronDagger },
+               { "target", targetActorId } } } });
+  }
+
+  void UseBarrel(int step)
+  {
+    switch (step) {
+      case 0:
+      case 3:
+        return Send({ { "t", MsgType::Activate },
+                      { "data",
+                        { { "caster", 0x14 },
+                          { "target", kBarrelFood01 },
+                          { "isSecondActivation", false } } } });
+      case 1:
+        return Send({ { "t", MsgType::TakeItem },
+                      { "baseId", kGold },
+                      { "count", 1 },
+                      { "target", kBarrelFood01 } });
+      case 2:
+        return Send({ { "t", MsgType::PutItem },
+                      { "baseId", kGold },
+                      { "count", 1 },
+                      { "target", kBarrelFood01 } });
+    }
+  }
+
+  Bot& GetBot() { return bot; }
+  uint32_t GetActorId() const { return actorId; }
+
+private:
+  // Encoded the same way as by the real client
+  void Send(const nlohmann::json& j)
+  {
+    SLNet::BitStream stream;
+    PartOne::GetMessageSerializerInstance().Serialize(j.dump().data(),
+                                                      stream);
+    bot.Send(std::string(reinterpret_cast<const char*>(stream.GetData()),
+                         stream.GetNumberOfBytesUsed()));
+  }
+
+  Bot bot;
+  std::mt19937 rng;
+  uint32_t actorId = 0;
+  uint32_t idx = 0;
+  NiPoint3 pos;
+};
+
+struct ServerTickState
+{
+  PartOne* partOne = nullptr;
+  uint64_t numErrors = 0;
+};
+
+// Unlike ScampServer::Tick, keeps handling the rest of the packets after an
+// exception
+void HandlePacketCountingErrors(void* state, Networking::UserId userId,
+                                Networking::PacketType packetType,
+                                Networking::PacketData data, size_t length)
+{
+  auto st = reinterpret_cast<ServerTickState*>(state);
+  try {
+    PartOne::HandlePacket(st->partOne, userId, packetType, data, length);
+  } catch (std::exception&) {
+    ++st->numErrors;
+  }
+}
+
+SyntheticLoadResult RunSyntheticLoad(int numBots, int numTicks)
+{
+  REQUIRE(numBots >= 2);
+  REQUIRE(numBots < kMaxPlayers);
+
+  auto serverMock = std::make_shared<Networking::MockServer>();
+  auto server = Networking::CreateCombinedServer({ serverMock });
+
+  PartOne& partOne = GetPartOne();
+  partOne.SetSendTarget(server.get());
+  partOne.worldState.GetFormAt<MpObjectReference>(kBarrelFood01)
+    .AddItem(kGold, 1);
+
+  ServerTickState st{ &partOne };
+
+  std::vector<std::unique_ptr<ScriptedBot>> bots;
+  std::vector<Networking::UserId> realUserIds;
+  for (int i = 0; i < numBots; ++i) {
+    auto [client, realUserId] = serverMock->CreateClient();
+    bots.push_back(std::make_unique<ScriptedBot>(client, i));
+    realUserIds.push_back(realUserId);
+  }
+
+  server->Tick(HandlePacketCountingErrors, &st);
+  for (int i = 0; i < numBots; ++i) {
+    bots[i]->Spawn(partOne, server->GetCombinedUserId(0, realUserIds[i]));
+  }
+
+  SyntheticLoadResult res;
+  res.numBots = numBots;
+  res.numTicks = numTicks;
+
+  std::mt19937 rng(numBots);
+  std::uniform_int_distribution<int> anotherBot(1, numBots - 1);
+  uint64_t numBytesWarmup = 0, numMessagesWarmup = 0;
+
+  for (int t = -kWarmupTicks; t < numTicks; ++t) {
+    const int tt = t + kWarmupTicks;
+
+    for (int i = 0; i < numBots; ++i) {
+      auto& bot = *bots[i];
+      bot.Walk();
+      if ((tt + i) % kHitPeriodTicks == 0) {
+        bot.Hit(bots[(i + anotherBot(rng)) % numBots]->GetActorId());
+      }
+    }
+    bots[(tt / 4) % numBots]->UseBarrel(tt % 4);
+
+    const auto numAllocationsWas = GetNumAllocations();
+    const auto was = std::chrono::steady_clock::now();
+
+    server->Tick(HandlePacketCountingErrors, &st);
+    partOne.Tick();
+
+    const auto elapsed = std::chrono::steady_clock::now() - was;
+    const auto numAllocations = GetNumAllocations() - numAllocationsWas;
+
+    for (auto& bot : bots) {
+      bot->GetBot().Tick();
+    }
+
+    if (t == -1) {
+      // Warmup traffic (mostly initial CreateActor) is excluded
+      st.numErrors = 0;
+      for (auto& bot : bots) {
+        numBytesWarmup += bot->GetBot().GetNumBytesReceived();
+        numMessagesWarmup += bot->GetBot().GetNumMessagesReceived();
+      }
+    }
+    if (t >= 0) {
+      res.tickMicroseconds.push_back(
+        std::chrono::duration<double, std::micro>(elapsed).count());
+      res.numAllocations += numAllocations;
+    }
+  }
+
+  for (auto& bot : bots) {
+    res.numBytesReceived += bot->GetBot().GetNumBytesReceived();
+    res.numMessagesReceived += bot->GetBot().GetNumMessagesReceived();
+  }
+  res.numBytesReceived -= numBytesWarmup;
+  res.numMessagesReceived -= numMessagesWarmup;
+  res.numErrors = st.numErrors;
+
+  // Disconnect before the send target is destroyed
+  bots.clear();
+  server->Tick(HandlePacketCountingErrors, &st);
+  partOne.SetSendTarget(nullptr);
+
+  // Checked after the cleanup above so that a failure doesn't leave PartOne
+  // with a dangling send target
+  REQUIRE(res.numErrors == 0);
+  return res;
+}
+
+// Prints a JSON line. Also appends it to the file specified in the
+// SKYMP_BENCHMARK_RESULTS environment variable, if any, to be tracked
+// across commits
+void ExecuteSyntheticLoadBenchmark(int numBots, int numTicks)
+{
+  auto res = RunSyntheticLoad(numBots, numTicks);
+  REQUIRE(res.numMessagesReceived > 0);
+
+  auto line = res.ToJson().dump();
+  std::cout << line << std::endl;
+
+  if (auto path = getenv("SKYMP_BENCHMARK_RESULTS")) {
+    std::ofstream(path, std::ios::app) << line << std::endl;
+  }
+}
+}
+
+TEST_CASE("Synthetic load", "[Benchmarks][espm]")
+{
+  ExecuteSyntheticLoadBenchmark(20, 100);
+}
+
+TEST_CASE("Synthetic load (large)", "[.][Benchmarks][espm]")
+{
+  ExecuteSyntheticLoadBenchmark(100, 300);
+  ExecuteSyntheticLoadBenchmark(300, 300);
+}
@@ -0,0 +1,63 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Viet {
+
+inline size_t GetDefaultNumThreads() noexcept
+{
+  return std::max<size_t>(1, std::thread::hardware_concurrency());
+}
+
+// Calls f(i) for every i in [0, n) using up to numThreads threads, the
+// calling thread included. Indices are handed out in increasing order. The
+// first exception thrown by f is rethrown once all threads are joined
+template <class F>
+void ParallelFor(size_t n, size_t numThreads, const F& f)
+{
+  numThreads = std::min(std::max<size_t>(numThreads, 1), n);
+  if (numThreads <= 1) {
+    for (size_t i = 0; i < n; ++i) {
+      f(i);
+    }
+    return;
+  }
+
+  std::atomic<size_t> next = 0;
+  std::mutex m;
+  std::exception_ptr error;
+
+  auto work = [&] {
+    for (size_t i = next++; i < n; i = next++) {
+      try {
+        f(i);
+      } catch (...) {
+        std::lock_guard l(m);
+        if (!error) {
+          error = std::current_exception();
+        }
+      }
+    }
+  };
+
+  std::vector<std::thread> threads;
+  threads.reserve(numThreads - 1);
+  for (size_t i = 1; i < numThreads; ++i) {
+    threads.emplace_back(work);
+  }
+  work();
+  for (auto& thr : threads) {
+    thr.join();
+  }
+
+  if (error) {
+    std::rethrow_exception(error);
+  }
+}
+
+}
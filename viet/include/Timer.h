@@ -19,6 +19,9 @@ public:
   [[maybe_unused]] bool RemoveTimer(uint32_t timerId);
   void TickTimers();
 
+  // Number of timers that are neither resolved nor removed yet
+  size_t GetNumTimers() const;
+
 private:
   Promise<Void> Set(const std::chrono::system_clock::time_point& endTime,
                     uint32_t* outTimerId);
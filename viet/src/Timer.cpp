@@ -1,12 +1,12 @@
 #include "Timer.h"
 #include <MakeID.h>
-#include <algorithm>
 #include <chrono>
-#include <deque>
 #include <limits>
 #include <memory>
 #include <spdlog/spdlog.h>
+#include <unordered_map>
 #include <utility>
+#include <vector>
 
 namespace Viet {
 
@@ -16,16 +16,34 @@ struct TimerEntry
   uint32_t id;
   Promise<Void> promise;
   std::chrono::system_clock::time_point finish;
+
+  // Timers with equal finish time resolve in the order they were set
+  uint64_t seq;
+
+  bool FiresBefore(const TimerEntry& rhs) const
+  {
+    return finish != rhs.finish ? finish < rhs.finish : seq < rhs.seq;
+  }
 };
 }
 
+// Indexed binary min-heap: O(log n) Set, RemoveTimer and pop, O(1) peek
 struct Timer::Impl
 {
-  std::deque<TimerEntry> timers;
+  std::vector<TimerEntry> heap;
+  std::unordered_map<uint32_t, size_t> heapIndexById;
+  uint64_t nextSeq = 0;
+
   const std::unique_ptr<MakeID> idGenerator =
     std::make_unique<MakeID>(std::numeric_limits<uint32_t>::max());
 
   void DestroyID(const TimerEntry& entry);
+
+  void Push(TimerEntry entry);
+  TimerEntry RemoveAt(size_t i);
+  void SiftUp(size_t i);
+  void SiftDown(size_t i);
+  void Place(size_t i, TimerEntry entry);
 };
 
 void Timer::Impl::DestroyID(const TimerEntry& entry)
@@ -33,6 +51,73 @@ void Timer::Impl::DestroyID(const TimerEntry& entry)
   idGenerator->DestroyID(entry.id);
 }
 
+void Timer::Impl::Push(TimerEntry entry)
+{
+  heap.push_back(std::move(entry));
+  heapIndexById[heap.back().id] = heap.size() - 1;
+  SiftUp(heap.size() - 1);
+}
+
+TimerEntry Timer::Impl::RemoveAt(size_t i)
+{
+  TimerEntry res = std::move(heap[i]);
+  heapIndexById.erase(res.id);
+
+  if (i != heap.size() - 1) {
+    Place(i, std::move(heap.back()));
+    heap.pop_back();
+    if (i > 0 && heap[i].FiresBefore(heap[(i - 1) / 2])) {
+      SiftUp(i);
+    } else {
+      SiftDown(i);
+    }
+  } else {
+    heap.pop_back();
+  }
+  return res;
+}
+
+void Timer::Impl::SiftUp(size_t i)
+{
+  TimerEntry entry = std::move(heap[i]);
+  while (i > 0) {
+    size_t parent = (i - 1) / 2;
+    if (!entry.FiresBefore(heap[parent])) {
+      break;
+    }
+    Place(i, std::move(heap[parent]));
+    i = parent;
+  }
+  Place(i, std::move(entry));
+}
+
+void Timer::Impl::SiftDown(size_t i)
+{
+  TimerEntry entry = std::move(heap[i]);
+  const size_t n = heap.size();
+  while (true) {
+    size_t child = 2 * i + 1;
+    if (child >= n) {
+      break;
+    }
+    if (child + 1 < n && heap[child + 1].FiresBefore(heap[child])) {
+      ++child;
+    }
+    if (!heap[child].FiresBefore(entry)) {
+      break;
+    }
+    Place(i, std::move(heap[child]));
+    i = child;
+  }
+  Place(i, std::move(entry));
+}
+
+void Timer::Impl::Place(size_t i, TimerEntry entry)
+{
+  heapIndexById[entry.id] = i;
+  heap[i] = std::move(entry);
+}
+
 Timer::Timer()
 {
   pImpl = std::make_shared<Impl>();
@@ -42,10 +127,11 @@ void Timer::TickTimers()
 {
   auto now = std::chrono::system_clock::now();
 
-  auto& timers = pImpl->timers;
-  while (!timers.empty() && now >= timers.front().finish) {
-    auto front = std::move(timers.front());
-    timers.pop_front();
+  // Resolving may set or remove other timers, so the heap is re-checked
+  // after every callback
+  auto& heap = pImpl->heap;
+  while (!heap.empty() && now >= heap.front().finish) {
+    auto front = pImpl->RemoveAt(0);
     front.promise.Resolve(Void());
     pImpl->DestroyID(front);
   }
@@ -53,23 +139,19 @@ void Timer::TickTimers()
 
 bool Timer::RemoveTimer(const uint32_t timerId)
 {
-  auto& timers = pImpl->timers;
-  auto it = std::find_if(
-    timers.begin(), timers.end(),
-    [timerId](const TimerEntry& entry) { return entry.id == timerId; });
-  if (it != timers.end()) {
-    timers.erase(it);
-    return true;
+  auto it = pImpl->heapIndexById.find(timerId);
+  if (it == pImpl->heapIndexById.end()) {
+    return false;
   }
-  return false;
+  auto removed = pImpl->RemoveAt(it->second);
+  pImpl->DestroyID(removed);
+  return true;
 }
 
 Promise<Void> Timer::Set(const std::chrono::system_clock::time_point& endTime,
                          uint32_t* outTimerId)
 {
   Promise<Void> promise;
-  bool sortRequired =
-    !pImpl->timers.empty() && endTime > pImpl->timers.front().finish;
 
   uint32_t timerId;
   bool created = pImpl->idGenerator->CreateID(timerId);
@@ -77,18 +159,16 @@ Promise<Void> Timer::Set(const std::chrono::system_clock::time_point& endTime,
     spdlog::critical("MakeID was not able to Create Id for a timer");
     std::terminate();
   }
-  pImpl->timers.push_front({ timerId, promise, endTime });
+  pImpl->Push({ timerId, promise, endTime, pImpl->nextSeq++ });
   if (outTimerId) {
     *outTimerId = timerId;
   }
-
-  if (sortRequired) {
-    std::sort(pImpl->timers.begin(), pImpl->timers.end(),
-              [](const TimerEntry& lhs, const TimerEntry& rhs) {
-                return lhs.finish < rhs.finish;
-              });
-  }
   return promise;
 }
 
+size_t Timer::GetNumTimers() const
+{
+  return pImpl->heap.size();
+}
+
 }